@@ -0,0 +1,22 @@
+#!/bin/sh
+#
+# usage: makeprefixes.sh [<count>] > prefixes.txt
+#
+# Writes <count> (default 100000) distinct synthetic prefixes for the
+# networksFile parameter of BGPRouting: /24s from 20.0.0.0 up, and every 8th
+# line a /16../23 from 60.0.0.0 up, roughly like an Internet routing table.
+#
+
+awk -v count=${1:-100000} 'BEGIN {
+    print "# " count " synthetic prefixes, generated by makeprefixes.sh"
+    n24 = 0; nagg = 0
+    for (i = 0; i < count; i++) {
+        if (i % 8 == 7) {
+            print 60 + int(nagg / 256) "." nagg % 256 ".0.0/" 16 + nagg % 8
+            nagg++
+        } else {
+            print 20 + int(n24 / 65536) "." int(n24 / 256) % 256 "." n24 % 256 ".0/24"
+            n24++
+        }
+    }
+}'
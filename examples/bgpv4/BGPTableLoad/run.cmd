@@ -0,0 +1,3 @@
+if not exist prefixes.txt sh makeprefixes.sh 100000 > prefixes.txt || del prefixes.txt
+if not exist prefixes10k.txt sh makeprefixes.sh 10000 > prefixes10k.txt || del prefixes10k.txt
+..\..\..\src\run_inet %*
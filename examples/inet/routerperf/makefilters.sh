@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# usage: makefilters.sh [<count>] > filters1000.xml
+#
+# Writes <count> (default 1000) MultiFieldClassifier filters for the
+# ClassifierBenchmark config. The first <count>-1 filters (gate 0) match
+# address prefixes and port ranges outside the 10.0.0.0/8 network of the
+# simulation, so no packet matches them; the last one (gate 1) matches every
+# UDP packet. The linear lookup therefore tests every filter for each packet.
+#
+
+awk -v count=${1:-1000} 'BEGIN {
+    print "<!-- " count " synthetic filters, generated by makefilters.sh -->"
+    print "<filters>"
+    for (i = 0; i < count - 1; i++) {
+        j = int(i / 4); a = int(j / 256) % 256; b = j % 256
+        if (i % 4 == 0)
+            print "  <filter srcAddress=\"192.168." a "." b "\" gate=\"0\"/>"
+        else if (i % 4 == 1)
+            print "  <filter destAddress=\"172.16." b ".0\" destPrefixLength=\"24\" gate=\"0\"/>"
+        else if (i % 4 == 2)
+            print "  <filter srcAddress=\"192.169." b ".0\" srcPrefixLength=\"24\" protocol=\"tcp\" gate=\"0\"/>"
+        else
+            print "  <filter destAddress=\"172.17." a "." b "\" protocol=\"udp\" destPortMin=\"" b * 100 "\" destPortMax=\"" b * 100 + 99 "\" gate=\"0\"/>"
+    }
+    print "  <filter protocol=\"udp\" gate=\"1\"/>"
+    print "</filters>"
+}'
@@ -1 +1,2 @@
+if not exist filters1000.xml sh makefilters.sh 1000 > filters1000.xml || del filters1000.xml
 ..\..\..\src\run_inet %*
@@ -0,0 +1,176 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_HASHINDEX_H
+#define __INET_HASHINDEX_H
+
+#include <string>
+#include <vector>
+
+#include "INETDefs.h"
+
+
+/**
+ * Hash index of objects by some key: a chained hash table whose number of
+ * buckets is a power of 2 and grows with the number of items. Several
+ * objects may have the same key; every object is inserted with a rank, and
+ * find() returns the one with the smallest rank, i.e. the same object as a
+ * linear search in rank order (e.g. in the order of interface ids). The
+ * objects are not owned; removed items are kept for reuse.
+ *
+ * Currently used in InterfaceTable, LIBTable and ReassemblyTable.
+ *
+ * The Hash functor maps a key to an uint32; see the ones below.
+ */
+template <class Key, class T, class Hash>
+class HashIndex
+{
+  protected:
+    struct Item
+    {
+        Key key;
+        T *object;
+        long rank;
+        Item *next;
+    };
+
+    std::vector<Item *> buckets;  // the size is a power of 2
+    int numItems;
+    Item *freeItems;  // removed items, linked via next
+    Hash hash;
+
+  protected:
+    Item *& getBucket(const Key& key) {return buckets[hash(key) & (buckets.size() - 1)];}
+
+    void rehash(int numBuckets)
+    {
+        std::vector<Item *> oldBuckets(numBuckets, (Item *)NULL);
+        buckets.swap(oldBuckets);
+        for (int i = 0; i < (int)oldBuckets.size(); i++)
+        {
+            for (Item *item = oldBuckets[i]; item; )
+            {
+                Item *next = item->next;
+                Item *& bucket = getBucket(item->key);
+                item->next = bucket;
+                bucket = item;
+                item = next;
+            }
+        }
+    }
+
+    static void deleteItems(Item *item)
+    {
+        while (item)
+        {
+            Item *next = item->next;
+            delete item;
+            item = next;
+        }
+    }
+
+  private:
+    HashIndex(const HashIndex&);  // not copyable
+    HashIndex& operator=(const HashIndex&);
+
+  public:
+    HashIndex() : buckets(8, (Item *)NULL), numItems(0), freeItems(NULL) {}
+    ~HashIndex() {clear(); deleteItems(freeItems);}
+
+    void insert(const Key& key, T *object, long rank = 0)
+    {
+        if (numItems >= (int)buckets.size())
+            rehash(buckets.size() * 2);
+        Item *item = freeItems;
+        if (item)
+            freeItems = item->next;
+        else
+            item = new Item();
+        Item *& bucket = getBucket(key);
+        item->key = key;
+        item->object = object;
+        item->rank = rank;
+        item->next = bucket;
+        bucket = item;
+        numItems++;
+    }
+
+    /**
+     * Removes the given key of the given object; it must be present.
+     */
+    void remove(const Key& key, T *object)
+    {
+        for (Item **slot = &getBucket(key); *slot; slot = &(*slot)->next)
+        {
+            Item *item = *slot;
+            if (item->object == object && item->key == key)
+            {
+                *slot = item->next;
+                item->next = freeItems;
+                freeItems = item;
+                numItems--;
+                return;
+            }
+        }
+        ASSERT(false);
+    }
+
+    /**
+     * Returns the object with the smallest rank that has the given key,
+     * or NULL if there is none.
+     */
+    T *find(const Key& key) const
+    {
+        const Item *result = NULL;
+        for (const Item *item = buckets[hash(key) & (buckets.size() - 1)]; item; item = item->next)
+            if (item->key == key && (!result || item->rank < result->rank))
+                result = item;
+        return result ? result->object : NULL;
+    }
+
+    void clear()
+    {
+        for (int i = 0; i < (int)buckets.size(); i++)
+        {
+            deleteItems(buckets[i]);
+            buckets[i] = NULL;
+        }
+        numItems = 0;
+    }
+
+    int size() const {return numItems;}
+};
+
+struct IntHash
+{
+    uint32 operator()(int key) const
+    {
+        uint32 h = (uint32)key * 2654435761u;
+        return h ^ (h >> 16);
+    }
+};
+
+struct StringHash
+{
+    uint32 operator()(const std::string& key) const
+    {
+        uint32 h = 2166136261u;  // FNV-1a
+        for (int i = 0; i < (int)key.size(); i++)
+            h = (h ^ (unsigned char)key[i]) * 16777619u;
+        return h;
+    }
+};
+
+#endif
@@ -36,6 +36,14 @@ ReassemblyBuffer::~ReassemblyBuffer()
     delete fragments;
 }
 
+void ReassemblyBuffer::clear()
+{
+    main.beg = main.end = 0;
+    main.islast = false;
+    if (fragments)
+        fragments->clear();
+}
+
 bool ReassemblyBuffer::addFragment(ushort beg, ushort end, bool islast)
 {
     merge(beg, end, islast);
@@ -74,6 +74,12 @@ class INET_API ReassemblyBuffer
      */
     bool addFragment(ushort beg, ushort end, bool islast);
 
+    /**
+     * Makes the buffer empty again; the storage of disjoint fragments
+     * is kept for reuse.
+     */
+    void clear();
+
     /**
      * Returns the total (assembled) length of the datagram.
      * Can only be called after addFragment() returned true.
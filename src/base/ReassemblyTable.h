@@ -0,0 +1,180 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_REASSEMBLYTABLE_H
+#define __INET_REASSEMBLYTABLE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "HashIndex.h"
+#include "ReassemblyBuffer.h"
+
+
+/**
+ * The datagrams being reassembled, with their reassembly buffers.
+ *
+ * Currently used in IPv4FragBuf and IPv6FragBuf.
+ *
+ * Entries are found via a HashIndex on the Key, which must provide
+ * operator== and a hash() method returning uint32. They are also linked in
+ * timestamp order; since every entry of a table has the same timeout, the
+ * expired entries are always at the front of that list (getOldest()), so
+ * purging them does not need to scan the table.
+ *
+ * Removed entries are pooled and reused together with the region storage
+ * of their ReassemblyBuffer. The datagrams are not owned by the table.
+ */
+template <class Key, class Datagram>
+class ReassemblyTable
+{
+  public:
+    struct Entry
+    {
+        Key key;
+        ReassemblyBuffer buf;  // reassembly buffer
+        Datagram *datagram;  // the actual datagram
+        simtime_t time;  // the timeout is counted from this time
+        Entry *prev;  // neighbours in timestamp order
+        Entry *next;
+    };
+
+  protected:
+    struct KeyHash
+    {
+        uint32 operator()(const Key& key) const {return key.hash();}
+    };
+
+    HashIndex<Key, Entry, KeyHash> index;
+    Entry *oldest;
+    Entry *newest;
+    int numEntries;
+    std::vector<Entry *> pool;  // removed entries, for reuse
+
+  protected:
+    void append(Entry *entry)
+    {
+        entry->prev = newest;
+        entry->next = NULL;
+        if (newest)
+            newest->next = entry;
+        else
+            oldest = entry;
+        newest = entry;
+    }
+
+    void unlink(Entry *entry)
+    {
+        if (entry->prev)
+            entry->prev->next = entry->next;
+        else
+            oldest = entry->next;
+        if (entry->next)
+            entry->next->prev = entry->prev;
+        else
+            newest = entry->prev;
+    }
+
+  private:
+    ReassemblyTable(const ReassemblyTable&);  // not copyable
+    ReassemblyTable& operator=(const ReassemblyTable&);
+
+  public:
+    ReassemblyTable()
+    {
+        oldest = newest = NULL;
+        numEntries = 0;
+    }
+
+    ~ReassemblyTable()
+    {
+        while (oldest)
+        {
+            Entry *entry = oldest;
+            oldest = entry->next;
+            delete entry;
+        }
+        for (int i = 0; i < (int)pool.size(); i++)
+            delete pool[i];
+    }
+
+    /**
+     * Returns the entry of the given key, or NULL if there is none.
+     */
+    Entry *find(const Key& key) {return index.find(key);}
+
+    /**
+     * Adds an entry with an empty reassembly buffer and no datagram; there
+     * must be no entry with the same key. The time must not be earlier than
+     * the time of any other entry (e.g. it is the current simulation time).
+     */
+    Entry *add(const Key& key, simtime_t time)
+    {
+        ASSERT(index.find(key) == NULL);
+        Entry *entry;
+        if (pool.empty())
+            entry = new Entry();
+        else
+        {
+            entry = pool.back();
+            pool.pop_back();
+        }
+        entry->key = key;
+        entry->datagram = NULL;
+        entry->time = time;
+        index.insert(key, entry);
+        append(entry);
+        numEntries++;
+        return entry;
+    }
+
+    /**
+     * Updates the time of the entry, which makes it the newest one; the same
+     * restriction applies to the time as in add().
+     */
+    void touch(Entry *entry, simtime_t time)
+    {
+        entry->time = time;
+        if (entry != newest)
+        {
+            unlink(entry);
+            append(entry);
+        }
+    }
+
+    /**
+     * Removes the entry; it does not delete the datagram.
+     */
+    void remove(Entry *entry)
+    {
+        index.remove(entry->key, entry);
+        unlink(entry);
+        numEntries--;
+        entry->buf.clear();
+        entry->datagram = NULL;
+        pool.push_back(entry);
+    }
+
+    /**
+     * Returns the entry with the earliest time, or NULL if the table is empty;
+     * the rest can be iterated via Entry::next.
+     */
+    Entry *getOldest() const {return oldest;}
+
+    int size() const {return numEntries;}
+};
+
+#endif
@@ -19,8 +19,8 @@
 #include <string.h>
 #include <stdarg.h>
 #include <deque>
-#include <list>
 #include <algorithm>
+#include <queue>
 #include <sstream>
 #include "Topology.h"
 #include "PatternMatcher.h"
@@ -406,6 +406,24 @@ void Topology::calculateUnweightedSingleShortestPathsTo(Node *_target)
     }
 }
 
+namespace {
+
+// entry of the Dijkstra priority queue; nodes with equal distance are
+// dequeued in the order they were (last) inserted
+struct DijkstraQueueEntry
+{
+    double dist;
+    long seq;
+    Topology::Node *node;
+    DijkstraQueueEntry(double dist, long seq, Topology::Node *node) : dist(dist), seq(seq), node(node) {}
+    bool operator<(const DijkstraQueueEntry& other) const  // std::priority_queue is a max-heap
+    {
+        return dist != other.dist ? dist > other.dist : seq > other.seq;
+    }
+};
+
+}
+
 void Topology::calculateWeightedSingleShortestPathsTo(Node *_target)
 {
     if (!_target)
@@ -421,14 +439,20 @@ void Topology::calculateWeightedSingleShortestPathsTo(Node *_target)
 
     target->dist = 0;
 
-    std::list<Node*> q;
+    // binary heap; instead of decreasing the key of a queued node, the node
+    // is inserted again and the outdated entry is skipped when dequeued
+    std::priority_queue<DijkstraQueueEntry> q;
+    long seq = 0;
 
-    q.push_back(target);
+    q.push(DijkstraQueueEntry(0, seq++, target));
 
     while (!q.empty())
     {
-        Node *dest = q.front();
-        q.pop_front();
+        DijkstraQueueEntry entry = q.top();
+        q.pop();
+        Node *dest = entry.node;
+        if (entry.dist != dest->dist)
+            continue;  // outdated entry
 
         ASSERT(dest->getWeight() >= 0.0);
 
@@ -450,17 +474,9 @@ void Topology::calculateWeightedSingleShortestPathsTo(Node *_target)
                 newdist += dest->getWeight();  // dest is not the target, uses weight of dest node as price of routing (infinity means dest node doesn't route between interfaces)
             if (newdist != INFINITY && src->dist > newdist)  // it's a valid shorter path from src to target node
             {
-                if (src->dist != INFINITY)
-                    q.remove(src);   // src is in the queue
                 src->dist = newdist;
                 src->outPath = dest->inLinks[i];
-
-                // insert src node to ordered list
-                std::list<Node*>::iterator it;
-                for (it = q.begin(); it != q.end(); ++it)
-                    if ((*it)->dist > newdist)
-                        break;
-                q.insert(it, src);
+                q.push(DijkstraQueueEntry(newdist, seq++, src));
             }
         }
     }
@@ -556,7 +556,8 @@ class INET_API Topology : public cOwnedObject
     /**
      * Apply the Dijkstra algorithm to find all shortest paths to the given
      * graph node. The paths found can be extracted via Node's methods.
-     * Uses weights in nodes and links.
+     * Uses weights in nodes and links. The queue is a binary heap, so it
+     * runs in O((V+E) log V) time.
      */
     void calculateWeightedSingleShortestPathsTo(Node *target);
 
@@ -21,9 +21,14 @@
 #include <sstream>
 #include <string>
 #include <algorithm>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
 
 #include "INETDefs.h"
 
+#include <platdep/platmisc.h>   // getpid()
+
 #include "BerParseFile.h"
 
 void BerParseFile::clearBerTable()
@@ -44,6 +49,7 @@ void BerParseFile::clearBerTable()
 void BerParseFile::setPhyOpMode(char p)
 {
     clearBerTable();
+    compiledTable.clear();
     phyOpMode = p;
     if (phyOpMode=='b')
         berTable.resize(4);
@@ -88,144 +94,282 @@ int BerParseFile::getTablePosition(double speed)
     }
 }
 
-double BerParseFile::getPer(double speed, double tsnr, int tlen)
+double BerParseFile::interpolateSnr(const SnrBerList& snrlist, double tsnr)
+{
+    // above the last entry the last PER is used
+    const SnrBer& last = snrlist.back();
+    if (tsnr > last.snr)
+        return last.ber;
+
+    // interpolate between the first entry not below tsnr and its predecessor
+    SnrBer key;
+    key.snr = tsnr;
+    unsigned int j = std::lower_bound(snrlist.begin(), snrlist.end(), key) - snrlist.begin();
+    const SnrBer& snrdata1 = snrlist[j];
+    if (j == 0)
+        return snrdata1.ber;
+    const SnrBer& snrdata2 = snrlist[j-1];
+    if (snrdata2.snr == snrdata1.snr)
+        return snrdata1.ber;
+    return snrdata1.ber + (snrdata2.ber-snrdata1.ber)/(snrdata2.snr-snrdata1.snr)*(tsnr- snrdata1.snr);
+}
+
+double BerParseFile::getGridSnr(int index) const
 {
-    BerList *berlist;
-    berlist = & berTable[getTablePosition(speed)];
-    LongBer * pre;
-    LongBer * pos;
-    unsigned int j;
-    for (j=0; j<berlist->size(); j++)
+    // inverse of the index computation in getGridPer()
+    int exponent = minSnrExponent + index / SNR_BINS_PER_OCTAVE;
+    double mantissa = 0.5 + 0.5 * (index % SNR_BINS_PER_OCTAVE) / SNR_BINS_PER_OCTAVE;
+    return ldexp(mantissa, exponent);
+}
+
+void BerParseFile::compileTable()
+{
+    double minSnr = 0;
+    double maxSnr = 0;
+    bool first = true;
+    for (unsigned int i = 0; i < berTable.size(); i++)
     {
-        pos = *(berlist->begin()+j);
-        if (pos->longpkt >= tlen)
+        for (unsigned int j = 0; j < berTable[i].size(); j++)
         {
-            break;
+            const SnrBerList& snrlist = berTable[i][j]->snrlist;
+            if (first || snrlist.front().snr < minSnr)
+                minSnr = snrlist.front().snr;
+            if (first || snrlist.back().snr > maxSnr)
+                maxSnr = snrlist.back().snr;
+            first = false;
         }
     }
-    if (j==0)
-        pre = NULL;
-    else
+
+    // the grid covers [minSnr, maxSnr]; outside it getGridPer() uses the first/last grid point,
+    // which is the same as the first/last PER of the lists
+    int maxSnrExponent;
+    frexp(minSnr, &minSnrExponent);
+    frexp(maxSnr, &maxSnrExponent);
+    numSnrGridPoints = (maxSnrExponent - minSnrExponent + 1) * SNR_BINS_PER_OCTAVE + 1;
+
+    compiledTable.clear();
+    compiledTable.resize(berTable.size());
+    for (unsigned int i = 0; i < berTable.size(); i++)
     {
-        if (j==berlist->size())
-            pre = *(berlist->begin()+j-2);
-        else
-            pre = *(berlist->begin()+j-1);
+        compiledTable[i].resize(berTable[i].size());
+        for (unsigned int j = 0; j < berTable[i].size(); j++)
+        {
+            std::vector<double>& pers = compiledTable[i][j];
+            pers.resize(numSnrGridPoints);
+            for (int k = 0; k < numSnrGridPoints; k++)
+                pers[k] = interpolateSnr(berTable[i][j]->snrlist, getGridSnr(k));
+        }
     }
-    SnrBer snrdata1;
-    SnrBer snrdata2;
-    SnrBer snrdata3;
-    SnrBer snrdata4;
-    snrdata3.snr = -1;
-    snrdata3.ber = -1;
-    snrdata4.snr = -1;
-    snrdata4.ber = -1;
-
-    if (tsnr>pos->snrlist[pos->snrlist.size()-1].snr)
+}
+
+double BerParseFile::getGridPer(const std::vector<double>& pers, double tsnr) const
+{
+    // position on the SNR grid
+    int exponent;
+    double mantissa = frexp(tsnr, &exponent);  // tsnr = mantissa * 2^exponent, mantissa in [0.5,1)
+    if (!(tsnr > 0) || exponent < minSnrExponent)
+        return pers[0];
+    double position = (mantissa - 0.5) * 2 * SNR_BINS_PER_OCTAVE;
+    int bin = (int)position;
+    int index = (exponent - minSnrExponent) * SNR_BINS_PER_OCTAVE + bin;
+    if (index >= numSnrGridPoints - 1)
+        return pers[numSnrGridPoints - 1];
+    double fraction = position - bin;
+    return pers[index] + fraction * (pers[index+1] - pers[index]);
+}
+
+double BerParseFile::getPer(double speed, double tsnr, int tlen)
+{
+    int tablePosition = getTablePosition(speed);
+    const BerList& lengths = berTable[tablePosition];
+
+    // pos: the first length not shorter than tlen (or the last one),
+    // pre: the length before it, used for interpolating over the length
+    unsigned int j = 0;
+    while (j < lengths.size() && lengths[j]->longpkt < tlen)
+        j++;
+    unsigned int pos, pre;
+    if (j == lengths.size())
     {
-        snrdata1 = pos->snrlist[pos->snrlist.size()-1];
-        snrdata2 = pos->snrlist[pos->snrlist.size()-1];
+        pos = j-1;
+        pre = j >= 2 ? j-2 : pos;
     }
     else
     {
-        for (j=0; j<pos->snrlist.size(); j++)
-        {
-            snrdata1 = pos->snrlist[j];
-            if (tsnr<=snrdata1.snr)
-                break;
-        }
-        if (j==0)
-        {
-            snrdata2.snr = -1;
-            snrdata2.ber = -1;
-        }
-        else
-        {
-            if (j==pos->snrlist.size())
-                snrdata2 = pos->snrlist[j-2];
-            else
-                snrdata2 = pos->snrlist[j-1];
-        }
+        pos = j;
+        pre = j == 0 ? pos : j-1;
     }
 
-    if (pre==NULL)
-        pre = pos;
-    if (tsnr>pre->snrlist[pre->snrlist.size()-1].snr)
+    double per1, per2;
+    if (snrGrid)
     {
-        snrdata3 = pre->snrlist[pre->snrlist.size()-1];
-        snrdata4 = pre->snrlist[pre->snrlist.size()-1];
+        per1 = getGridPer(compiledTable[tablePosition][pos], tsnr);
+        per2 = getGridPer(compiledTable[tablePosition][pre], tsnr);
     }
     else
     {
-        for (j=0; j<pre->snrlist.size(); j++)
+        per1 = interpolateSnr(lengths[pos]->snrlist, tsnr);
+        per2 = interpolateSnr(lengths[pre]->snrlist, tsnr);
+    }
+
+    int posLength = lengths[pos]->longpkt;
+    int preLength = lengths[pre]->longpkt;
+    if (posLength != preLength)
+        return per2 +  (per1- per2)/(posLength - preLength)*(tlen-preLength);
+    else
+        return per2;
+}
+
+void BerParseFile::parseFile(const char *filename, const char *cacheFilename, bool useSnrGrid)
+{
+    bool useCache = cacheFilename && *cacheFilename;
+    if (!useCache || !loadCacheFile(cacheFilename, filename))
+    {
+        parseTextFile(filename);
+        if (useCache)
+            saveCacheFile(cacheFilename, filename);
+    }
+    for (unsigned int i = 0; i < berTable.size(); i++)
+        for (unsigned int j = 0; j < berTable[i].size(); j++)
+            if (berTable[i][j]->snrlist.empty())
+                opp_error("ber parse file error: empty SNR list");
+    snrGrid = useSnrGrid;
+    if (snrGrid)
+        compileTable();
+}
+
+bool BerParseFile::getFileSignature(const char *filename, long long& size, long long& modificationTime)
+{
+    struct stat fileStat;
+    if (stat(filename, &fileStat) != 0)
+        return false;
+    size = fileStat.st_size;
+    modificationTime = fileStat.st_mtime;
+    return true;
+}
+
+#define BER_CACHE_MAGIC "INETBER2"
+
+bool BerParseFile::loadCacheFile(const char *cacheFilename, const char *filename)
+{
+    long long size, modificationTime;
+    if (!getFileSignature(filename, size, modificationTime))
+        return false;
+
+    std::ifstream in(cacheFilename, std::ios::in | std::ios::binary);
+    if (in.fail())
+        return false;
+
+    // the cache is only valid for the same (unmodified) source file and PHY mode
+    char magic[sizeof(BER_CACHE_MAGIC)];
+    char cachedPhyOpMode;
+    long long cachedSize, cachedModificationTime;
+    int filenameLength = 0;
+    in.read(magic, sizeof(magic));
+    in.read(&cachedPhyOpMode, sizeof(cachedPhyOpMode));
+    in.read((char *)&cachedSize, sizeof(cachedSize));
+    in.read((char *)&cachedModificationTime, sizeof(cachedModificationTime));
+    in.read((char *)&filenameLength, sizeof(filenameLength));
+    if (in.fail() || memcmp(magic, BER_CACHE_MAGIC, sizeof(magic)) != 0 || cachedPhyOpMode != phyOpMode
+            || cachedSize != size || cachedModificationTime != modificationTime || filenameLength != (int)strlen(filename))
+        return false;
+    std::string cachedFilename(filenameLength, '\0');
+    in.read(&cachedFilename[0], filenameLength);
+    if (in.fail() || cachedFilename != filename)
+        return false;
+
+    setPhyOpMode(phyOpMode);
+    for (unsigned int i = 0; i < berTable.size(); i++)
+    {
+        int numLengths = 0;
+        in.read((char *)&numLengths, sizeof(numLengths));
+        for (int j = 0; j < numLengths && !in.fail(); j++)
         {
-            snrdata3 = pre->snrlist[j];
-            if (tsnr<=snrdata3.snr)
+            LongBer *l = new LongBer;
+            berTable[i].push_back(l);
+            int numEntries = 0;
+            in.read((char *)&l->longpkt, sizeof(l->longpkt));
+            in.read((char *)&numEntries, sizeof(numEntries));
+            if (in.fail() || numEntries <= 0)
                 break;
+            l->snrlist.resize(numEntries);
+            for (int k = 0; k < numEntries; k++)
+            {
+                in.read((char *)&l->snrlist[k].snr, sizeof(double));
+                in.read((char *)&l->snrlist[k].ber, sizeof(double));
+            }
         }
-        if (j!=0)
+        if (in.fail() || numLengths <= 0)
         {
-            if (j==pre->snrlist.size())
-                snrdata4 = pre->snrlist[j-2];
-            else
-                snrdata4 = pre->snrlist[j-1];
+            // corrupt cache: fall back to parsing
+            setPhyOpMode(phyOpMode);
+            return false;
         }
-
     }
-    if (snrdata2.snr==-1)
-    {
-        snrdata2.snr = snrdata1.snr;
-        snrdata2.ber = snrdata1.ber;
-    }
-    if (snrdata4.snr==-1)
-    {
-        snrdata4.snr = snrdata3.snr;
-        snrdata4.ber = snrdata3.ber;
-    }
-    double per1, per2, per;
-    per1 = snrdata1.ber;
-    per2 = snrdata3.ber;
+    EV << "Loaded PER table of '" << filename << "' from cache file '" << cacheFilename << "'\n";
+    return true;
+}
 
-    if (tsnr <= snrdata1.snr)
+void BerParseFile::saveCacheFile(const char *cacheFilename, const char *filename)
+{
+    long long size, modificationTime;
+    if (!getFileSignature(filename, size, modificationTime))
+        return;
+
+    // write a temporary file and rename it, so that simulations running in parallel
+    // never read a partially written cache
+    std::stringstream tmpFilename;
+    tmpFilename << cacheFilename << "." << getpid() << ".tmp";
+    std::ofstream out(tmpFilename.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (out.fail())
     {
-        if (snrdata2.snr!=snrdata1.snr)
-            per1 = snrdata1.ber +  (snrdata2.ber-snrdata1.ber)/(snrdata2.snr-snrdata1.snr)*(tsnr- snrdata1.snr);
+        EV << "Cannot write PER table cache file '" << cacheFilename << "'\n";
+        return;
     }
-    if (tsnr <= snrdata3.snr)
+    int filenameLength = strlen(filename);
+    out.write(BER_CACHE_MAGIC, sizeof(BER_CACHE_MAGIC));
+    out.write(&phyOpMode, sizeof(phyOpMode));
+    out.write((const char *)&size, sizeof(size));
+    out.write((const char *)&modificationTime, sizeof(modificationTime));
+    out.write((const char *)&filenameLength, sizeof(filenameLength));
+    out.write(filename, filenameLength);
+    for (unsigned int i = 0; i < berTable.size(); i++)
     {
-        if (snrdata3.snr!=snrdata4.snr)
-            per2 = snrdata3.ber +  (snrdata4.ber-snrdata3.ber)/(snrdata4.snr-snrdata3.snr)*(tsnr- snrdata3.snr);
+        int numLengths = berTable[i].size();
+        out.write((const char *)&numLengths, sizeof(numLengths));
+        for (int j = 0; j < numLengths; j++)
+        {
+            const LongBer *l = berTable[i][j];
+            int numEntries = l->snrlist.size();
+            out.write((const char *)&l->longpkt, sizeof(l->longpkt));
+            out.write((const char *)&numEntries, sizeof(numEntries));
+            for (int k = 0; k < numEntries; k++)
+            {
+                out.write((const char *)&l->snrlist[k].snr, sizeof(double));
+                out.write((const char *)&l->snrlist[k].ber, sizeof(double));
+            }
+        }
     }
-    if (per1!=-1 && per2!=-1)
+    out.close();
+    if (out.fail())
     {
-        if (pos->longpkt != pre->longpkt)
-            per = per2 +  (per1- per2)/(pos->longpkt - pre->longpkt)*(tlen-pre->longpkt);
-        else
-            per = per2;
+        EV << "Cannot write PER table cache file '" << cacheFilename << "'\n";
+        remove(tmpFilename.str().c_str());
+        return;
     }
-    else
+    if (rename(tmpFilename.str().c_str(), cacheFilename) != 0)
     {
-        if (per1!=-1)
+        // rename() does not replace an existing file on Windows
+        remove(cacheFilename);
+        if (rename(tmpFilename.str().c_str(), cacheFilename) != 0)
         {
-            per = per1;
-        }
-        else
-        {
-            if (per2!=-1)
-            {
-                per = per2;
-            }
-            else
-            {
-                EV << "No PER available";
-            }
+            EV << "Cannot write PER table cache file '" << cacheFilename << "'\n";
+            remove(tmpFilename.str().c_str());
         }
     }
-    return per;
 }
 
-
-void BerParseFile::parseFile(const char *filename)
+void BerParseFile::parseTextFile(const char *filename)
 {
     std::ifstream in(filename, std::ios::in);
     if (in.fail())
@@ -60,18 +60,55 @@ class BerParseFile
     char phyOpMode;
     bool fileBer;
 
+    /**
+     * Optionally (see parseFile()), the parsed table compiled into PER values
+     * sampled over a common SNR grid, so that getPer() does not have to search
+     * the SNR lists. The grid is uniform in log(SNR): every octave of the
+     * (linear) SNR is divided into SNR_BINS_PER_OCTAVE bins, and the bin index
+     * is computed with frexp(). The PER is piecewise linear in the SNR between
+     * the table entries, and so is the interpolation within a bin, so the grid
+     * reproduces the table exactly except in the bins that contain a table
+     * entry; there the PER may differ from the exact interpolation by up to
+     * 6e-4 on per_table_80211g_Trivellato.dat.
+     */
+    bool snrGrid;
+    std::vector<std::vector<std::vector<double> > > compiledTable; // PERs indexed by berTable position, length, SNR grid position
+    enum { SNR_BINS_PER_OCTAVE = 128 };
+    int minSnrExponent;
+    int numSnrGridPoints;
+
     int getTablePosition(double speed);
     void clearBerTable();
     double dB2fraction(double dB)
     {
         return pow(10.0, (dB / 10));
     }
+    void parseTextFile(const char *filename);
+    void compileTable();
+    double getGridSnr(int index) const;
+    double getGridPer(const std::vector<double>& pers, double tsnr) const;
+    static double interpolateSnr(const SnrBerList& snrlist, double tsnr);
+
+    /** @name Binary cache of the parsed table, see parseFile() */
+    //@{
+    bool loadCacheFile(const char *cacheFilename, const char *filename);
+    void saveCacheFile(const char *cacheFilename, const char *filename);
+    static bool getFileSignature(const char *filename, long long& size, long long& modificationTime);
+    //@}
+
   public:
-    void parseFile(const char *filename);
+    /**
+     * Parses the table in ns2 format. If cacheFilename is not empty and that file
+     * contains the table parsed from the same (unmodified) file, it is loaded from there
+     * instead; otherwise the parsed table is written to it. If useSnrGrid is true,
+     * getPer() uses the approximate SNR grid (see compiledTable) instead of the
+     * exact interpolation between the table entries.
+     */
+    void parseFile(const char *filename, const char *cacheFilename = NULL, bool useSnrGrid = false);
     bool isFile() {return fileBer;}
     void setPhyOpMode(char p);
     double getPer(double speed, double tsnr, int tlen);
-    BerParseFile(char p) {setPhyOpMode(p); fileBer = false;}
+    BerParseFile(char p) {snrGrid = false; minSnrExponent = 0; numSnrGridPoints = 0; setPhyOpMode(p); fileBer = false;}
     ~BerParseFile();
 };
 
@@ -23,6 +23,7 @@
 #include "FWMath.h"
 #include "yans-error-rate-model.h"
 #include "nist-error-rate-model.h"
+#include "TabulatedErrorRateModel.h"
 #define NS3CALMODE
 
 
@@ -66,6 +67,10 @@ void Ieee80211RadioModel::initializeFrom(cModule *radioModule)
     else
         opp_error("Error %s model is not valid",radioModule->par("errorModel").stringValue());
 
+    int errorModelTablePrecision = radioModule->par("errorModelTablePrecision");
+    if (errorModelTablePrecision > 0)
+        errorModel = new TabulatedErrorRateModel(errorModel, errorModelTablePrecision);
+
 
     btSize = radioModule->par("btSize").longValue();
     autoHeaderSize = radioModule->par("AutoHeaderSize");
@@ -82,7 +87,7 @@ void Ieee80211RadioModel::initializeFrom(cModule *radioModule)
     if (!name.empty())
     {
         parseTable = new BerParseFile(phyOpMode);
-        parseTable->parseFile(fname);
+        parseTable->parseFile(fname, radioModule->par("berTableCacheFile"), radioModule->par("berTableSnrGrid"));
         fileBer = true;
     }
     else
@@ -132,10 +137,7 @@ double Ieee80211RadioModel::calculateDuration(AirFrame *airframe)
 PhyIndication Ieee80211RadioModel::isReceivedCorrectly(AirFrame *airframe, const SnrList& receivedList)
 {
     // calculate snirMin
-    double snirMin = receivedList.begin()->snr;
-    for (SnrList::const_iterator iter = receivedList.begin(); iter != receivedList.end(); iter++)
-        if (iter->snr < snirMin)
-            snirMin = iter->snr;
+    double snirMin = receivedList.getMinSnr();
 
     cPacket *frame = airframe->getEncapsulatedPacket();
     EV << "packet (" << frame->getClassName() << ")" << frame->getName() << " (" << frame->info() << ") snrMin=" << snirMin << endl;
@@ -0,0 +1,98 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include <math.h>
+
+#include "TabulatedErrorRateModel.h"
+
+// per-bit log success rate used instead of -inf, so that interpolation stays finite
+#define MIN_LOG_SUCCESS_RATE -1000.0
+
+TabulatedErrorRateModel::ModeKey::ModeKey(const ModulationType& mode) :
+    modulationClass(mode.getModulationClass()),
+    codeRate(mode.getCodeRate()),
+    constellationSize(mode.getConstellationSize()),
+    dataRate(mode.getDataRate()),
+    phyRate(mode.getPhyRate()),
+    bandwidth(mode.getBandwidth())
+{
+}
+
+bool TabulatedErrorRateModel::ModeKey::operator<(const ModeKey& other) const
+{
+    if (modulationClass != other.modulationClass) return modulationClass < other.modulationClass;
+    if (codeRate != other.codeRate) return codeRate < other.codeRate;
+    if (constellationSize != other.constellationSize) return constellationSize < other.constellationSize;
+    if (dataRate != other.dataRate) return dataRate < other.dataRate;
+    if (phyRate != other.phyRate) return phyRate < other.phyRate;
+    return bandwidth < other.bandwidth;
+}
+
+TabulatedErrorRateModel::TabulatedErrorRateModel(IErrorModel *errorModel, int binsPerOctave) :
+    errorModel(errorModel), binsPerOctave(binsPerOctave)
+{
+    if (binsPerOctave <= 0)
+        throw cRuntimeError("TabulatedErrorRateModel: invalid number of bins per octave: %d", binsPerOctave);
+}
+
+TabulatedErrorRateModel::~TabulatedErrorRateModel()
+{
+    delete errorModel;
+}
+
+double TabulatedErrorRateModel::getSnr(int index) const
+{
+    // inverse of the index computation in GetChunkSuccessRate()
+    int exponent = MIN_EXPONENT + index / binsPerOctave;
+    double mantissa = 0.5 + 0.5 * (index % binsPerOctave) / binsPerOctave;
+    return ldexp(mantissa, exponent);
+}
+
+const TabulatedErrorRateModel::Table& TabulatedErrorRateModel::getTable(const ModulationType& mode) const
+{
+    Table& table = tables[ModeKey(mode)];
+    if (table.empty())
+    {
+        int size = (MAX_EXPONENT - MIN_EXPONENT + 1) * binsPerOctave + 1;
+        table.resize(size);
+        for (int i = 0; i < size; i++)
+        {
+            double successRate = errorModel->GetChunkSuccessRate(mode, getSnr(i), 1);
+            table[i] = successRate > 0 ? std::max(log(successRate), MIN_LOG_SUCCESS_RATE) : MIN_LOG_SUCCESS_RATE;
+        }
+    }
+    return table;
+}
+
+double TabulatedErrorRateModel::GetChunkSuccessRate(ModulationType mode, double snr, uint32_t nbits) const
+{
+    // the DSSS models are piecewise (e.g. WLAN_SIR_PERFECT), which interpolation would smear
+    bool isOfdm = mode.getModulationClass() == MOD_CLASS_OFDM || mode.getModulationClass() == MOD_CLASS_ERP_OFDM;
+    if (!isOfdm || !(snr > 0))
+        return errorModel->GetChunkSuccessRate(mode, snr, nbits);
+
+    int exponent;
+    double mantissa = frexp(snr, &exponent);  // snr = mantissa * 2^exponent, mantissa in [0.5,1)
+    if (exponent < MIN_EXPONENT || exponent > MAX_EXPONENT)
+        return errorModel->GetChunkSuccessRate(mode, snr, nbits);
+
+    const Table& table = getTable(mode);
+    double position = (mantissa - 0.5) * 2 * binsPerOctave;
+    int bin = (int)position;
+    double fraction = position - bin;
+    int index = (exponent - MIN_EXPONENT) * binsPerOctave + bin;
+    double logSuccessRate = table[index] + fraction * (table[index + 1] - table[index]);
+    return exp(logSuccessRate * nbits);
+}
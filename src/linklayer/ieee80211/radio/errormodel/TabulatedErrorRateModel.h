@@ -0,0 +1,73 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef TABULATEDERRORRATEMODEL_H_
+#define TABULATEDERRORRATEMODEL_H_
+
+#include <map>
+#include <vector>
+
+#include "WifiMode.h"
+#include "IErrorModel.h"
+
+/**
+ * Error model that looks up chunk success rates from precomputed tables
+ * instead of evaluating the closed-form expressions of another error model
+ * for every frame.
+ *
+ * All wrapped models compute the success rate of n bits as S(1)^n, so the
+ * table stores ln S(1), the per-bit log success rate, for every modulation
+ * mode. The SNIR axis is quantized logarithmically: every octave of the
+ * (linear) SNIR is divided into binsPerOctave equal bins, and the value is
+ * linearly interpolated between bin boundaries. The bin index is computed
+ * with frexp(), so a lookup only needs a single exp() call. SNIR values
+ * outside the table range and DSSS modes are passed to the wrapped model.
+ */
+class TabulatedErrorRateModel : public IErrorModel
+{
+  protected:
+    struct ModeKey
+    {
+        int modulationClass;
+        int codeRate;
+        int constellationSize;
+        uint32_t dataRate;
+        uint32_t phyRate;
+        uint32_t bandwidth;
+
+        ModeKey(const ModulationType& mode);
+        bool operator<(const ModeKey& other) const;
+    };
+    typedef std::vector<double> Table;
+    typedef std::map<ModeKey, Table> ModeToTableMap;
+
+    enum { MIN_EXPONENT = -4, MAX_EXPONENT = 14 };  // ~-12dB .. ~42dB
+
+    IErrorModel *errorModel;
+    int binsPerOctave;
+    mutable ModeToTableMap tables;
+
+  protected:
+    const Table& getTable(const ModulationType& mode) const;
+    double getSnr(int index) const;
+
+  public:
+    /** Takes ownership of the wrapped error model. */
+    TabulatedErrorRateModel(IErrorModel *errorModel, int binsPerOctave);
+    virtual ~TabulatedErrorRateModel();
+    virtual double GetChunkSuccessRate(ModulationType mode, double snr, uint32_t nbits) const;
+};
+
+#endif /* TABULATEDERRORRATEMODEL_H_ */
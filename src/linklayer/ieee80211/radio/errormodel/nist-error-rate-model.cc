@@ -87,31 +87,31 @@ double NistErrorRateModel::GetFecQpskBer(double snr, double nbits, uint32_t bVal
 
 double NistErrorRateModel::CalculatePe(double p, uint32_t bValue) const
 {
+    // the polynomials of the tables are evaluated with Horner's rule
     double D = sqrt(4.0 * p * (1.0 - p));
+    double D2 = D * D;
+    double D4 = D2 * D2;
     double pe = 1.0;
     if (bValue == 1)
     {
         // code rate 1/2, use table 3.1.1
-        pe = 0.5
-                * (36.0 * pow(D, 10.0) + 211.0 * pow(D, 12.0) + 1404.0 * pow(D, 14.0) + 11633.0 * pow(D, 16.0)
-                        + 77433.0 * pow(D, 18.0) + 502690.0 * pow(D, 20.0) + 3322763.0 * pow(D, 22.0)
-                        + 21292910.0 * pow(D, 24.0) + 134365911.0 * pow(D, 26.0));
+        pe = 0.5 * D4 * D4 * D2
+                * (36.0 + D2 * (211.0 + D2 * (1404.0 + D2 * (11633.0 + D2 * (77433.0 + D2 * (502690.0
+                        + D2 * (3322763.0 + D2 * (21292910.0 + D2 * 134365911.0))))))));
     }
     else if (bValue == 2)
     {
         // code rate 2/3, use table 3.1.2
-        pe = 1.0 / (2.0 * bValue)
-                * (3.0 * pow(D, 6.0) + 70.0 * pow(D, 7.0) + 285.0 * pow(D, 8.0) + 1276.0 * pow(D, 9.0)
-                        + 6160.0 * pow(D, 10.0) + 27128.0 * pow(D, 11.0) + 117019.0 * pow(D, 12.0)
-                        + 498860.0 * pow(D, 13.0) + 2103891.0 * pow(D, 14.0) + 8784123.0 * pow(D, 15.0));
+        pe = 1.0 / (2.0 * bValue) * D4 * D2
+                * (3.0 + D * (70.0 + D * (285.0 + D * (1276.0 + D * (6160.0 + D * (27128.0 + D * (117019.0
+                        + D * (498860.0 + D * (2103891.0 + D * 8784123.0)))))))));
     }
     else if (bValue == 3)
     {
         // code rate 3/4, use table 3.1.2
-        pe = 1.0 / (2.0 * bValue)
-                * (42.0 * pow(D, 5.0) + 201.0 * pow(D, 6.0) + 1492.0 * pow(D, 7.0) + 10469.0 * pow(D, 8.0)
-                        + 62935.0 * pow(D, 9.0) + 379644.0 * pow(D, 10.0) + 2253373.0 * pow(D, 11.0)
-                        + 13073811.0 * pow(D, 12.0) + 75152755.0 * pow(D, 13.0) + 428005675.0 * pow(D, 14.0));
+        pe = 1.0 / (2.0 * bValue) * D4 * D
+                * (42.0 + D * (201.0 + D * (1492.0 + D * (10469.0 + D * (62935.0 + D * (379644.0 + D * (2253373.0
+                        + D * (13073811.0 + D * (75152755.0 + D * 428005675.0)))))))));
     }
     else
     {
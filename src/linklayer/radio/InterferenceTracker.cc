@@ -0,0 +1,97 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <math.h>
+
+#include "InterferenceTracker.h"
+
+#include "AirFrame_m.h"
+
+
+InterferenceTracker::Key InterferenceTracker::getKey(AirFrame *frame)
+{
+    Key key;
+    key.endTime = frame->getArrivalTime() + frame->getDuration();
+    key.id = frame->getId();
+    return key;
+}
+
+InterferenceTracker::EntryMap::iterator InterferenceTracker::find(AirFrame *frame)
+{
+    EntryMap::iterator it = entries.find(getKey(frame));
+    if (it == entries.end() || it->second.frame != frame)
+        throw cRuntimeError("InterferenceTracker: frame (%s)%s is not being received", frame->getClassName(), frame->getName());
+    return it;
+}
+
+void InterferenceTracker::addNoisePower(double power)
+{
+    // Kahan-Babuska (Neumaier) summation: the compensation collects the
+    // low-order bits lost in the sum, also when power is negative
+    double sum = noisePowerSum + power;
+    if (fabs(noisePowerSum) >= fabs(power))
+        noisePowerCompensation += (noisePowerSum - sum) + power;
+    else
+        noisePowerCompensation += (power - sum) + noisePowerSum;
+    noisePowerSum = sum;
+}
+
+void InterferenceTracker::add(AirFrame *frame, double power, bool isNoise)
+{
+    Entry entry;
+    entry.frame = frame;
+    entry.power = power;
+    entry.isNoise = isNoise;
+    if (!entries.insert(std::make_pair(getKey(frame), entry)).second)
+        throw cRuntimeError("InterferenceTracker: frame (%s)%s is already being received", frame->getClassName(), frame->getName());
+    if (isNoise)
+    {
+        numNoiseFrames++;
+        addNoisePower(power);
+    }
+}
+
+double InterferenceTracker::remove(AirFrame *frame)
+{
+    EntryMap::iterator it = find(frame);
+    double power = it->second.power;
+    if (it->second.isNoise)
+    {
+        if (--numNoiseFrames == 0)
+            noisePowerSum = noisePowerCompensation = 0;
+        else
+            addNoisePower(-power);
+    }
+    entries.erase(it);
+    return power;
+}
+
+void InterferenceTracker::setNoise(AirFrame *frame)
+{
+    Entry& entry = find(frame)->second;
+    if (!entry.isNoise)
+    {
+        entry.isNoise = true;
+        numNoiseFrames++;
+        addNoisePower(entry.power);
+    }
+}
+
+void InterferenceTracker::clear()
+{
+    entries.clear();
+    numNoiseFrames = 0;
+    noisePowerSum = noisePowerCompensation = 0;
+}
@@ -0,0 +1,114 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INTERFERENCE_TRACKER_H__
+#define __INTERFERENCE_TRACKER_H__
+
+#include <map>
+
+#include "INETDefs.h"
+
+class AirFrame;
+
+/**
+ * Keeps track of the frames a radio is currently receiving, together with
+ * their receive power, and of the total power of those that are just noise.
+ *
+ * Frames are ordered by the end of their reception (and by message id for
+ * frames ending at the same time), so the iteration order, and thus the
+ * simulation results, do not depend on memory addresses; insertion and
+ * removal are O(log n). The end time of a frame is its arrival time plus
+ * its duration, which must not change while the frame is tracked.
+ *
+ * The total noise power is accumulated with compensated (Kahan-Babuska)
+ * summation, and it is reset to exactly zero whenever no noise frame is
+ * left, so rounding errors of the additions and subtractions neither grow
+ * over the simulation nor depend on the order in which receptions overlap.
+ */
+class INET_API InterferenceTracker
+{
+  protected:
+    struct Key
+    {
+        simtime_t endTime;
+        long id;
+        bool operator<(const Key& other) const {return endTime < other.endTime || (endTime == other.endTime && id < other.id);}
+    };
+
+    struct Entry
+    {
+        AirFrame *frame;
+        double power;
+        bool isNoise;
+    };
+
+    typedef std::map<Key, Entry> EntryMap;
+
+  public:
+    typedef EntryMap::const_iterator const_iterator;
+
+  protected:
+    EntryMap entries;
+    int numNoiseFrames;
+    double noisePowerSum;
+    double noisePowerCompensation;
+
+  protected:
+    static Key getKey(AirFrame *frame);
+    void addNoisePower(double power);
+    EntryMap::iterator find(AirFrame *frame);
+
+  public:
+    InterferenceTracker() {numNoiseFrames = 0; noisePowerSum = noisePowerCompensation = 0;}
+
+    /**
+     * Adds a frame with the given receive power; noise frames are
+     * counted in getNoisePower().
+     */
+    void add(AirFrame *frame, double power, bool isNoise);
+
+    /**
+     * Removes the frame and returns its receive power.
+     */
+    double remove(AirFrame *frame);
+
+    /**
+     * Turns a frame being received into noise, e.g. because the radio
+     * started transmitting.
+     */
+    void setNoise(AirFrame *frame);
+
+    /**
+     * Returns the total receive power of the noise frames.
+     */
+    double getNoisePower() const {return numNoiseFrames == 0 ? 0 : noisePowerSum + noisePowerCompensation;}
+
+    /**
+     * Removes all frames; it does not delete them.
+     */
+    void clear();
+
+    bool empty() const {return entries.empty();}
+    int size() const {return entries.size();}
+
+    /** @name Iteration in the order of reception end times */
+    //@{
+    const_iterator begin() const {return entries.begin();}
+    const_iterator end() const {return entries.end();}
+    static AirFrame *getFrame(const_iterator it) {return it->second.frame;}
+    //@}
+};
+
+#endif
@@ -25,6 +25,7 @@
 #include "PhyControlInfo_m.h"
 #include "Radio80211aControlInfo_m.h"
 #include "BasicBattery.h"
+#include "FreeSpaceModel.h"
 #include "NodeStatus.h"
 #include "NodeOperations.h"
 
@@ -210,6 +211,9 @@ void Radio::initialize(int stage)
 
 void Radio::finish()
 {
+    FreeSpaceModel *freeSpaceModel = dynamic_cast<FreeSpaceModel *>(receptionModel);
+    if (freeSpaceModel && freeSpaceModel->isPathLossCacheValidated())
+        recordScalar("max path loss cache deviation", freeSpaceModel->getMaxPathLossCacheDeviation());
 }
 
 Radio::~Radio()
@@ -222,8 +226,8 @@ Radio::~Radio()
     if (updateString)
         cancelAndDelete(updateString);
     // delete messages being received
-    for (RecvBuff::iterator it = recvBuff.begin(); it!=recvBuff.end(); ++it)
-        delete it->first;
+    for (InterferenceTracker::const_iterator it = recvBuff.begin(); it!=recvBuff.end(); ++it)
+        delete InterferenceTracker::getFrame(it);
 }
 
 bool Radio::handleOperationStage(LifecycleOperation *operation, int stage, IDoneCallback *doneCallback)
@@ -436,12 +440,13 @@ void Radio::handleUpperMsg(AirFrame *airframe)
         // received. This message is treated as noise now and the
         // receive power has to be added to the noiseLevel
 
+        // add the receive power to the noise level
+        recvBuff.setNoise(snrInfo.ptr);
+        noiseLevel = thermalNoise + recvBuff.getNoisePower();
         // delete the pointer to indicate that no message is being received
         snrInfo.ptr = NULL;
         // clear the snr list
         snrInfo.sList.clear();
-        // add the receive power to the noise level
-        noiseLevel += snrInfo.rcvdPower;
     }
 
     // now we are done with all the exception handling and can take care
@@ -622,8 +627,6 @@ void Radio::handleLowerMsgStart(AirFrame* airframe)
     if (obstacles && distance > MIN_DISTANCE)
         rcvdPower = obstacles->calculateReceivedPower(rcvdPower, carrierFrequency, framePos, 0, getRadioPosition(), 0);
     airframe->setPowRec(rcvdPower);
-    // store the receive power in the recvBuff
-    recvBuff[airframe] = rcvdPower;
     updateSensitivity(airframe->getBitrate());
 
     // if receive power is bigger than sensitivity and if not sending
@@ -635,11 +638,13 @@ void Radio::handleLowerMsgStart(AirFrame* airframe)
     {
         EV << "receiving frame " << airframe->getName() << endl;
 
+        // store the receive power in the recvBuff
+        recvBuff.add(airframe, rcvdPower, false);
+
         // Put frame and related SnrList in receive buffer
-        SnrList snrList;
         snrInfo.ptr = airframe;
         snrInfo.rcvdPower = rcvdPower;
-        snrInfo.sList = snrList;
+        snrInfo.sList.clear();
 
         // add initial snr value
         addNewSnr();
@@ -655,8 +660,9 @@ void Radio::handleLowerMsgStart(AirFrame* airframe)
     else
     {
         EV << "frame " << airframe->getName() << " is just noise\n";
-        //add receive power to the noise level
-        noiseLevel += rcvdPower;
+        // store the receive power in the recvBuff, and add it to the noise level
+        recvBuff.add(airframe, rcvdPower, true);
+        noiseLevel = thermalNoise + recvBuff.getNoisePower();
 
         // if a message is being received add a new snr value
         if (snrInfo.ptr != NULL)
@@ -693,30 +699,23 @@ void Radio::handleLowerMsgEnd(AirFrame * airframe)
     if (snrInfo.ptr == airframe)
     {
         EV << "reception of frame over, preparing to send packet to upper layer\n";
-        // get Packet and list out of the receive buffer:
-        SnrList list;
-        list = snrInfo.sList;
-
         // delete the pointer to indicate that no message is currently
-        // being received and clear the list
-
-        double snirMin = snrInfo.sList.begin()->snr;
-        for (SnrList::const_iterator iter = snrInfo.sList.begin(); iter != snrInfo.sList.end(); iter++)
-            if (iter->snr < snirMin)
-                snirMin = iter->snr;
+        // being received; the list is cleared after the decision, so that
+        // it can be passed to the radio model without copying
+        double snirMin = snrInfo.sList.getMinSnr();
         snrInfo.ptr = NULL;
-        snrInfo.sList.clear();
         airframe->setSnr(10*log10(snirMin)); //ahmed
         airframe->setLossRate(lossRate);
         // delete the frame from the recvBuff
-        recvBuff.erase(airframe);
+        recvBuff.remove(airframe);
 
         //XXX send up the frame:
         //if (radioModel->isReceivedCorrectly(airframe, list))
         //    sendUp(airframe);
         //else
         //    delete airframe;
-        PhyIndication frameState = radioModel->isReceivedCorrectly(airframe, list);
+        PhyIndication frameState = radioModel->isReceivedCorrectly(airframe, snrInfo.sList);
+        snrInfo.sList.clear();
         if (frameState != FRAMEOK)
         {
             airframe->getEncapsulatedPacket()->setKind(frameState);
@@ -740,11 +739,9 @@ void Radio::handleLowerMsgEnd(AirFrame * airframe)
     else
     {
         EV << "reception of noise message over, removing recvdPower from noiseLevel....\n";
-        // get the rcvdPower and subtract it from the noiseLevel
-        noiseLevel -= recvBuff[airframe];
-
-        // delete message from the recvBuff
-        recvBuff.erase(airframe);
+        // delete message from the recvBuff, which subtracts its rcvdPower from the noise
+        recvBuff.remove(airframe);
+        noiseLevel = thermalNoise + recvBuff.getNoisePower();
 
         // update snr info for message currently being received if any
         if (snrInfo.ptr != NULL)
@@ -785,9 +782,9 @@ void Radio::changeChannel(int channel)
         error("changing channel while transmitting is not allowed");
 
    // Clear the recvBuff
-   for (RecvBuff::iterator it = recvBuff.begin(); it!=recvBuff.end(); ++it)
+   for (InterferenceTracker::const_iterator it = recvBuff.begin(); it!=recvBuff.end(); ++it)
    {
-        AirFrame *airframe = it->first;
+        AirFrame *airframe = InterferenceTracker::getFrame(it);
         cMessage *endRxTimer = (cMessage *)airframe->getContextPointer();
         delete airframe;
         delete cancelEvent(endRxTimer);
@@ -822,7 +819,8 @@ void Radio::changeChannel(int channel)
 
     // pick up ongoing transmissions on the new channel
     EV << "Picking up ongoing transmissions on new channel:\n";
-    IChannelControl::TransmissionList tlAux = cc->getOngoingTransmissions(channel);
+    IChannelControl::TransmissionList tlAux;
+    cc->getOngoingTransmissions(channel, getRadioPosition(), cc->getInterferenceRange(myRadioRef), tlAux);
     for (IChannelControl::TransmissionList::const_iterator it = tlAux.begin(); it != tlAux.end(); ++it)
     {
         AirFrame *airframe = check_and_cast<AirFrame *> (*it);
@@ -1070,14 +1068,15 @@ void Radio::disconnectReceiver()
         error("changing channel while transmitting is not allowed");
 
    // Clear the recvBuff
-   for (RecvBuff::iterator it = recvBuff.begin(); it!=recvBuff.end(); ++it)
+   for (InterferenceTracker::const_iterator it = recvBuff.begin(); it!=recvBuff.end(); ++it)
    {
-        AirFrame *airframe = it->first;
+        AirFrame *airframe = InterferenceTracker::getFrame(it);
         cMessage *endRxTimer = (cMessage *)airframe->getContextPointer();
         delete airframe;
         delete cancelEvent(endRxTimer);
     }
     recvBuff.clear();
+    noiseLevel = thermalNoise;
 
     // clear snr info
     snrInfo.ptr = NULL;
@@ -1103,7 +1102,8 @@ void Radio::connectReceiver()
 
     // pick up ongoing transmissions on the new channel
     EV << "Picking up ongoing transmissions on new channel:\n";
-    IChannelControl::TransmissionList tlAux = cc->getOngoingTransmissions(rs.getChannelNumber());
+    IChannelControl::TransmissionList tlAux;
+    cc->getOngoingTransmissions(rs.getChannelNumber(), getRadioPosition(), cc->getInterferenceRange(myRadioRef), tlAux);
     for (IChannelControl::TransmissionList::const_iterator it = tlAux.begin(); it != tlAux.end(); ++it)
     {
         AirFrame *airframe = check_and_cast<AirFrame *> (*it);
@@ -25,6 +25,7 @@
 #include "IRadioModel.h"
 #include "IReceptionModel.h"
 #include "SnrList.h"
+#include "InterferenceTracker.h"
 #include "ObstacleControl.h"
 #include "INoiseGenerator.h"
 #include "ILifecycle.h"
@@ -194,23 +195,11 @@ class INET_API Radio : public ChannelAccess, public ILifecycle
      */
     SnrStruct snrInfo;
 
-    /**
-     * Typedef used to store received messages together with
-     * receive power.
-     */
-    struct Compare {
-        bool operator() (AirFrame* const &lhs, AirFrame* const &rhs) const {
-            ASSERT(lhs && rhs);
-            return lhs->getId() < rhs->getId();
-        }
-    };
-    typedef std::map<AirFrame*, double, Compare> RecvBuff;
-
     /**
      * State: A buffer to store a pointer to a message and the related
-     * receive power.
+     * receive power, and the total power of the messages that are noise.
      */
-    RecvBuff recvBuff;
+    InterferenceTracker recvBuff;
 
     /** State: the current RadioState of the NIC; includes channel number */
     RadioState rs;
@@ -221,7 +210,7 @@ class INET_API Radio : public ChannelAccess, public ILifecycle
     /** State: if not -1, we have to switch to that bitrate once we finished transmitting */
     double newBitrate;
 
-    /** State: the current noise level of the channel.*/
+    /** State: the current noise level of the channel: thermal noise plus the noise messages in recvBuff.*/
     double noiseLevel;
 
     /**
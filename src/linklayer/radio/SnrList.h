@@ -20,7 +20,9 @@
 #ifndef SNRLIST_H
 #define SNRLIST_H
 
-#include <list>
+#include <vector>
+
+#include "INETDefs.h"
 
 /**
  * @brief struct for SNR information
@@ -41,16 +43,79 @@ struct SnrListEntry{
 };
 
 /**
- * @brief List to store SNR information for a message
+ * @brief Piecewise constant SNR timeline of a message
  *
  * used to store SNR information of a message and pass it to the
- * Decider. Each SnrListEntry in this list corresponds to one SNR
- * value at a specific time.
+ * Decider. Each SnrListEntry corresponds to one SNR value starting
+ * at a specific time; entries must be appended in time order.
+ *
+ * Entries are stored contiguously, and clear() keeps the storage, so a
+ * timeline reused for consecutive messages stops allocating once it has
+ * grown to the largest number of interference changes seen during a
+ * reception. The minimum and the time integral of the SNR are maintained
+ * as entries are appended, so getMinSnr() and getMeanSnr() do not scan
+ * the entries.
  *
  * @ingroup utils
  * @ingroup basicUtils
  * @author Marc Lbbers
  */
-typedef std::list<SnrListEntry> SnrList;
+class SnrList
+{
+  public:
+    typedef std::vector<SnrListEntry>::const_iterator const_iterator;
+
+  protected:
+    std::vector<SnrListEntry> entries;
+    double minSnr;
+    double snrIntegral;  // integral of the SNR over time from the first entry to the last one
+
+  public:
+    SnrList() {minSnr = 0; snrIntegral = 0;}
+
+    /** @brief Appends a new SNR value; its time must not be earlier than that of the last entry */
+    void push_back(const SnrListEntry& entry)
+    {
+        if (entries.empty())
+            minSnr = entry.snr;
+        else
+        {
+            const SnrListEntry& last = entries.back();
+            ASSERT(entry.time >= last.time);
+            snrIntegral += last.snr * SIMTIME_DBL(entry.time - last.time);
+            if (entry.snr < minSnr)
+                minSnr = entry.snr;
+        }
+        entries.push_back(entry);
+    }
+
+    /** @brief Removes all entries, but keeps the allocated storage */
+    void clear() {entries.clear(); minSnr = 0; snrIntegral = 0;}
+
+    bool empty() const {return entries.empty();}
+    size_t size() const {return entries.size();}
+    const_iterator begin() const {return entries.begin();}
+    const_iterator end() const {return entries.end();}
+    const SnrListEntry& front() const {return entries.front();}
+    const SnrListEntry& back() const {return entries.back();}
+
+    /** @brief Returns the smallest SNR value of the timeline (0 if empty) */
+    double getMinSnr() const {return minSnr;}
+
+    /**
+     * @brief Returns the time-weighted mean SNR between the first entry and
+     * endTime, which must not be earlier than the time of the last entry
+     */
+    double getMeanSnr(simtime_t endTime) const
+    {
+        if (entries.empty())
+            return 0;
+        const SnrListEntry& last = entries.back();
+        double duration = SIMTIME_DBL(endTime - entries.front().time);
+        if (duration <= 0)
+            return last.snr;
+        return (snrIntegral + last.snr * SIMTIME_DBL(endTime - last.time)) / duration;
+    }
+};
 
 #endif
@@ -29,10 +29,21 @@
 #include <FWMath.h>
 #include <string>
 #include <iostream>
+#include <sstream>
 using namespace std;
 
 Register_Class(FreeSpaceModel);
 
+FreeSpaceModel::FreeSpaceModel()
+{
+    Gr = Gt = L = 1;
+    pathLossAlpha = 2;
+    pathLossCachePrecision = 0;
+    validatePathLossCache = false;
+    maxPathLossCacheDeviation = 0;
+    pathLossCache = NULL;
+}
+
 void FreeSpaceModel::initializeFreeSpace(cModule *radioModule)
 {
     pathLossAlpha = radioModule->par("pathLossAlpha");
@@ -42,6 +53,8 @@ void FreeSpaceModel::initializeFreeSpace(cModule *radioModule)
     Gt = pow(10, radioModule->par("TransmissionAntennaGainIndB").doubleValue()/10);
     Gr = pow(10, radioModule->par("ReceiveAntennaGainIndB").doubleValue()/10);
     L = pow(10, radioModule->par("SystemLossFactor").doubleValue()/10);
+    pathLossCachePrecision = radioModule->hasPar("pathLossCachePrecision") ? (int)radioModule->par("pathLossCachePrecision") : 0;
+    validatePathLossCache = radioModule->hasPar("pathLossCacheValidation") ? radioModule->par("pathLossCacheValidation").boolValue() : false;
 }
 
 void FreeSpaceModel::initializeFrom(cModule *radioModule)
@@ -53,7 +66,8 @@ void FreeSpaceModel::initializeFrom(cModule *radioModule)
 double FreeSpaceModel::calculateReceivedPower(double pSend, double carrierFrequency, double distance)
 {
     double waveLength = SPEED_OF_LIGHT / carrierFrequency;
-    double prec = freeSpace(Gt, Gr, L, pSend, waveLength, distance, pathLossAlpha);
+    double prec = pathLossCachePrecision > 0 ? pSend * getPathLoss(carrierFrequency, distance) :
+            freeSpace(Gt, Gr, L, pSend, waveLength, distance, pathLossAlpha);
     if (prec > pSend)
         prec = pSend;
     return prec;
@@ -81,6 +95,39 @@ double FreeSpaceModel::freeSpace(double Gt, double Gr, double L, double Pt, doub
   return pr;
 }
 
+double FreeSpaceModel::calculatePathLoss(double carrierFrequency, double distance)
+{
+    double waveLength = SPEED_OF_LIGHT / carrierFrequency;
+    return freeSpace(Gt, Gr, L, 1.0, waveLength, distance, pathLossAlpha);
+}
+
+std::string FreeSpaceModel::getPathLossCacheKey()
+{
+    std::ostringstream os;
+    os.precision(17);
+    os << getClassName() << " alpha=" << pathLossAlpha << " Gt=" << Gt << " Gr=" << Gr << " L=" << L
+       << " bins=" << pathLossCachePrecision;
+    return os.str();
+}
+
+double FreeSpaceModel::getPathLoss(double carrierFrequency, double distance)
+{
+    if (!pathLossCache)
+        pathLossCache = PathLossCache::getCache(getPathLossCacheKey(), pathLossCachePrecision);
+    double pathLoss = pathLossCache->getPathLoss(this, carrierFrequency, distance);
+    if (validatePathLossCache)
+    {
+        double exact = calculatePathLoss(carrierFrequency, distance);
+        if (exact > 0)
+        {
+            double deviation = fabs(pathLoss - exact) / exact;
+            if (deviation > maxPathLossCacheDeviation)
+                maxPathLossCacheDeviation = deviation;
+        }
+    }
+    return pathLoss;
+}
+
 double FreeSpaceModel::calculateDistance(double pSend, double pRec, double carrierFrequency)
 {
   /** @brief
@@ -34,6 +34,7 @@
 
 #include "FWMath.h"
 #include "IReceptionModel.h"
+#include "PathLossCache.h"
 
 using namespace std;
 
@@ -52,19 +53,38 @@ using namespace std;
 class INET_API FreeSpaceModel : public IReceptionModel {
 
 public:
+    FreeSpaceModel();
     virtual void initializeFrom(cModule *radioModule);
     /**
      * To be redefined to calculate the received power of a transmission.
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance);
     virtual double calculateDistance(double pSend, double pRec, double carrierFrequency);
+    /**
+     * Exact deterministic path loss (received/transmitted power ratio) of the model,
+     * without fading. Used to fill the path loss cache.
+     */
+    virtual double calculatePathLoss(double carrierFrequency, double distance);
+    /** Returns the largest relative deviation of the cached path loss from the exact one, seen so far in validation mode */
+    double getMaxPathLossCacheDeviation() const { return maxPathLossCacheDeviation; }
+    bool isPathLossCacheValidated() const { return pathLossCachePrecision > 0 && validatePathLossCache; }
     ~FreeSpaceModel() { };
 
     protected:
         double Gr, Gt, L;
         double pathLossAlpha;
+
+        int pathLossCachePrecision; // bins per octave of distance, 0 means no caching
+        bool validatePathLossCache;
+        double maxPathLossCacheDeviation;
+        PathLossCache *pathLossCache; // shared by the models with the same parameters, created on first use
+
         virtual void initializeFreeSpace(cModule *);
         virtual double freeSpace(double Gt, double Gr, double L, double Pt, double lambda, double distance, double pathLossAlpha);
+        /** Returns the key identifying the parameters that calculatePathLoss() depends on */
+        virtual std::string getPathLossCacheKey();
+        /** Returns the path loss from the cache; only to be called if pathLossCachePrecision > 0 */
+        virtual double getPathLoss(double carrierFrequency, double distance);
 };
 
 
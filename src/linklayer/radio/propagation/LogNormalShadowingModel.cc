@@ -35,6 +35,16 @@ void LogNormalShadowingModel::initializeFrom(cModule *radioModule)
 
 double LogNormalShadowingModel::calculateReceivedPower(double pSend, double carrierFrequency, double distance)
 {
+    if (pathLossCachePrecision > 0)
+    {
+        // the reference path loss at d0=1m extrapolated with pathLossAlpha is
+        // exactly the free space path loss, only the shadowing is random
+        double prec = pSend * getPathLoss(carrierFrequency, distance) * pow(10, -normal(0.0, sigma) / 10.0);
+        if (prec > pSend)
+            prec = pSend;
+        return prec;
+    }
+
     double waveLength = SPEED_OF_LIGHT / carrierFrequency;
     double d0 = 1.0;
 
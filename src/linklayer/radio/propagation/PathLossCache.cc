@@ -0,0 +1,82 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <math.h>
+
+#include "PathLossCache.h"
+#include "FreeSpaceModel.h"
+
+// path loss only depends on the model parameters, so the caches can safely
+// outlive a simulation run and be reused by the next one
+static std::map<std::string, PathLossCache> caches;
+
+PathLossCache::PathLossCache(int binsPerOctave) :
+    binsPerOctave(binsPerOctave), lastFrequency(-1), lastTable(NULL)
+{
+    if (binsPerOctave <= 0)
+        throw cRuntimeError("PathLossCache: invalid number of bins per octave: %d", binsPerOctave);
+}
+
+PathLossCache *PathLossCache::getCache(const std::string& key, int binsPerOctave)
+{
+    std::map<std::string, PathLossCache>::iterator it = caches.find(key);
+    if (it == caches.end())
+        it = caches.insert(std::make_pair(key, PathLossCache(binsPerOctave))).first;
+    return &it->second;
+}
+
+double PathLossCache::getDistance(int index) const
+{
+    // inverse of the index computation in getPathLoss()
+    int exponent = MIN_EXPONENT + index / binsPerOctave;
+    double mantissa = 0.5 + 0.5 * (index % binsPerOctave) / binsPerOctave;
+    return ldexp(mantissa, exponent);
+}
+
+PathLossCache::Table& PathLossCache::getTable(FreeSpaceModel *model, double carrierFrequency)
+{
+    if (carrierFrequency == lastFrequency)
+        return *lastTable;
+
+    Table& table = tables[carrierFrequency];
+    if (table.empty())
+    {
+        int size = (MAX_EXPONENT - MIN_EXPONENT + 1) * binsPerOctave + 1;
+        table.resize(size);
+        for (int i = 0; i < size; i++)
+            table[i] = model->calculatePathLoss(carrierFrequency, getDistance(i));
+    }
+    lastFrequency = carrierFrequency;
+    lastTable = &table;
+    return table;
+}
+
+double PathLossCache::getPathLoss(FreeSpaceModel *model, double carrierFrequency, double distance)
+{
+    if (!(distance > 0))
+        return model->calculatePathLoss(carrierFrequency, distance);
+
+    int exponent;
+    double mantissa = frexp(distance, &exponent);  // distance = mantissa * 2^exponent, mantissa in [0.5,1)
+    if (exponent < MIN_EXPONENT || exponent > MAX_EXPONENT)
+        return model->calculatePathLoss(carrierFrequency, distance);
+
+    Table& table = getTable(model, carrierFrequency);
+    double position = (mantissa - 0.5) * 2 * binsPerOctave;
+    int bin = (int)position;
+    double fraction = position - bin;
+    int index = (exponent - MIN_EXPONENT) * binsPerOctave + bin;
+    return table[index] + fraction * (table[index + 1] - table[index]);
+}
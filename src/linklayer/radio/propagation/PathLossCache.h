@@ -0,0 +1,75 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __PATH_LOSS_CACHE_H__
+#define __PATH_LOSS_CACHE_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "INETDefs.h"
+
+class FreeSpaceModel;
+
+/**
+ * Precomputed path loss (received/transmitted power ratio) of a deterministic
+ * propagation model over quantized distances, one table per carrier frequency.
+ *
+ * Distances are quantized logarithmically: every octave (power of two) is
+ * divided into binsPerOctave equal bins, and the path loss is linearly
+ * interpolated between the bin boundaries. The bin index is computed with
+ * frexp(), so a lookup needs no pow() or log10() calls. Distances outside
+ * the table range are computed exactly.
+ *
+ * Caches are shared by all propagation model instances (i.e. all radios)
+ * that have the same model parameters; use getCache() to obtain one.
+ */
+class INET_API PathLossCache
+{
+  protected:
+    typedef std::vector<double> Table;
+    typedef std::map<double, Table> FrequencyToTableMap;
+
+    int binsPerOctave;
+    FrequencyToTableMap tables;
+
+    // the table of the most recently used frequency
+    double lastFrequency;
+    Table *lastTable;
+
+    enum { MIN_EXPONENT = -9, MAX_EXPONENT = 24 };  // ~1mm .. ~16000km
+
+  protected:
+    Table& getTable(FreeSpaceModel *model, double carrierFrequency);
+    double getDistance(int index) const;
+
+  public:
+    PathLossCache(int binsPerOctave);
+
+    /**
+     * Returns the cache shared by the propagation models with the given
+     * parameters (see FreeSpaceModel::getPathLossCacheKey()).
+     */
+    static PathLossCache *getCache(const std::string& key, int binsPerOctave);
+
+    /**
+     * Returns the interpolated path loss at the given distance. Missing
+     * tables are filled using model->calculatePathLoss().
+     */
+    double getPathLoss(FreeSpaceModel *model, double carrierFrequency, double distance);
+};
+
+#endif
@@ -40,7 +40,8 @@ RayleighModel::~RayleighModel() {
 double RayleighModel::calculateReceivedPower(double pSend, double carrierFrequency, double distance)
 {
     double waveLength = SPEED_OF_LIGHT / carrierFrequency;
-    double avg_rx_power = freeSpace(Gt, Gr, L, pSend, waveLength, distance, pathLossAlpha);
+    double avg_rx_power = pathLossCachePrecision > 0 ? pSend * getPathLoss(carrierFrequency, distance) :
+            freeSpace(Gt, Gr, L, pSend, waveLength, distance, pathLossAlpha);
 
     double x = normal(0, 1);
     double y = normal(0, 1);
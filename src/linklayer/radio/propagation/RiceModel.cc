@@ -41,7 +41,9 @@ double RiceModel::calculateReceivedPower(double pSend, double carrierFrequency,
     double x = normal(0, 1);
     double y = normal(0, 1);
     double rr = c*( (x + sqrt(2*K))*(x + sqrt(2*K)) + y*y);
-    double prec = freeSpace(Gt, Gr, L, pSend, waveLength, distance, pathLossAlpha) * rr;
+    double avg_power = pathLossCachePrecision > 0 ? pSend * getPathLoss(carrierFrequency, distance) :
+            freeSpace(Gt, Gr, L, pSend, waveLength, distance, pathLossAlpha);
+    double prec = avg_power * rr;
     if (prec > pSend)
         prec = pSend;
     return prec;
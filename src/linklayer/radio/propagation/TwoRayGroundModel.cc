@@ -23,6 +23,8 @@
  */
 #include "TwoRayGroundModel.h"
 
+#include <sstream>
+
 Register_Class(TwoRayGroundModel);
 
 void TwoRayGroundModel::initializeFrom(cModule *radioModule)
@@ -39,8 +41,31 @@ TwoRayGroundModel::~TwoRayGroundModel()
 
 double TwoRayGroundModel::calculateReceivedPower(double pSend, double carrierFrequency, double distance)
 {
-    double waveLength = SPEED_OF_LIGHT / carrierFrequency;
+    if (pathLossCachePrecision > 0)
+    {
+        double prec = pSend * getPathLoss(carrierFrequency, distance);
+        if (prec > pSend)
+            prec = pSend;
+        return prec;
+    }
+    return twoRayGround(pSend, SPEED_OF_LIGHT / carrierFrequency, distance);
+}
+
+double TwoRayGroundModel::calculatePathLoss(double carrierFrequency, double distance)
+{
+    return twoRayGround(1.0, SPEED_OF_LIGHT / carrierFrequency, distance);
+}
 
+std::string TwoRayGroundModel::getPathLossCacheKey()
+{
+    std::ostringstream os;
+    os.precision(17);
+    os << FreeSpaceModel::getPathLossCacheKey() << " ht=" << ht << " hr=" << hr;
+    return os.str();
+}
+
+double TwoRayGroundModel::twoRayGround(double pSend, double waveLength, double distance)
+{
     if (distance == 0)
         return pSend;
 
@@ -34,6 +34,11 @@ class INET_API TwoRayGroundModel : public FreeSpaceModel {
      * To be redefined to calculate the received power of a transmission.
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance);
+    virtual double calculatePathLoss(double carrierFrequency, double distance);
+
+    protected:
+    virtual std::string getPathLossCacheKey();
+    virtual double twoRayGround(double pSend, double waveLength, double distance);
 
     private:
     double ht, hr;
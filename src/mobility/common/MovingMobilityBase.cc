@@ -28,6 +28,7 @@ MovingMobilityBase::MovingMobilityBase()
 {
     moveTimer = NULL;
     updateInterval = 0;
+    maxUpdateDistance = 0;
     stationary = false;
     lastSpeed = Coord::ZERO;
     lastUpdate = 0;
@@ -47,12 +48,18 @@ void MovingMobilityBase::initialize(int stage)
     if (stage == 0) {
         moveTimer = new cMessage("move");
         updateInterval = par("updateInterval");
+        maxUpdateDistance = par("maxUpdateDistance");
+        if (maxUpdateDistance < 0)
+            throw cRuntimeError("Invalid maxUpdateDistance: %g", maxUpdateDistance);
     }
 }
 
 void MovingMobilityBase::initializePosition() {
     MobilityBase::initializePosition();
     lastUpdate = simTime();
+    // the distance based update interval needs the initial speed
+    if (maxUpdateDistance > 0 && !stationary)
+        move();
     scheduleUpdate();
 }
 
@@ -76,9 +83,10 @@ void MovingMobilityBase::handleSelfMessage(cMessage *message)
 void MovingMobilityBase::scheduleUpdate()
 {
     cancelEvent(moveTimer);
-    if (!stationary && updateInterval != 0) {
+    simtime_t interval = stationary ? SIMTIME_ZERO : getUpdateInterval();
+    if (interval != 0) {
         // periodic update is needed
-        simtime_t nextUpdate = simTime() + updateInterval;
+        simtime_t nextUpdate = simTime() + interval;
         if (nextChange != -1 && nextChange < nextUpdate)
             // next change happens earlier than next update
             scheduleAt(nextChange, moveTimer);
@@ -91,6 +99,23 @@ void MovingMobilityBase::scheduleUpdate()
         scheduleAt(nextChange, moveTimer);
 }
 
+simtime_t MovingMobilityBase::getUpdateInterval()
+{
+    if (maxUpdateDistance == 0)
+        return updateInterval;
+
+    // the position between two updates is computed analytically on demand,
+    // so an update is only needed when the node could have moved maxUpdateDistance
+    double speed = lastSpeed.length();
+    if (speed == 0)
+        // standing still until nextChange, or the speed is not known: fall back to periodic updates
+        return nextChange != -1 ? SIMTIME_ZERO : updateInterval;
+    double interval = maxUpdateDistance / speed;
+    if (interval >= (MAXTIME - simTime()).dbl())
+        return SIMTIME_ZERO;
+    return interval;
+}
+
 Coord MovingMobilityBase::getCurrentPosition()
 {
     moveAndUpdate();
@@ -45,6 +45,14 @@ class INET_API MovingMobilityBase : public MobilityBase
      * The 0 value turns off the signal. */
     simtime_t updateInterval;
 
+    /** @brief The distance the node may travel between two mobility state change signals.
+     *
+     * If positive, it replaces updateInterval: the next update is scheduled when the node
+     * is expected to have moved this far, and no periodic update is done while it stands
+     * still until a known change; with zero or unknown speed updateInterval is used.
+     * The 0 value turns off distance based updates. */
+    double maxUpdateDistance;
+
     /** @brief A mobility model may decide to become stationary at any time.
      *
      * The true value disables sending self messages. */
@@ -75,6 +83,9 @@ class INET_API MovingMobilityBase : public MobilityBase
     /** @brief Schedules the move timer that will update the mobility state. */
     void scheduleUpdate();
 
+    /** @brief Returns the interval of the periodic mobility state change signals, 0 means no periodic signal. */
+    simtime_t getUpdateInterval();
+
     /** @brief Moves and notifies listeners. */
     void moveAndUpdate();
 
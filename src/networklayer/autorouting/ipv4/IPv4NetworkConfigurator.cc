@@ -18,7 +18,11 @@
 // Authors: Levente Meszaros (primary author), Andras Varga, Tamas Borbely
 //
 
+#include <string.h>
+#include <iterator>
+#include <map>
 #include <set>
+#include <sstream>
 #include "stlutils.h"
 #include "IRoutingTable.h"
 #include "IInterfaceTable.h"
@@ -87,6 +91,9 @@ void IPv4NetworkConfigurator::initialize(int stage)
         addSubnetRoutesParameter = par("addSubnetRoutes");
         addDefaultRoutesParameter = par("addDefaultRoutes");
         optimizeRoutesParameter = par("optimizeRoutes");
+        optimizeRoutesAlgorithmParameter = par("optimizeRoutesAlgorithm").stdstringValue();
+        if (optimizeRoutesAlgorithmParameter != "merge" && optimizeRoutesAlgorithmParameter != "ortc")
+            throw cRuntimeError("Unknown optimizeRoutesAlgorithm '%s', must be 'merge' or 'ortc'", optimizeRoutesAlgorithmParameter.c_str());
         configuration = par("config");
     }
     else if (stage == 2)
@@ -101,20 +108,36 @@ void IPv4NetworkConfigurator::computeConfiguration()
     topology.clear();
     // extract topology into the IPv4Topology object, then fill in a LinkInfo[] vector
     T(extractTopology(topology));
-    // read the configuration from XML; it will serve as input for address assignment
-    T(readInterfaceConfiguration(topology));
-    // assign addresses to IPv4 nodes
-    if (assignAddressesParameter)
-        T(assignAddresses(topology));
-    // read and configure multicast groups from the XML configuration
-    T(readMulticastGroupConfiguration(topology));
-    // read and configure manual routes from the XML configuration
-    readManualRouteConfiguration(topology);
+    // try to reuse the addresses and routes computed by a previous run for the same network and configuration
+    const char *cacheFileName = par("configurationCache").stringValue();
+    uint64 fingerprint = 0;
+    if (!isEmpty(cacheFileName))
+        T(fingerprint = computeFingerprint(topology));
+    bool cached = false;
+    if (!isEmpty(cacheFileName))
+        T(cached = loadConfigurationCache(topology, cacheFileName, fingerprint));
+    if (!cached)
+    {
+        // read the configuration from XML; it will serve as input for address assignment
+        T(readInterfaceConfiguration(topology));
+        // assign addresses to IPv4 nodes
+        if (assignAddressesParameter)
+            T(assignAddresses(topology));
+        // read and configure multicast groups from the XML configuration
+        T(readMulticastGroupConfiguration(topology));
+        // read and configure manual routes from the XML configuration
+        readManualRouteConfiguration(topology);
+    }
     // read and configure manual multicast routes from the XML configuration
     readManualMulticastRouteConfiguration(topology);
-    // calculate shortest paths, and add corresponding static routes
-    if (addStaticRoutesParameter)
-        T(addStaticRoutes(topology));
+    if (!cached)
+    {
+        // calculate shortest paths, and add corresponding static routes
+        if (addStaticRoutesParameter)
+            T(addStaticRoutes(topology));
+        if (!isEmpty(cacheFileName))
+            T(saveConfigurationCache(topology, cacheFileName, fingerprint));
+    }
     printElapsedTime("initialize", initializeStartTime);
 }
 
@@ -124,6 +147,250 @@ void IPv4NetworkConfigurator::ensureConfigurationComputed(IPv4Topology& topology
         computeConfiguration();
 }
 
+static void printXMLElement(std::ostream& stream, cXMLElement *element)
+{
+    stream << "<" << element->getTagName();
+    const cXMLAttributeMap& attributes = element->getAttributes();
+    for (cXMLAttributeMap::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
+        stream << " " << it->first << "=\"" << it->second << "\"";
+    stream << ">";
+    if (element->getNodeValue())
+        stream << element->getNodeValue();
+    for (cXMLElement *child = element->getFirstChild(); child; child = child->getNextSibling())
+        printXMLElement(stream, child);
+    stream << "</" << element->getTagName() << ">";
+}
+
+uint64 IPv4NetworkConfigurator::computeFingerprint(IPv4Topology& topology)
+{
+    // everything the computed configuration depends on: the parameters, the XML
+    // configuration, and the extracted nodes, interfaces, links and connections
+    std::ostringstream stream;
+    stream << assignAddressesParameter << assignDisjunctSubnetAddressesParameter << addStaticRoutesParameter
+           << addSubnetRoutesParameter << addDefaultRoutesParameter << optimizeRoutesParameter << optimizeRoutesAlgorithmParameter << "\n";
+    printXMLElement(stream, configuration);
+    stream << "\n";
+    for (int i = 0; i < topology.getNumNodes(); i++)
+    {
+        Node *node = (Node *)topology.getNode(i);
+        stream << "node " << node->module->getFullPath() << " " << node->getWeight() << " " << (node->routingTable != NULL) << "\n";
+        for (int j = 0; j < node->getNumOutLinks(); j++)
+        {
+            Topology::LinkOut *linkOut = node->getLinkOut(j);
+            stream << " out " << linkOut->getLocalGateId() << " " << linkOut->getRemoteNode()->getModuleId() << " " << linkOut->getRemoteGateId() << "\n";
+        }
+        if (node->interfaceTable)
+        {
+            for (int j = 0; j < node->interfaceTable->getNumInterfaces(); j++)
+            {
+                InterfaceEntry *interfaceEntry = node->interfaceTable->getInterface(j);
+                IPv4InterfaceData *interfaceData = interfaceEntry->ipv4Data();
+                stream << " interface " << interfaceEntry->getFullName() << " " << interfaceEntry->getInterfaceId() << " " << interfaceEntry->getMtu();
+                if (interfaceData)
+                    stream << " " << interfaceData->getIPAddress() << "/" << interfaceData->getNetmask() << " " << interfaceData->getMetric();
+                stream << "\n";
+            }
+        }
+    }
+    for (int i = 0; i < (int)topology.linkInfos.size(); i++)
+    {
+        LinkInfo *linkInfo = topology.linkInfos[i];
+        stream << "link";
+        for (int j = 0; j < (int)linkInfo->interfaceInfos.size(); j++)
+            stream << " " << linkInfo->interfaceInfos[j]->getFullPath();
+        stream << "\n";
+    }
+
+    // 64-bit FNV-1a hash
+    std::string text = stream.str();
+    uint64 hash = 14695981039346656037ULL;
+    for (int i = 0; i < (int)text.size(); i++)
+    {
+        hash ^= (unsigned char)text[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// the cache file is a private binary format of this module: the fields are stored in native byte order
+static const char configurationCacheMagic[8] = {'I', 'P', 'v', '4', 'C', 'F', 'G', '1'};
+
+struct CachedInterface
+{
+    int32 mtu;
+    double metric;
+    uint8 flags;
+    uint32 address, addressSpecifiedBits, netmask, netmaskSpecifiedBits;
+    std::vector<uint32> multicastGroups;
+};
+
+struct CachedRoute
+{
+    uint32 destination, netmask, gateway;
+    int32 interfaceId, sourceType, metric;
+};
+
+template<typename V>
+static void writeValue(FILE *f, const V& value)
+{
+    fwrite(&value, sizeof(value), 1, f);
+}
+
+template<typename V>
+static bool readValue(FILE *f, V& value)
+{
+    return fread(&value, sizeof(value), 1, f) == 1;
+}
+
+void IPv4NetworkConfigurator::saveConfigurationCache(IPv4Topology& topology, const char *fileName, uint64 fingerprint)
+{
+    FILE *f = fopen(fileName, "wb");
+    if (!f)
+        throw cRuntimeError("Cannot write configuration cache file '%s'", fileName);
+    fwrite(configurationCacheMagic, sizeof(configurationCacheMagic), 1, f);
+    writeValue(f, fingerprint);
+
+    // interfaces, in the order of links
+    writeValue(f, (uint32)topology.interfaceInfos.size());
+    for (int i = 0; i < (int)topology.linkInfos.size(); i++)
+    {
+        LinkInfo *linkInfo = topology.linkInfos[i];
+        for (int j = 0; j < (int)linkInfo->interfaceInfos.size(); j++)
+        {
+            InterfaceInfo *interfaceInfo = linkInfo->interfaceInfos[j];
+            writeValue(f, (int32)interfaceInfo->mtu);
+            writeValue(f, interfaceInfo->metric);
+            writeValue(f, (uint8)(interfaceInfo->configure | interfaceInfo->addStaticRoute << 1 | interfaceInfo->addDefaultRoute << 2 | interfaceInfo->addSubnetRoute << 3));
+            writeValue(f, interfaceInfo->address);
+            writeValue(f, interfaceInfo->addressSpecifiedBits);
+            writeValue(f, interfaceInfo->netmask);
+            writeValue(f, interfaceInfo->netmaskSpecifiedBits);
+            writeValue(f, (uint32)interfaceInfo->multicastGroups.size());
+            for (int k = 0; k < (int)interfaceInfo->multicastGroups.size(); k++)
+                writeValue(f, interfaceInfo->multicastGroups[k].getInt());
+        }
+    }
+
+    // unicast routes, in the order of nodes
+    writeValue(f, (uint32)topology.getNumNodes());
+    for (int i = 0; i < topology.getNumNodes(); i++)
+    {
+        Node *node = (Node *)topology.getNode(i);
+        writeValue(f, (uint32)node->staticRoutes.size());
+        for (int j = 0; j < (int)node->staticRoutes.size(); j++)
+        {
+            IPv4Route *route = node->staticRoutes[j];
+            writeValue(f, route->getDestination().getInt());
+            writeValue(f, route->getNetmask().getInt());
+            writeValue(f, route->getGateway().getInt());
+            writeValue(f, (int32)(route->getInterface() ? route->getInterface()->getInterfaceId() : -1));
+            writeValue(f, (int32)route->getSourceType());
+            writeValue(f, (int32)route->getMetric());
+        }
+    }
+
+    bool failed = ferror(f) != 0;
+    if (fclose(f) != 0 || failed)
+        throw cRuntimeError("Cannot write configuration cache file '%s'", fileName);
+    EV_INFO << "Configuration saved to cache file " << fileName << endl;
+}
+
+bool IPv4NetworkConfigurator::loadConfigurationCache(IPv4Topology& topology, const char *fileName, uint64 fingerprint)
+{
+    FILE *f = fopen(fileName, "rb");
+    if (!f)
+        return false;
+
+    // read everything before modifying the topology, so that an outdated or corrupt file has no effect
+    std::vector<CachedInterface> interfaces;
+    std::vector<std::vector<CachedRoute> > routes;
+
+    char magic[sizeof(configurationCacheMagic)];
+    uint64 cachedFingerprint;
+    uint32 count;
+    bool ok = fread(magic, sizeof(magic), 1, f) == 1 && !memcmp(magic, configurationCacheMagic, sizeof(magic)) &&
+              readValue(f, cachedFingerprint) && cachedFingerprint == fingerprint &&
+              readValue(f, count) && count == topology.interfaceInfos.size();
+    for (uint32 i = 0; ok && i < count; i++)
+    {
+        CachedInterface cachedInterface;
+        uint32 numGroups;
+        ok = readValue(f, cachedInterface.mtu) && readValue(f, cachedInterface.metric) && readValue(f, cachedInterface.flags) &&
+             readValue(f, cachedInterface.address) && readValue(f, cachedInterface.addressSpecifiedBits) &&
+             readValue(f, cachedInterface.netmask) && readValue(f, cachedInterface.netmaskSpecifiedBits) && readValue(f, numGroups);
+        for (uint32 j = 0; ok && j < numGroups; j++)
+        {
+            uint32 group;
+            ok = readValue(f, group);
+            cachedInterface.multicastGroups.push_back(group);
+        }
+        interfaces.push_back(cachedInterface);
+    }
+    ok = ok && readValue(f, count) && count == (uint32)topology.getNumNodes();
+    for (uint32 i = 0; ok && i < count; i++)
+    {
+        uint32 numRoutes;
+        ok = readValue(f, numRoutes);
+        routes.push_back(std::vector<CachedRoute>());
+        for (uint32 j = 0; ok && j < numRoutes; j++)
+        {
+            CachedRoute cachedRoute;
+            ok = readValue(f, cachedRoute.destination) && readValue(f, cachedRoute.netmask) && readValue(f, cachedRoute.gateway) &&
+                 readValue(f, cachedRoute.interfaceId) && readValue(f, cachedRoute.sourceType) && readValue(f, cachedRoute.metric);
+            Node *node = (Node *)topology.getNode(i);
+            ok = ok && (cachedRoute.interfaceId == -1 || (node->interfaceTable && node->interfaceTable->getInterfaceById(cachedRoute.interfaceId)));
+            routes.back().push_back(cachedRoute);
+        }
+    }
+    fclose(f);
+    if (!ok)
+    {
+        EV_INFO << "Configuration cache file " << fileName << " is outdated, recomputing configuration" << endl;
+        return false;
+    }
+
+    int index = 0;
+    for (int i = 0; i < (int)topology.linkInfos.size(); i++)
+    {
+        LinkInfo *linkInfo = topology.linkInfos[i];
+        for (int j = 0; j < (int)linkInfo->interfaceInfos.size(); j++, index++)
+        {
+            InterfaceInfo *interfaceInfo = linkInfo->interfaceInfos[j];
+            const CachedInterface& cachedInterface = interfaces[index];
+            interfaceInfo->mtu = cachedInterface.mtu;
+            interfaceInfo->metric = cachedInterface.metric;
+            interfaceInfo->configure = (cachedInterface.flags & 1) != 0;
+            interfaceInfo->addStaticRoute = (cachedInterface.flags & 2) != 0;
+            interfaceInfo->addDefaultRoute = (cachedInterface.flags & 4) != 0;
+            interfaceInfo->addSubnetRoute = (cachedInterface.flags & 8) != 0;
+            interfaceInfo->address = cachedInterface.address;
+            interfaceInfo->addressSpecifiedBits = cachedInterface.addressSpecifiedBits;
+            interfaceInfo->netmask = cachedInterface.netmask;
+            interfaceInfo->netmaskSpecifiedBits = cachedInterface.netmaskSpecifiedBits;
+            for (int k = 0; k < (int)cachedInterface.multicastGroups.size(); k++)
+                interfaceInfo->multicastGroups.push_back(IPv4Address(cachedInterface.multicastGroups[k]));
+        }
+    }
+    for (int i = 0; i < topology.getNumNodes(); i++)
+    {
+        Node *node = (Node *)topology.getNode(i);
+        for (int j = 0; j < (int)routes[i].size(); j++)
+        {
+            const CachedRoute& cachedRoute = routes[i][j];
+            IPv4Route *route = new IPv4Route();
+            route->setDestination(IPv4Address(cachedRoute.destination));
+            route->setNetmask(IPv4Address(cachedRoute.netmask));
+            route->setGateway(IPv4Address(cachedRoute.gateway));
+            route->setInterface(cachedRoute.interfaceId == -1 ? NULL : node->interfaceTable->getInterfaceById(cachedRoute.interfaceId));
+            route->setSourceType((IPv4Route::SourceType)cachedRoute.sourceType);
+            route->setMetric(cachedRoute.metric);
+            node->staticRoutes.push_back(route);
+        }
+    }
+    EV_INFO << "Configuration loaded from cache file " << fileName << endl;
+    return true;
+}
+
 void IPv4NetworkConfigurator::dumpConfiguration()
 {
     // print topology to module output
@@ -1727,27 +1994,53 @@ IPv4NetworkConfigurator::LinkInfo *IPv4NetworkConfigurator::findLinkOfInterface(
     return NULL;
 }
 
-bool IPv4NetworkConfigurator::containsRoute(const std::vector<IPv4Route *>& routes, IPv4Route *route)
+bool IPv4NetworkConfigurator::RouteLess::operator()(const IPv4Route *a, const IPv4Route *b) const
 {
-    for (int i = 0; i < (int)routes.size(); i++)
-        if (*routes.at(i) == *route)
-            return true;
-    return false;
+    // the fields compared by IPv4Route::equals()
+    if (a->getDestination() != b->getDestination())
+        return a->getDestination() < b->getDestination();
+    if (a->getNetmask() != b->getNetmask())
+        return a->getNetmask() < b->getNetmask();
+    if (a->getGateway() != b->getGateway())
+        return a->getGateway() < b->getGateway();
+    if (a->getInterface() != b->getInterface())
+        return a->getInterface() < b->getInterface();
+    if (a->getSourceType() != b->getSourceType())
+        return a->getSourceType() < b->getSourceType();
+    if (a->getMetric() != b->getMetric())
+        return a->getMetric() < b->getMetric();
+    return a->getRoutingTable() < b->getRoutingTable();
+}
+
+bool IPv4NetworkConfigurator::lessByDistanceToTarget(Topology::Node *a, Topology::Node *b)
+{
+    return a->getDistanceToTarget() < b->getDistanceToTarget();
 }
 
 void IPv4NetworkConfigurator::addStaticRoutes(IPv4Topology& topology)
 {
+    // per destination node (by index): the last link and the last IP interface
+    // (not in the source node) on the path from the destination to the source
+    int numNodes = topology.getNumNodes();
+    std::map<Topology::Node *, int> nodeIndices;
+    for (int i = 0; i < numNodes; i++)
+        nodeIndices[topology.getNode(i)] = i;
+    std::vector<Link *> lastLinks(numNodes);
+    std::vector<InterfaceInfo *> nextHopInterfaceInfos(numNodes);
+    std::vector<Topology::Node *> nodesByDistance;
+
+    // route optimization report
+    long numOriginalRoutes = 0;
+    long numOptimizedRoutes = 0;
+    long optimizeTime = 0;
+
     // TODO: it should be configurable (via xml?) which nodes need static routes filled in automatically
     // add static routes for all routing tables
-    for (int i = 0; i < topology.getNumNodes(); i++) {
+    for (int i = 0; i < numNodes; i++) {
         Node *sourceNode = (Node *)topology.getNode(i);
         if (!sourceNode->interfaceTable)
             continue;
 
-        // calculate shortest paths from everywhere to sourceNode
-        // we are going to use the paths in reverse direction (assuming all links are bidirectional)
-        topology.calculateUnweightedSingleShortestPathsTo(sourceNode);
-
         // check if adding the default routes would be ok (this is an optimization)
         if (addDefaultRoutesParameter && sourceNode->interfaceInfos.size() == 1 && sourceNode->interfaceInfos[0]->linkInfo->gatewayInterfaceInfo)
         {
@@ -1782,8 +2075,43 @@ void IPv4NetworkConfigurator::addStaticRoutes(IPv4Topology& topology)
         }
         else
         {
+            // calculate shortest paths from everywhere to sourceNode
+            // we are going to use the paths in reverse direction (assuming all links are bidirectional)
+            topology.calculateUnweightedSingleShortestPathsTo(sourceNode);
+
+            // determine the last link and the next hop interface (the last IP interface on the path that
+            // is not in the source node) for all nodes; visiting the nodes in the order of their distance,
+            // they can be taken from the next node on the path instead of walking the whole path
+            nodesByDistance.clear();
+            for (int j = 0; j < numNodes; j++)
+                if (topology.getNode(j)->getNumPaths() != 0)
+                    nodesByDistance.push_back(topology.getNode(j));
+            std::stable_sort(nodesByDistance.begin(), nodesByDistance.end(), lessByDistanceToTarget);
+            for (int j = 0; j < (int)nodesByDistance.size(); j++)
+            {
+                Node *node = (Node *)nodesByDistance[j];
+                Link *link = (Link *)node->getPath(0);
+                Node *nextNode = (Node *)link->getRemoteNode();
+                InterfaceInfo *interfaceInfo = node->interfaceTable && link->sourceInterfaceInfo ? link->sourceInterfaceInfo : NULL;
+                int k = nodeIndices[node];
+                if (nextNode == sourceNode)
+                {
+                    lastLinks[k] = link;
+                    nextHopInterfaceInfos[k] = interfaceInfo;
+                }
+                else
+                {
+                    int nextIndex = nodeIndices[nextNode];
+                    lastLinks[k] = lastLinks[nextIndex];
+                    nextHopInterfaceInfos[k] = nextHopInterfaceInfos[nextIndex] ? nextHopInterfaceInfos[nextIndex] : interfaceInfo;
+                }
+            }
+
+            // routes already added, for filtering duplicates
+            std::set<IPv4Route *, RouteLess> sourceRoutes(sourceNode->staticRoutes.begin(), sourceNode->staticRoutes.end());
+
             // add a route to all destinations in the network
-            for (int j = 0; j < topology.getNumNodes(); j++)
+            for (int j = 0; j < numNodes; j++)
             {
                 // extract destination
                 Node *destinationNode = (Node *)topology.getNode(j);
@@ -1795,17 +2123,8 @@ void IPv4NetworkConfigurator::addStaticRoutes(IPv4Topology& topology)
                     continue;
 
                 // determine next hop interface
-                // find next hop interface (the last IP interface on the path that is not in the source node)
-                Node *node = destinationNode;
-                Link *link = NULL;
-                InterfaceInfo *nextHopInterfaceInfo = NULL;
-                while (node != sourceNode)
-                {
-                    link = (Link *)node->getPath(0);
-                    if (node->interfaceTable && node != sourceNode && link->sourceInterfaceInfo)
-                        nextHopInterfaceInfo = link->sourceInterfaceInfo;
-                    node = (Node *)node->getPath(0)->getRemoteNode();
-                }
+                Link *link = lastLinks[j];
+                InterfaceInfo *nextHopInterfaceInfo = nextHopInterfaceInfos[j];
 
                 // determine source interface
                 if (link->destinationInterfaceInfo && link->destinationInterfaceInfo->addStaticRoute)
@@ -1838,7 +2157,7 @@ void IPv4NetworkConfigurator::addStaticRoutes(IPv4Topology& topology)
                             if (gatewayAddress != destinationAddress)
                                 route->setGateway(gatewayAddress);
                             route->setSourceType(IPv4Route::MANUAL);
-                            if (containsRoute(sourceNode->staticRoutes, route))
+                            if (!sourceRoutes.insert(route).second)
                                 delete route;
                             else {
                                 sourceNode->staticRoutes.push_back(route);
@@ -1851,9 +2170,19 @@ void IPv4NetworkConfigurator::addStaticRoutes(IPv4Topology& topology)
 
             // optimize routing table to save memory and increase lookup performance
             if (optimizeRoutesParameter)
+            {
+                long startTime = clock();
+                numOriginalRoutes += sourceNode->staticRoutes.size();
                 optimizeRoutes(sourceNode->staticRoutes);
+                numOptimizedRoutes += sourceNode->staticRoutes.size();
+                optimizeTime += clock() - startTime;
+            }
         }
     }
+
+    if (optimizeRoutesParameter)
+        EV_INFO << "Route optimization (" << optimizeRoutesAlgorithmParameter << ") reduced " << numOriginalRoutes << " routes to "
+                << numOptimizedRoutes << " in " << ((double)optimizeTime / CLOCKS_PER_SEC) << "s" << endl;
 }
 
 /**
@@ -2102,7 +2431,15 @@ bool IPv4NetworkConfigurator::tryToMergeAnyTwoRoutes(RoutingTableInfo& routingTa
     return false;
 }
 
-void IPv4NetworkConfigurator::optimizeRoutes(std::vector<IPv4Route *>& originalRoutes)
+void IPv4NetworkConfigurator::optimizeRoutes(std::vector<IPv4Route *>& routes)
+{
+    if (optimizeRoutesAlgorithmParameter == "ortc")
+        optimizeRoutesWithOrtc(routes);
+    else
+        optimizeRoutesByMerging(routes);
+}
+
+void IPv4NetworkConfigurator::optimizeRoutesByMerging(std::vector<IPv4Route *>& originalRoutes)
 {
     // The basic idea: if two routes "do the same" (same output interface, gateway, etc) and
     // match "similar" addresses, one can try to move them to be neighbors in the table and
@@ -2180,6 +2517,141 @@ void IPv4NetworkConfigurator::optimizeRoutes(std::vector<IPv4Route *>& originalR
     originalRoutes = optimizedRoutes;
 }
 
+// ORTC pass 1 and 2: complete the trie so that every node has zero or two children, pushing the
+// inherited color down to the leaves, and compute the optimal color sets bottom-up
+void IPv4NetworkConfigurator::computeOrtcColors(OrtcNode *node, int inheritedColor, std::vector<OrtcNode *>& nodes)
+{
+    if (node->color != -1)
+        inheritedColor = node->color;
+    if (!node->children[0] && !node->children[1])
+    {
+        if (inheritedColor == -1)
+            node->dontCare = true;
+        else
+            node->colors.push_back(inheritedColor);
+        return;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if (!node->children[i])
+        {
+            node->children[i] = new OrtcNode();
+            nodes.push_back(node->children[i]);
+        }
+        computeOrtcColors(node->children[i], inheritedColor, nodes);
+    }
+    OrtcNode *left = node->children[0];
+    OrtcNode *right = node->children[1];
+    if (left->dontCare && right->dontCare)
+        node->dontCare = true;
+    else if (left->dontCare)
+        node->colors = right->colors;
+    else if (right->dontCare)
+        node->colors = left->colors;
+    else
+    {
+        std::set_intersection(left->colors.begin(), left->colors.end(), right->colors.begin(), right->colors.end(), std::back_inserter(node->colors));
+        if (node->colors.empty())
+            std::set_union(left->colors.begin(), left->colors.end(), right->colors.begin(), right->colors.end(), std::back_inserter(node->colors));
+    }
+}
+
+// ORTC pass 3: select the colors top-down, adding a route only where the inherited color is not optimal
+void IPv4NetworkConfigurator::selectOrtcRoutes(OrtcNode *node, uint32 prefix, int length, int inheritedColor, std::vector<RouteInfo *>& routeInfos)
+{
+    if (node->dontCare)
+        return;
+    if (!std::binary_search(node->colors.begin(), node->colors.end(), inheritedColor))
+    {
+        inheritedColor = node->colors[0];
+        uint32 netmask = length == 0 ? 0 : 0xFFFFFFFFu << (32 - length);
+        routeInfos.push_back(new RouteInfo(inheritedColor, prefix, netmask));
+    }
+    for (int i = 0; i < 2; i++)
+        if (node->children[i])
+            selectOrtcRoutes(node->children[i], prefix | (uint32)i << (31 - length), length + 1, inheritedColor, routeInfos);
+}
+
+void IPv4NetworkConfigurator::optimizeRoutesWithOrtc(std::vector<IPv4Route *>& originalRoutes)
+{
+    // Optimal Routing Table Constructor (R. Draves, C. King, S. Venkatachary, B. Zill: Constructing
+    // optimal IP routing tables, INFOCOM 1999). Routes are colored as in optimizeRoutesByMerging().
+    // The original routes are put into a binary trie, then the sets of colors that lead to the least
+    // number of routes are computed bottom-up for every node, and finally the colors are selected
+    // top-down. As in optimizeRoutesByMerging(), addresses not covered by any original route may be
+    // routed arbitrarily; all other addresses are routed the same way as by the original routes.
+    std::vector<IPv4Route *> colorToRoute;
+    std::vector<RouteInfo *> originalRouteInfos;
+    std::vector<OrtcNode *> nodes;  // for deleting them
+    OrtcNode *root = new OrtcNode();
+    nodes.push_back(root);
+    for (int i = 0; i < (int)originalRoutes.size(); i++)
+    {
+        IPv4Route *originalRoute = originalRoutes.at(i);
+        int color = findRouteIndexWithSameColor(colorToRoute, originalRoute);
+        if (color == -1)
+        {
+            color = colorToRoute.size();
+            colorToRoute.push_back(originalRoute);
+        }
+        uint32 destination = originalRoute->getDestination().getInt();
+        int length = originalRoute->getNetmask().getNetmaskLength();
+        originalRouteInfos.push_back(new RouteInfo(color, destination, originalRoute->getNetmask().getInt()));
+
+        OrtcNode *node = root;
+        for (int bitIndex = 0; bitIndex < length; bitIndex++)
+        {
+            int bit = (destination >> (31 - bitIndex)) & 1;
+            if (!node->children[bit])
+            {
+                node->children[bit] = new OrtcNode();
+                nodes.push_back(node->children[bit]);
+            }
+            node = node->children[bit];
+        }
+        // among routes with the same prefix, the routing table uses the one with the smallest metric (the first one if equal)
+        if (node->color == -1 || colorToRoute[color]->getMetric() < colorToRoute[node->color]->getMetric())
+            node->color = color;
+    }
+
+    computeOrtcColors(root, -1, nodes);
+    RoutingTableInfo routingTableInfo;
+    selectOrtcRoutes(root, 0, 0, -1, routingTableInfo.routeInfos);
+    std::stable_sort(routingTableInfo.routeInfos.begin(), routingTableInfo.routeInfos.end(), RoutingTableInfo::routeInfoLessThan);
+    for (int i = 0; i < (int)nodes.size(); i++)
+        delete nodes[i];
+
+#ifndef NDEBUG
+    checkOriginalRoutes(routingTableInfo, originalRouteInfos);
+#endif
+
+    // convert the optimized routes to new optimized IPv4 routes based on the saved colors
+    std::vector<IPv4Route *> optimizedRoutes;
+    for (int i = 0; i < (int)routingTableInfo.routeInfos.size(); i++)
+    {
+        RouteInfo *routeInfo = routingTableInfo.routeInfos.at(i);
+        IPv4Route *routeColor = colorToRoute[routeInfo->color];
+        IPv4Route *optimizedRoute = new IPv4Route();
+        optimizedRoute->setDestination(IPv4Address(routeInfo->destination));
+        optimizedRoute->setNetmask(IPv4Address(routeInfo->netmask));
+        optimizedRoute->setInterface(routeColor->getInterface());
+        optimizedRoute->setGateway(routeColor->getGateway());
+        optimizedRoute->setSourceType(routeColor->getSourceType());
+        optimizedRoute->setMetric(routeColor->getMetric());
+        optimizedRoutes.push_back(optimizedRoute);
+        delete routeInfo;
+    }
+    for (int i = 0; i < (int)originalRouteInfos.size(); i++)
+        delete originalRouteInfos[i];
+
+    // delete original routes, we destructively modify them
+    for (int i = 0; i < (int)originalRoutes.size(); i++)
+        delete originalRoutes.at(i);
+
+    // copy optimized routes to original routes and return
+    originalRoutes = optimizedRoutes;
+}
+
 bool IPv4NetworkConfigurator::getInterfaceIPv4Address(IPvXAddress &ret, InterfaceEntry * interfaceEntry, bool netmask)
 {
     std::map<InterfaceEntry *, InterfaceInfo *>::iterator it = topology.interfaceInfos.find(interfaceEntry);
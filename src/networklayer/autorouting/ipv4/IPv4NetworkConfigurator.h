@@ -163,6 +163,20 @@ class INET_API IPv4NetworkConfigurator : public cSimpleModule, public IPvXAddres
                 static bool routeInfoLessThan(const RouteInfo *a, const RouteInfo *b) { return a->netmask != b->netmask ? a->netmask > b->netmask : a->destination < b->destination; }
         };
 
+        /**
+         * Node of the binary prefix trie used by the ORTC route optimizer.
+         */
+        class OrtcNode {
+            public:
+                OrtcNode *children[2];
+                int color;                // color of the original route with exactly this prefix, or -1
+                bool dontCare;            // no original route covers the addresses of this node, any color will do
+                std::vector<int> colors;  // the colors that are optimal for this node (sorted), unless dontCare
+
+            public:
+                OrtcNode() { children[0] = children[1] = NULL; color = -1; dontCare = false; }
+        };
+
         class Matcher
         {
             protected:
@@ -200,6 +214,7 @@ class INET_API IPv4NetworkConfigurator : public cSimpleModule, public IPvXAddres
         bool addSubnetRoutesParameter;
         bool addDefaultRoutesParameter;
         bool optimizeRoutesParameter;
+        std::string optimizeRoutesAlgorithmParameter;
         cXMLElement *configuration;
 
         // internal state
@@ -278,14 +293,46 @@ class INET_API IPv4NetworkConfigurator : public cSimpleModule, public IPvXAddres
         virtual void addStaticRoutes(IPv4Topology& topology);
 
         /**
-         * Destructively optimizes the given IPv4 routes by merging some of them.
-         * The resulting routes might be different in that they will route packets
-         * that the original routes did not. Nevertheless the following invariant
-         * holds: any packet routed by the original routes will still be routed
-         * the same way by the optimized routes.
+         * Destructively optimizes the given IPv4 routes using the algorithm selected
+         * by the optimizeRoutesAlgorithm parameter. The resulting routes might be
+         * different in that they will route packets that the original routes did not.
+         * Nevertheless the following invariant holds: any packet routed by the original
+         * routes will still be routed the same way by the optimized routes.
          */
         virtual void optimizeRoutes(std::vector<IPv4Route *> &routes);
 
+        /**
+         * Optimizes the routes by repeatedly merging two of them.
+         */
+        virtual void optimizeRoutesByMerging(std::vector<IPv4Route *> &routes);
+
+        /**
+         * Optimizes the routes with the ORTC algorithm on a binary prefix trie.
+         * It runs in time linear in the size of the trie, and produces the
+         * smallest routing table that routes all addresses covered by the
+         * original routes the same way.
+         */
+        virtual void optimizeRoutesWithOrtc(std::vector<IPv4Route *> &routes);
+
+        /**
+         * Returns a hash of everything the computed configuration depends on:
+         * the parameters, the XML configuration and the extracted topology.
+         */
+        virtual uint64 computeFingerprint(IPv4Topology& topology);
+
+        /**
+         * Writes the interface configurations and the unicast routes computed
+         * for the given topology into a binary cache file.
+         */
+        virtual void saveConfigurationCache(IPv4Topology& topology, const char *fileName, uint64 fingerprint);
+
+        /**
+         * Reads the interface configurations and the unicast routes from the
+         * cache file. Returns false and leaves the topology unchanged if the
+         * file does not exist, or was written for a different fingerprint.
+         */
+        virtual bool loadConfigurationCache(IPv4Topology& topology, const char *fileName, uint64 fingerprint);
+
         void ensureConfigurationComputed(IPv4Topology& topology);
         void configureInterface(InterfaceInfo *interfaceInfo);
         void configureRoutingTable(Node *node);
@@ -327,8 +374,11 @@ class INET_API IPv4NetworkConfigurator : public cSimpleModule, public IPvXAddres
                 uint32& mergedAddress, uint32& mergedAddressSpecifiedBits, uint32& mergedAddressIncompatibleBits,
                 uint32& mergedNetmask, uint32& mergedNetmaskSpecifiedBits, uint32& mergedNetmaskIncompatibleBits);
 
+        // helpers for static route generation
+        struct RouteLess { bool operator()(const IPv4Route *a, const IPv4Route *b) const; };  // an order consistent with IPv4Route::equals()
+        static bool lessByDistanceToTarget(Topology::Node *a, Topology::Node *b);
+
         // helpers for routing table optimization
-        bool containsRoute(const std::vector<IPv4Route *>& routes, IPv4Route *route);
         bool routesHaveSameColor(IPv4Route *route1, IPv4Route *route2);
         int findRouteIndexWithSameColor(const std::vector<IPv4Route *>& routes, IPv4Route *route);
         bool routesCanBeSwapped(RouteInfo *routeInfo1, RouteInfo *routeInfo2);
@@ -341,6 +391,8 @@ class INET_API IPv4NetworkConfigurator : public cSimpleModule, public IPvXAddres
         void addOriginalRouteInfos(RoutingTableInfo& routingTableInfo, int begin, int end, const std::vector<RouteInfo *>& originalRouteInfos);
         bool tryToMergeTwoRoutes(RoutingTableInfo& routingTableInfo, int i, int j, RouteInfo *routeInfoI, RouteInfo *routeInfoJ);
         bool tryToMergeAnyTwoRoutes(RoutingTableInfo& routingTableInfo);
+        static void computeOrtcColors(OrtcNode *node, int inheritedColor, std::vector<OrtcNode *>& nodes);
+        static void selectOrtcRoutes(OrtcNode *node, uint32 prefix, int length, int inheritedColor, std::vector<RouteInfo *>& routeInfos);
 
     public:
         // address resolver interface
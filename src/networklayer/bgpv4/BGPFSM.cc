@@ -402,15 +402,24 @@ void Established::entry()
                 continue;
             }
             BGPEntry = new BGP::RoutingTableEntry(rtEntry);
-            std::string entryh = rtEntry->getDestination().str();
-            std::string entryn = rtEntry->getNetmask().str();
             BGPEntry->addAS(session._info.ASValue);
             session.updateSendProcess(BGPEntry);
+            delete BGPEntry;
         }
     }
 
-    std::vector<BGP::RoutingTableEntry*> BGPRoutingTable = session.getBGPRoutingTable();
-    for (std::vector<BGP::RoutingTableEntry*>::iterator it = BGPRoutingTable.begin(); it != BGPRoutingTable.end(); it++)
+    //the networks originated by this router (see the networksFile parameter)
+    if (session.getType() == BGP::EGP)
+    {
+        const std::vector<BGP::RoutingTableEntry*>& networks = session.getNetworks();
+        for (std::vector<BGP::RoutingTableEntry*>::const_iterator it = networks.begin(); it != networks.end(); it++)
+        {
+            session.updateSendProcess((*it));
+        }
+    }
+
+    const BGP::RoutingInformationBase::RouteList& BGPRoutingTable = session.getBGPRoutingTable();
+    for (BGP::RoutingInformationBase::RouteList::const_iterator it = BGPRoutingTable.begin(); it != BGPRoutingTable.end(); it++)
     {
         session.updateSendProcess((*it));
     }
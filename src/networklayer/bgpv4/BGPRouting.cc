@@ -15,6 +15,8 @@
 // along with this program; if not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <fstream>
+
 #include "BGPRouting.h"
 
 #include "ModuleAccess.h"
@@ -32,7 +34,11 @@ BGPRouting::~BGPRouting(void)
     {
         (*sessionIterator).second->~BGPSession();
     }
-    _BGPRoutingTable.erase(_BGPRoutingTable.begin(), _BGPRoutingTable.end());
+    _BGPRoutingTable.clear();
+    for (std::vector<BGP::RoutingTableEntry*>::iterator it = _networks.begin(); it != _networks.end(); it++)
+    {
+        delete (*it);
+    }
     _prefixListIN.erase(_prefixListIN.begin(), _prefixListIN.end());
     _prefixListOUT.erase(_prefixListOUT.begin(), _prefixListOUT.end());
 }
@@ -56,8 +62,9 @@ void BGPRouting::initialize(int stage)
         // read BGP configuration
         cXMLElement *bgpConfig = par("bgpConfig").xmlValue();
         loadConfigFromXML(bgpConfig);
+        loadNetworks(par("networksFile"));
         createWatch("myAutonomousSystem", _myAS);
-        WATCH_PTRVECTOR(_BGPRoutingTable);
+        createStdPointerListWatcher("_BGPRoutingTable", _BGPRoutingTable.getRoutes());
     }
 }
 
@@ -293,8 +300,10 @@ void BGPRouting::processMessage(const BGPUpdateMessage& msg)
         if (decisionProcessResult != 0)
         {
             updateSendProcess(decisionProcessResult, _currSessionId, entry);
+            return;
         }
     }
+    delete entry;
 }
 
 unsigned char BGPRouting::decisionProcess(const BGPUpdateMessage& msg, BGP::RoutingTableEntry* entry, BGP::SessionID sessionIndex)
@@ -312,25 +321,26 @@ unsigned char BGPRouting::decisionProcess(const BGPUpdateMessage& msg, BGP::Rout
 
     //if the route already exist in BGP routing table, tieBreakingProcess();
     //(RFC 4271: 9.1.2.2 Breaking Ties)
-    unsigned long BGPindex = isInTable(_BGPRoutingTable, entry);
-    if (BGPindex != (unsigned long)-1)
+    BGP::RoutingTableEntry* oldEntry = _BGPRoutingTable.findRoute(entry->getDestination(), entry->getNetmask());
+    if (oldEntry)
     {
-        if (tieBreakingProcess(_BGPRoutingTable[BGPindex], entry))
+        if (tieBreakingProcess(oldEntry, entry))
         {
             return 0;
         }
         else
         {
+            _rt->deleteRoute(oldEntry);
             entry->setInterface(_BGPSessions[sessionIndex]->getLinkIntf());
-            _BGPRoutingTable.push_back(entry);
+            _BGPRoutingTable.setRoute(entry);
             _rt->addRoute(entry);
             return BGP::ROUTE_DESTINATION_CHANGED;
         }
     }
 
     //Don't add the route if it exists in IPv4 routing table except if the msg come from IGP session
-    int indexIP = isInRoutingTable(_rt, entry->getDestination());
-    if (indexIP != -1 && _rt->getRoute(indexIP)->getSourceType() != IPv4Route::BGP )
+    IPv4Route* rtEntry = _rt->findBestMatchingRoute(entry->getDestination());
+    if (rtEntry && rtEntry->getSourceType() != IPv4Route::BGP )
     {
         if (_BGPSessions[sessionIndex]->getType() != BGP::IGP )
         {
@@ -339,31 +349,30 @@ unsigned char BGPRouting::decisionProcess(const BGPUpdateMessage& msg, BGP::Rout
         else
         {
             IPv4Route* newEntry = new IPv4Route;
-            newEntry->setDestination(_rt->getRoute(indexIP)->getDestination());
-            newEntry->setNetmask(_rt->getRoute(indexIP)->getNetmask());
-            newEntry->setGateway(_rt->getRoute(indexIP)->getGateway());
-            newEntry->setInterface(_rt->getRoute(indexIP)->getInterface());
+            newEntry->setDestination(rtEntry->getDestination());
+            newEntry->setNetmask(rtEntry->getNetmask());
+            newEntry->setGateway(rtEntry->getGateway());
+            newEntry->setInterface(rtEntry->getInterface());
             newEntry->setSourceType(IPv4Route::BGP);
-            _rt->deleteRoute(_rt->getRoute(indexIP));
+            _rt->deleteRoute(rtEntry);
             _rt->addRoute(newEntry);
         }
     }
 
     entry->setInterface(_BGPSessions[sessionIndex]->getLinkIntf());
-    _BGPRoutingTable.push_back(entry);
+    _BGPRoutingTable.setRoute(entry);
 
     if (_BGPSessions[sessionIndex]->getType() == BGP::EGP)
     {
-        std::string entryh = entry->getDestination().str();
-        std::string entryn = entry->getNetmask().str();
         _rt->addRoute(entry);
         //insertExternalRoute on OSPF ExternalRoutingTable if OSPF exist on this BGP router
-        if (ospfExist(_rt))
+        //(look for the module first: ospfExist() scans the whole IP routing table)
+        OSPFRouting* ospf = OSPFRoutingAccess().getIfExists();
+        if (ospf && ospfExist(_rt))
         {
             OSPF::IPv4AddressRange  OSPFnetAddr;
             OSPFnetAddr.address = entry->getDestination();
             OSPFnetAddr.mask = entry->getNetmask();
-            OSPFRouting* ospf = OSPFRoutingAccess().getIfExists();
             InterfaceEntry *ie = entry->getInterface();
             if (!ie)
                 throw cRuntimeError("Model error: interface entry is NULL");
@@ -374,14 +383,13 @@ unsigned char BGPRouting::decisionProcess(const BGPUpdateMessage& msg, BGP::Rout
     return BGP::NEW_ROUTE_ADDED;
 }
 
-bool BGPRouting::tieBreakingProcess(BGP::RoutingTableEntry* oldEntry, BGP::RoutingTableEntry* entry)
+bool BGPRouting::tieBreakingProcess(const BGP::RoutingTableEntry* oldEntry, const BGP::RoutingTableEntry* entry)
 {
     /*a) Remove from consideration all routes that are not tied for
          having the smallest number of AS numbers present in their
          AS_PATH attributes.*/
     if (entry->getASCount() < oldEntry->getASCount())
     {
-        deleteBGPRoutingEntry(oldEntry);
         return false;
     }
 
@@ -389,7 +397,6 @@ bool BGPRouting::tieBreakingProcess(BGP::RoutingTableEntry* oldEntry, BGP::Routi
          having the lowest Origin number in their Origin attribute.*/
     if (entry->getPathType() < oldEntry->getPathType())
     {
-        deleteBGPRoutingEntry(oldEntry);
         return false;
     }
     return true;
@@ -402,18 +409,23 @@ void BGPRouting::updateSendProcess(const unsigned char type, BGP::SessionID sess
     //if it is not the currentSession and if the session is already established
     //SESSION = IGP : send an update message to External BGP Peer (EGP) only
     //if it is not the currentSession and if the session is already established
+    if (isInTable(_prefixListOUT, entry) != (unsigned long)-1 || isInASList(_ASListOUT, entry))
+    {
+        return;
+    }
+
+    BGP::type sessionType = _BGPSessions[sessionIndex]->getType();
     for (std::map<BGP::SessionID, BGPSession*>::iterator sessionIt = _BGPSessions.begin();
         sessionIt != _BGPSessions.end(); sessionIt ++)
     {
-        if (isInTable(_prefixListOUT, entry) != (unsigned long)-1 || isInASList(_ASListOUT, entry) ||
-            ((*sessionIt).first == sessionIndex && type != BGP::NEW_SESSION_ESTABLISHED ) ||
+        if (((*sessionIt).first == sessionIndex && type != BGP::NEW_SESSION_ESTABLISHED ) ||
             (type == BGP::NEW_SESSION_ESTABLISHED && (*sessionIt).first != sessionIndex ) ||
             !(*sessionIt).second->isEstablished() )
         {
             continue;
         }
-        if ((_BGPSessions[sessionIndex]->getType()==BGP::IGP && (*sessionIt).second->getType()==BGP::EGP ) ||
-            _BGPSessions[sessionIndex]->getType() == BGP::EGP ||
+        if ((sessionType == BGP::IGP && (*sessionIt).second->getType() == BGP::EGP ) ||
+            sessionType == BGP::EGP ||
             type == BGP::ROUTE_DESTINATION_CHANGED ||
             type == BGP::NEW_SESSION_ESTABLISHED )
         {
@@ -671,6 +683,46 @@ void BGPRouting::loadConfigFromXML(cXMLElement *bgpConfig)
     }
 }
 
+void BGPRouting::loadNetworks(const char *fileName)
+{
+    // one "address/prefixLength" per line; empty lines and lines starting with '#' are skipped
+    if (!*fileName)
+        return;
+    std::ifstream in(fileName, std::ios::in);
+    if (in.fail())
+        error("BGP Error: cannot open networks file '%s'", fileName);
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); lineNumber++)
+    {
+        std::string::size_type begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#')
+            continue;
+        std::string::size_type end = line.find_last_not_of(" \t\r");
+        std::string network = line.substr(begin, end - begin + 1);
+        std::string::size_type slash = network.find('/');
+        std::string address = network.substr(0, slash);
+        int length = -1;
+        if (slash != std::string::npos)
+        {
+            char *endp;
+            length = strtol(network.c_str() + slash + 1, &endp, 10);
+            if (*endp || endp == network.c_str() + slash + 1)
+                length = -1;
+        }
+        if (length < 0 || length > 32 || !IPv4Address::isWellFormed(address.c_str()))
+            error("BGP Error: invalid network '%s' at %s:%d", network.c_str(), fileName, lineNumber);
+
+        BGP::RoutingTableEntry* entry = new BGP::RoutingTableEntry();
+        entry->setNetmask(IPv4Address::makeNetmask(length));
+        entry->setDestination(IPv4Address(address.c_str()).doAnd(entry->getNetmask()));
+        entry->setPathType(BGP::IGP);
+        entry->addAS(_myAS);
+        _networks.push_back(entry);
+    }
+    EV << _networks.size() << " networks loaded from " << fileName << endl;
+}
+
 unsigned int BGPRouting::calculateStartDelay(int rtListSize, unsigned char rtPosition, unsigned char rtPeerPosition)
 {
     unsigned int startDelay = 0;
@@ -733,9 +785,9 @@ BGP::SessionID BGPRouting::createSession(BGP::type typeSession, const char* peer
 }
 
 
-BGP::SessionID BGPRouting::findIdFromPeerAddr(std::map<BGP::SessionID, BGPSession*> sessions, IPv4Address peerAddr)
+BGP::SessionID BGPRouting::findIdFromPeerAddr(const std::map<BGP::SessionID, BGPSession*>& sessions, IPv4Address peerAddr)
 {
-    for (std::map<BGP::SessionID, BGPSession*>::iterator sessionIterator = sessions.begin();
+    for (std::map<BGP::SessionID, BGPSession*>::const_iterator sessionIterator = sessions.begin();
         sessionIterator != sessions.end(); sessionIterator ++)
     {
         if ((*sessionIterator).second->getPeerAddr().equals(peerAddr))
@@ -746,36 +798,6 @@ BGP::SessionID BGPRouting::findIdFromPeerAddr(std::map<BGP::SessionID, BGPSessio
     return -1;
 }
 
-/*delete BGP Routing entry, if the route deleted correctly return true, false else*/
-bool BGPRouting::deleteBGPRoutingEntry(BGP::RoutingTableEntry* entry){
-    for (std::vector<BGP::RoutingTableEntry*>::iterator it = _BGPRoutingTable.begin();
-         it != _BGPRoutingTable.end(); it++)
-    {
-        if (((*it)->getDestination().getInt() & (*it)->getNetmask().getInt()) ==
-            (entry->getDestination().getInt() & entry->getNetmask().getInt()))
-        {
-            _BGPRoutingTable.erase(it);
-            _rt->deleteRoute(entry);
-            return true;
-        }
-    }
-    return false;
-}
-
-/*return index of the IPv4 table if the route is found, -1 else*/
-int BGPRouting::isInRoutingTable(IRoutingTable* rtTable, IPv4Address addr)
-{
-    for (int i = 0; i < rtTable->getNumRoutes(); i++)
-    {
-        const IPv4Route* entry = rtTable->getRoute(i);
-        if (IPv4Address::maskedAddrAreEqual(addr, entry->getDestination(), entry->getNetmask()))
-        {
-            return i;
-        }
-    }
-    return -1;
-}
-
 int BGPRouting::isInInterfaceTable(IInterfaceTable* ifTable, IPv4Address addr)
 {
     for (int i = 0; i < ifTable->getNumInterfaces(); i++)
@@ -788,9 +810,9 @@ int BGPRouting::isInInterfaceTable(IInterfaceTable* ifTable, IPv4Address addr)
     return -1;
 }
 
-BGP::SessionID BGPRouting::findIdFromSocketConnId(std::map<BGP::SessionID, BGPSession*> sessions, int connId)
+BGP::SessionID BGPRouting::findIdFromSocketConnId(const std::map<BGP::SessionID, BGPSession*>& sessions, int connId)
 {
-    for (std::map<BGP::SessionID, BGPSession*>::iterator sessionIterator = sessions.begin();
+    for (std::map<BGP::SessionID, BGPSession*>::const_iterator sessionIterator = sessions.begin();
         sessionIterator != sessions.end(); sessionIterator ++)
     {
         TCPSocket* socket = (*sessionIterator).second->getSocket();
@@ -803,7 +825,7 @@ BGP::SessionID BGPRouting::findIdFromSocketConnId(std::map<BGP::SessionID, BGPSe
 }
 
 /*return index of the table if the route is found, -1 else*/
-unsigned long BGPRouting::isInTable(std::vector<BGP::RoutingTableEntry*> rtTable, BGP::RoutingTableEntry* entry)
+unsigned long BGPRouting::isInTable(const std::vector<BGP::RoutingTableEntry*>& rtTable, const BGP::RoutingTableEntry* entry)
 {
     for (unsigned long i = 0; i < rtTable.size(); i++)
     {
@@ -818,9 +840,9 @@ unsigned long BGPRouting::isInTable(std::vector<BGP::RoutingTableEntry*> rtTable
 }
 
 /*return true if the AS is found, false else*/
-bool BGPRouting::isInASList(std::vector<BGP::ASID> ASList, BGP::RoutingTableEntry* entry)
+bool BGPRouting::isInASList(const std::vector<BGP::ASID>& ASList, const BGP::RoutingTableEntry* entry)
 {
-    for (std::vector<BGP::ASID>::iterator it = ASList.begin(); it != ASList.end(); it++)
+    for (std::vector<BGP::ASID>::const_iterator it = ASList.begin(); it != ASList.end(); it++)
     {
         for (unsigned int i = 0; i < entry->getASCount(); i++)
         {
@@ -26,6 +26,7 @@
 #include "InterfaceTableAccess.h"
 #include "OSPFRoutingAccess.h"
 #include "BGPRoutingTableEntry.h"
+#include "BGPRoutingInformationBase.h"
 #include "BGPCommon.h"
 #include "IPv4InterfaceData.h"
 #include "IPv4Address.h"
@@ -66,7 +67,8 @@ protected:
     cMessage*       getCancelEvent(cMessage* msg)               { return cancelEvent(msg);}
     cGate*          getGate(const char* gateName)               { return gate(gateName);}
     IRoutingTable*  getIPRoutingTable()                         { return _rt;}
-    std::vector<BGP::RoutingTableEntry*> getBGPRoutingTable()   { return _BGPRoutingTable;}
+    const BGP::RoutingInformationBase::RouteList& getBGPRoutingTable() { return _BGPRoutingTable.getRoutes();}
+    const std::vector<BGP::RoutingTableEntry*>& getNetworks()   { return _networks;}
     /**
      * \brief active listenSocket for a given session (used by BGPFSM)
      */
@@ -98,7 +100,6 @@ private:
     void processMessage(const BGPKeepAliveMessage& msg);
     void processMessage(const BGPUpdateMessage& msg);
 
-    bool deleteBGPRoutingEntry(BGP::RoutingTableEntry* entry);
     /**
      * \brief RFC 4271: 9.1. : Decision Process used when an UPDATE message is received
      *  As matches, routes are sent or not to UpdateSentProcess
@@ -109,25 +110,25 @@ private:
      * \brief RFC 4271: 9.1.2.2 Breaking Ties used when BGP speaker may have several routes
      *  to the same destination that have the same degree of preference.
      *
-     * \return bool, true if this process changed the route, false else
+     * \return bool, true if the old route stays, false if the new one replaces it
      */
-    bool tieBreakingProcess(BGP::RoutingTableEntry* oldEntry, BGP::RoutingTableEntry* entry);
+    bool tieBreakingProcess(const BGP::RoutingTableEntry* oldEntry, const BGP::RoutingTableEntry* entry);
 
     BGP::SessionID createSession(BGP::type typeSession, const char* peerAddr);
-    bool isInASList(std::vector<BGP::ASID> ASList, BGP::RoutingTableEntry* entry);
-    unsigned long   isInTable(std::vector<BGP::RoutingTableEntry*> rtTable, BGP::RoutingTableEntry* entry);
+    bool isInASList(const std::vector<BGP::ASID>& ASList, const BGP::RoutingTableEntry* entry);
+    unsigned long   isInTable(const std::vector<BGP::RoutingTableEntry*>& rtTable, const BGP::RoutingTableEntry* entry);
 
     std::vector<const char *> loadASConfig(cXMLElementList& ASConfig);
     void loadSessionConfig(cXMLElementList& sessionList, simtime_t* delayTab);
     void loadConfigFromXML(cXMLElement *bgpConfig);
+    void loadNetworks(const char *fileName);
     BGP::ASID findMyAS(cXMLElementList& ASList, int& outRouterPosition);
     bool ospfExist(IRoutingTable* rtTable);
     void loadTimerConfig(cXMLElementList& timerConfig, simtime_t* delayTab);
     unsigned char asLoopDetection(BGP::RoutingTableEntry* entry, BGP::ASID myAS);
-    BGP::SessionID findIdFromPeerAddr(std::map<BGP::SessionID, BGPSession*> sessions, IPv4Address peerAddr);
-    int isInRoutingTable(IRoutingTable* rtTable, IPv4Address addr);
+    BGP::SessionID findIdFromPeerAddr(const std::map<BGP::SessionID, BGPSession*>& sessions, IPv4Address peerAddr);
     int isInInterfaceTable(IInterfaceTable* rtTable, IPv4Address addr);
-    BGP::SessionID findIdFromSocketConnId(std::map<BGP::SessionID, BGPSession*> sessions, int connId);
+    BGP::SessionID findIdFromSocketConnId(const std::map<BGP::SessionID, BGPSession*>& sessions, int connId);
     unsigned int calculateStartDelay(int rtListSize, unsigned char rtPosition, unsigned char rtPeerPosition);
 
     TCPSocketMap                            _socketMap;
@@ -136,7 +137,8 @@ private:
 
     IInterfaceTable*                        _inft;
     IRoutingTable*                          _rt;                // The IP routing table
-    std::vector<BGP::RoutingTableEntry*>    _BGPRoutingTable;   // The BGP routing table
+    BGP::RoutingInformationBase             _BGPRoutingTable;   // The BGP routing table (Loc-RIB)
+    std::vector<BGP::RoutingTableEntry*>    _networks;          // Routes originated from the networksFile
     std::vector<BGP::RoutingTableEntry*>    _prefixListIN;
     std::vector<BGP::RoutingTableEntry*>    _prefixListOUT;
     std::vector<BGP::ASID>                  _ASListIN;
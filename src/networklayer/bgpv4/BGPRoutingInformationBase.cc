@@ -0,0 +1,66 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "BGPRoutingInformationBase.h"
+
+#include "BGPRoutingTableEntry.h"
+
+namespace BGP {
+
+RoutingInformationBase::Trie::Node *RoutingInformationBase::findNode(const IPv4Address& destination, const IPv4Address& netmask) const
+{
+    int length = netmask.getNetmaskLength();
+    return trie.findNode(IPv4PrefixTraits::getPrefix(destination, length), length);
+}
+
+RoutingTableEntry *RoutingInformationBase::findRoute(const IPv4Address& destination, const IPv4Address& netmask) const
+{
+    Trie::Node *node = findNode(destination, netmask);
+    return node ? node->data.route : NULL;
+}
+
+RoutingTableEntry *RoutingInformationBase::findBestMatchingRoute(const IPv4Address& address) const
+{
+    RoutingTableEntry *bestRoute = NULL;
+    for (const Trie::Node *node = trie.getRoot(); node; node = trie.getMatchingChild(node, address))
+        if (node->data.route)
+            bestRoute = node->data.route;
+    return bestRoute;
+}
+
+RoutingTableEntry *RoutingInformationBase::setRoute(RoutingTableEntry *route)
+{
+    int length = route->getNetmask().getNetmaskLength();
+    Route& data = trie.findOrCreateNode(IPv4PrefixTraits::getPrefix(route->getDestination(), length), length)->data;
+    RoutingTableEntry *oldRoute = data.route;
+    if (oldRoute)
+        locRIB.erase(data.locRIBPos);
+    data.route = route;
+    data.locRIBPos = locRIB.insert(locRIB.end(), route);
+    return oldRoute;
+}
+
+bool RoutingInformationBase::removeRoute(RoutingTableEntry *route)
+{
+    Trie::Node *node = findNode(route->getDestination(), route->getNetmask());
+    if (!node || node->data.route != route)
+        return false;
+    locRIB.erase(node->data.locRIBPos);
+    node->data.route = NULL;
+    trie.removeNodeIfUnused(node);
+    return true;
+}
+
+} // namespace BGP
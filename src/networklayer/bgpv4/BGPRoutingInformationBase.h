@@ -0,0 +1,107 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_BGPROUTINGINFORMATIONBASE_H
+#define __INET_BGPROUTINGINFORMATIONBASE_H
+
+#include <list>
+
+#include "INETDefs.h"
+
+#include "IPv4Address.h"
+#include "PrefixTrie.h"
+
+namespace BGP {
+
+class RoutingTableEntry;
+
+/**
+ * The Loc-RIB of BGPRouting (RFC 4271, 3.2), indexed by a PrefixTrie keyed by
+ * destination/netmask.
+ *
+ * Every prefix has at most one route, the best path selected by the decision
+ * process; the decision process compares received routes against it, so it
+ * is looked up in the trie instead of being searched for. The routes are also
+ * kept in a list in the order they were selected, which is the order they are
+ * advertised to a newly established session.
+ *
+ * The routes are not owned.
+ *
+ * @see IPv4RouteTrie
+ */
+class INET_API RoutingInformationBase
+{
+  public:
+    typedef std::list<RoutingTableEntry *> RouteList;
+
+  protected:
+    struct Route
+    {
+        RoutingTableEntry *route;       // Loc-RIB route of the prefix, or NULL
+        RouteList::iterator locRIBPos;  // position of route in locRIB
+
+        Route() : route(NULL) {}
+        bool empty() const {return route == NULL;}
+    };
+    typedef PrefixTrie<IPv4Address, Route, IPv4PrefixTraits> Trie;
+
+    Trie trie;
+    RouteList locRIB;
+
+  protected:
+    Trie::Node *findNode(const IPv4Address& destination, const IPv4Address& netmask) const;
+
+  public:
+    /**
+     * Returns the Loc-RIB route of the prefix, or NULL if there is none.
+     */
+    RoutingTableEntry *findRoute(const IPv4Address& destination, const IPv4Address& netmask) const;
+
+    /**
+     * Returns the Loc-RIB route with the longest prefix matching the address,
+     * or NULL if there is none.
+     */
+    RoutingTableEntry *findBestMatchingRoute(const IPv4Address& address) const;
+
+    /**
+     * Makes the route the Loc-RIB route of its prefix (its netmask must be
+     * a valid netmask), and returns the route it replaces, or NULL. The route
+     * goes to the end of getRoutes().
+     */
+    RoutingTableEntry *setRoute(RoutingTableEntry *route);
+
+    /**
+     * Removes the Loc-RIB route, and returns true if it was found.
+     */
+    bool removeRoute(RoutingTableEntry *route);
+
+    /**
+     * Removes all routes.
+     */
+    void clear() {trie.clear(); locRIB.clear();}
+
+    /**
+     * The Loc-RIB routes in the order they were selected.
+     */
+    const RouteList& getRoutes() const {return locRIB;}
+    RouteList& getRoutes() {return locRIB;}
+
+    int getNumRoutes() const {return locRIB.size();}
+    int getNumNodes() const {return trie.getNumNodes();}
+};
+
+} // namespace BGP
+
+#endif
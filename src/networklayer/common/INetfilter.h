@@ -49,6 +49,14 @@ class INET_API INetfilter {
 
             virtual ~IHook() {};
 
+            /**
+             * Returns whether the hook function of the given type does
+             * anything besides returning ACCEPT. The network layer only calls
+             * the hook functions that are used; the answer must not change
+             * while the hook is registered.
+             */
+            virtual bool isHookTypeUsed(Type type) const { return true; }
+
             /**
              * TODO
              * nextHopAddress ignored when outputInterfaceEntry is NULL
@@ -120,32 +120,9 @@ bool InterfaceTable::isLocalAddress(const IPvXAddress& address) const
 
 InterfaceEntry *InterfaceTable::findInterfaceByAddress(const IPvXAddress& address) const
 {
-    if (!address.isUnspecified())
-    {
-        for (int i = 0; i < (int)idToInterface.size(); i++)
-        {
-            InterfaceEntry *ie = idToInterface[i];
-            if (ie)
-            {
-#ifdef WITH_IPv4
-                if (!address.isIPv6())
-                {
-                    if (ie->ipv4Data() && ie->ipv4Data()->getIPAddress() == address.get4())
-                        return ie;
-                }
-#endif
-
-#ifdef WITH_IPv6
-                if (address.isIPv6())
-                {
-                    if (ie->ipv6Data() && ie->ipv6Data()->hasAddress(address.get6()))
-                        return ie;
-                }
-#endif
-            }
-        }
-    }
-    return NULL;
+    if (address.isUnspecified())
+        return NULL;
+    return addressIndex.find(address);
 }
 
 bool InterfaceTable::isNeighborAddress(const IPvXAddress &address) const
@@ -252,6 +229,8 @@ void InterfaceTable::addInterface(InterfaceEntry *entry)
     entry->setInterfaceId(INTERFACEIDS_START + idToInterface.size());
     entry->setInterfaceTable(this);
     idToInterface.push_back(entry);
+    idToIndexedKeys.push_back(IndexedKeys());
+    addToIndexes(entry);
     invalidateTmpInterfaceList();
 
     // fill in networkLayerGateIndex, nodeOutputGateId, nodeInputGateId
@@ -328,6 +307,7 @@ void InterfaceTable::deleteInterface(InterfaceEntry *entry)
 
     nb->fireChangeNotification(NF_INTERFACE_DELETED, entry);  // actually, only going to be deleted
 
+    removeFromIndexes(entry);
     idToInterface[id - INTERFACEIDS_START] = NULL;
     delete entry;
     invalidateTmpInterfaceList();
@@ -340,10 +320,58 @@ void InterfaceTable::invalidateTmpInterfaceList()
     tmpInterfaceList = NULL;
 }
 
+void InterfaceTable::addToIndexes(InterfaceEntry *entry)
+{
+    IndexedKeys& keys = idToIndexedKeys[entry->getInterfaceId() - INTERFACEIDS_START];
+    keys.name = entry->getName();
+    keys.nodeOutputGateId = entry->getNodeOutputGateId();
+    keys.nodeInputGateId = entry->getNodeInputGateId();
+    keys.networkLayerGateIndex = entry->getNetworkLayerGateIndex();
+    keys.addresses.clear();
+#ifdef WITH_IPv4
+    if (entry->ipv4Data() && !entry->ipv4Data()->getIPAddress().isUnspecified())
+        keys.addresses.push_back(entry->ipv4Data()->getIPAddress());
+#endif
+#ifdef WITH_IPv6
+    if (entry->ipv6Data())
+        for (int i = 0; i < entry->ipv6Data()->getNumAddresses(); i++)
+            keys.addresses.push_back(entry->ipv6Data()->getAddress(i));
+#endif
+
+    int id = entry->getInterfaceId();
+    nameIndex.insert(keys.name, entry, id);
+    nodeOutputGateIdIndex.insert(keys.nodeOutputGateId, entry, id);
+    nodeInputGateIdIndex.insert(keys.nodeInputGateId, entry, id);
+    networkLayerGateIndexIndex.insert(keys.networkLayerGateIndex, entry, id);
+    for (int i = 0; i < (int)keys.addresses.size(); i++)
+        addressIndex.insert(keys.addresses[i], entry, id);
+}
+
+void InterfaceTable::removeFromIndexes(InterfaceEntry *entry)
+{
+    IndexedKeys& keys = idToIndexedKeys[entry->getInterfaceId() - INTERFACEIDS_START];
+    nameIndex.remove(keys.name, entry);
+    nodeOutputGateIdIndex.remove(keys.nodeOutputGateId, entry);
+    nodeInputGateIdIndex.remove(keys.nodeInputGateId, entry);
+    networkLayerGateIndexIndex.remove(keys.networkLayerGateIndex, entry);
+    for (int i = 0; i < (int)keys.addresses.size(); i++)
+        addressIndex.remove(keys.addresses[i], entry);
+    keys.addresses.clear();
+}
+
 void InterfaceTable::interfaceChanged(int category, const InterfaceEntryChangeDetails *details)
 {
     Enter_Method_Silent();
 
+    // update the indexes before the listeners are notified, so that they already see the change
+    InterfaceEntry *entry = details->getInterfaceEntry();
+    if ((category == NF_INTERFACE_CONFIG_CHANGED || category == NF_INTERFACE_IPv4CONFIG_CHANGED || category == NF_INTERFACE_IPv6CONFIG_CHANGED)
+            && getInterfaceById(entry->getInterfaceId()) == entry)
+    {
+        removeFromIndexes(entry);
+        addToIndexes(entry);
+    }
+
     nb->fireChangeNotification(category, details);
 
     if (ev.isGUI() && par("displayAddresses").boolValue())
@@ -380,35 +408,17 @@ void InterfaceTable::updateLinkDisplayString(InterfaceEntry *entry)
 
 InterfaceEntry *InterfaceTable::getInterfaceByNodeOutputGateId(int id)
 {
-    // linear search is OK because normally we have don't have many interfaces and this func is rarely called
-    Enter_Method_Silent();
-    int n = idToInterface.size();
-    for (int i=0; i<n; i++)
-        if (idToInterface[i] && idToInterface[i]->getNodeOutputGateId()==id)
-            return idToInterface[i];
-    return NULL;
+    return nodeOutputGateIdIndex.find(id);
 }
 
 InterfaceEntry *InterfaceTable::getInterfaceByNodeInputGateId(int id)
 {
-    // linear search is OK because normally we have don't have many interfaces and this func is rarely called
-    Enter_Method_Silent();
-    int n = idToInterface.size();
-    for (int i=0; i<n; i++)
-        if (idToInterface[i] && idToInterface[i]->getNodeInputGateId()==id)
-            return idToInterface[i];
-    return NULL;
+    return nodeInputGateIdIndex.find(id);
 }
 
 InterfaceEntry *InterfaceTable::getInterfaceByNetworkLayerGateIndex(int index)
 {
-    // linear search is OK because normally we have don't have many interfaces and this func is rarely called
-    Enter_Method_Silent();
-    int n = idToInterface.size();
-    for (int i=0; i<n; i++)
-        if (idToInterface[i] && idToInterface[i]->getNetworkLayerGateIndex()==index)
-            return idToInterface[i];
-    return NULL;
+    return networkLayerGateIndexIndex.find(index);
 }
 
 InterfaceEntry *InterfaceTable::getInterfaceByInterfaceModule(cModule *ifmod)
@@ -445,19 +455,13 @@ InterfaceEntry *InterfaceTable::getInterfaceByInterfaceModule(cModule *ifmod)
 
 InterfaceEntry *InterfaceTable::getInterfaceByName(const char *name)
 {
-    Enter_Method_Silent();
     if (!name)
         return NULL;
-    int n = idToInterface.size();
-    for (int i=0; i<n; i++)
-        if (idToInterface[i] && !strcmp(name, idToInterface[i]->getName()))
-            return idToInterface[i];
-    return NULL;
+    return nameIndex.find(name);
 }
 
 InterfaceEntry *InterfaceTable::getFirstLoopbackInterface()
 {
-    Enter_Method_Silent();
     int n = idToInterface.size();
     for (int i=0; i<n; i++)
         if (idToInterface[i] && idToInterface[i]->isLoopback())
@@ -467,7 +471,6 @@ InterfaceEntry *InterfaceTable::getFirstLoopbackInterface()
 
 InterfaceEntry *InterfaceTable::getFirstMulticastInterface()
 {
-    Enter_Method_Silent();
     int n = idToInterface.size();
     for (int i=0; i<n; i++)
         if (idToInterface[i] && idToInterface[i]->isMulticast() && !idToInterface[i]->isLoopback())
@@ -495,6 +498,13 @@ void InterfaceTable::resetInterfaces()
 {
     int n = idToInterface.size();
     for (int i = 0; i < n; i++)
+    {
         if (idToInterface[i])
+        {
+            // resetInterface() does not notify about the removed protocol data
+            removeFromIndexes(idToInterface[i]);
             idToInterface[i]->resetInterface();
+            addToIndexes(idToInterface[i]);
+        }
+    }
 }
@@ -24,10 +24,28 @@
 
 #include "IInterfaceTable.h"
 #include "InterfaceEntry.h"
+#include "HashIndex.h"
 #include "NotificationBoard.h"
 #include "ILifecycle.h"
 #include "IPvXAddress.h"
 
+struct InterfaceAddressHash
+{
+    uint32 operator()(const IPvXAddress& key) const
+    {
+        uint32 h;
+        if (key.isIPv6())
+        {
+            const uint32 *words = key.words();
+            h = ((words[0] * 31 + words[1]) * 31 + words[2]) * 31 + words[3];
+        }
+        else
+            h = key.get4().getInt();
+        h *= 2654435761u;
+        return h ^ (h >> 16);
+    }
+};
+
 /**
  * Represents the interface table. This object has one instance per host
  * or router. It has methods to manage the interface table,
@@ -80,6 +98,27 @@ class INET_API InterfaceTable : public cSimpleModule, public IInterfaceTable, pr
     int tmpNumInterfaces; // caches number of non-NULL elements of idToInterface; -1 if invalid
     InterfaceEntry **tmpInterfaceList; // caches non-NULL elements of idToInterface; NULL if invalid
 
+    // hash indexes for the getInterfaceBy...() and findInterfaceByAddress() lookups,
+    // updated when an interface is added, deleted or its configuration changes;
+    // ranked by interface id, so they return the same interface as a linear search
+    HashIndex<std::string, InterfaceEntry, StringHash> nameIndex;
+    HashIndex<int, InterfaceEntry, IntHash> nodeOutputGateIdIndex;
+    HashIndex<int, InterfaceEntry, IntHash> nodeInputGateIdIndex;
+    HashIndex<int, InterfaceEntry, IntHash> networkLayerGateIndexIndex;
+    HashIndex<IPvXAddress, InterfaceEntry, InterfaceAddressHash> addressIndex;
+
+    // the keys an interface is currently indexed with, so that it can be removed
+    // from the indexes after they have changed; vector indexed by id
+    struct IndexedKeys
+    {
+        std::string name;
+        int nodeOutputGateId;
+        int nodeInputGateId;
+        int networkLayerGateIndex;
+        std::vector<IPvXAddress> addresses;
+    };
+    std::vector<IndexedKeys> idToIndexedKeys;
+
   protected:
     // displays summary above the icon
     virtual void updateDisplayString();
@@ -96,6 +135,10 @@ class INET_API InterfaceTable : public cSimpleModule, public IInterfaceTable, pr
     // internal
     virtual void invalidateTmpInterfaceList();
 
+    // maintain the hash indexes
+    virtual void addToIndexes(InterfaceEntry *entry);
+    virtual void removeFromIndexes(InterfaceEntry *entry);
+
     virtual void resetInterfaces();
 
   public:
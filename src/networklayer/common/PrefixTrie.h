@@ -0,0 +1,256 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_PREFIXTRIE_H
+#define __INET_PREFIXTRIE_H
+
+#include <algorithm>
+
+#include "INETDefs.h"
+
+#include "IPv4Address.h"
+#include "IPv6Address.h"
+
+
+/**
+ * Path-compressed binary trie (Patricia trie) of address prefixes, used as
+ * the longest prefix match index of IPv4RouteTrie, IPv6RouteTrie and
+ * BGP::RoutingInformationBase. Every node stores a prefix and a Data
+ * payload (e.g. the routes of the prefix); nodes with empty payload are only
+ * kept where two subtries branch, so the depth is bounded by both the
+ * address length and the number of distinct prefixes.
+ *
+ * Data must be default constructible and have an empty() method; the users
+ * fill the payload of the node returned by findOrCreateNode(), and call
+ * removeNodeIfUnused() after emptying it. Lookups walk the matching nodes
+ * from the root with getMatchingChild(), shortest prefix first.
+ *
+ * The Traits class defines the address operations; see the ones below.
+ */
+template <class Key, class Data, class Traits>
+class PrefixTrie
+{
+  public:
+    struct Node
+    {
+        Key prefix;      // bits beyond length are zero
+        int length;      // prefix length
+        Node *parent;
+        Node *children[2];
+        Data data;
+
+        Node(const Key& prefix, int length, Node *parent) : prefix(prefix), length(length), parent(parent) {children[0] = children[1] = NULL;}
+    };
+
+  protected:
+    Node *root;  // the zero-length prefix; always present
+    int numNodes;
+
+  protected:
+    void deleteNode(Node *node)
+    {
+        if (node)
+        {
+            deleteNode(node->children[0]);
+            deleteNode(node->children[1]);
+            delete node;
+        }
+    }
+
+  private:
+    PrefixTrie(const PrefixTrie&);  // not copyable
+    PrefixTrie& operator=(const PrefixTrie&);
+
+  public:
+    PrefixTrie() : root(new Node(Key(), 0, NULL)), numNodes(1) {}
+    ~PrefixTrie() {deleteNode(root);}
+
+    /**
+     * Removes all nodes.
+     */
+    void clear()
+    {
+        deleteNode(root);
+        root = new Node(Key(), 0, NULL);
+        numNodes = 1;
+    }
+
+    /**
+     * Returns the node of the prefix (its bits beyond length must be zero),
+     * creating it if needed.
+     */
+    Node *findOrCreateNode(const Key& prefix, int length)
+    {
+        Node *node = root;
+        while (node->length != length)
+        {
+            int bit = Traits::getBit(prefix, node->length);
+            Node *child = node->children[bit];
+            if (!child)
+            {
+                // new leaf
+                child = node->children[bit] = new Node(prefix, length, node);
+                numNodes++;
+                return child;
+            }
+
+            int commonLength = Traits::getCommonPrefixLength(child->prefix, prefix, std::min(child->length, length));
+            if (commonLength == child->length)
+            {
+                // child prefix is a prefix of ours: descend
+                node = child;
+                continue;
+            }
+
+            // split the edge to child at commonLength
+            Node *branch = new Node(Traits::getPrefix(prefix, commonLength), commonLength, node);
+            numNodes++;
+            node->children[bit] = branch;
+            branch->children[Traits::getBit(child->prefix, commonLength)] = child;
+            child->parent = branch;
+            if (commonLength == length)
+                return branch;
+            Node *leaf = new Node(prefix, length, branch);
+            numNodes++;
+            branch->children[Traits::getBit(prefix, commonLength)] = leaf;
+            return leaf;
+        }
+        return node;
+    }
+
+    /**
+     * Returns the node of the prefix (its bits beyond length must be zero),
+     * or NULL if there is none.
+     */
+    Node *findNode(const Key& prefix, int length) const
+    {
+        Node *node = root;
+        while (node && node->length < length)
+        {
+            node = node->children[Traits::getBit(prefix, node->length)];
+            if (node && node->length <= length && !Traits::matches(node->prefix, prefix, node->length))
+                return NULL;
+        }
+        return node && node->length == length && node->prefix == prefix ? node : NULL;
+    }
+
+    /**
+     * Removes the node if its payload is empty and it does not branch, and then
+     * its ancestors that became such. The root is never removed.
+     */
+    void removeNodeIfUnused(Node *node)
+    {
+        // keep the path compressed: a node without payload is only needed if it has two children
+        while (node != root && node->data.empty() && !(node->children[0] && node->children[1]))
+        {
+            Node *parent = node->parent;
+            Node *child = node->children[0] ? node->children[0] : node->children[1];
+            int bit = parent->children[0] == node ? 0 : 1;
+            parent->children[bit] = child;
+            if (child)
+                child->parent = parent;
+            delete node;
+            numNodes--;
+            if (child)
+                break;
+            node = parent;  // may have become an empty node with a single child
+        }
+    }
+
+    /**
+     * The node of the zero-length prefix, which matches every address.
+     */
+    Node *getRoot() const {return root;}
+
+    /**
+     * Returns the child of a node matching the address (the node must match it
+     * too), i.e. the next longer matching prefix on the path, or NULL.
+     */
+    Node *getMatchingChild(const Node *node, const Key& address) const
+    {
+        if (node->length == Traits::MAX_LENGTH)
+            return NULL;
+        Node *child = node->children[Traits::getBit(address, node->length)];
+        // nodes skip bits, so check the whole prefix
+        return child && Traits::matches(child->prefix, address, child->length) ? child : NULL;
+    }
+
+    int getNumNodes() const {return numNodes;}
+};
+
+struct IPv4PrefixTraits
+{
+    enum {MAX_LENGTH = 32};
+
+    static uint32 getMask(int length) {return length == 0 ? 0 : 0xffffffffu << (32 - length);}
+
+    static int getBit(const IPv4Address& address, int index) {return (address.getInt() >> (31 - index)) & 1;}
+
+    static IPv4Address getPrefix(const IPv4Address& address, int length) {return IPv4Address(address.getInt() & getMask(length));}
+
+    static bool matches(const IPv4Address& prefix, const IPv4Address& address, int length)
+    {
+        return ((prefix.getInt() ^ address.getInt()) & getMask(length)) == 0;
+    }
+
+    static int getCommonPrefixLength(const IPv4Address& a, const IPv4Address& b, int maxLength)
+    {
+        uint32 diff = a.getInt() ^ b.getInt();
+        int length = 0;
+        while (length < maxLength && !(diff & 0x80000000u))
+        {
+            diff <<= 1;
+            length++;
+        }
+        return length;
+    }
+};
+
+struct IPv6PrefixTraits
+{
+    enum {MAX_LENGTH = 128};
+
+    static int getBit(const IPv6Address& address, int index) {return (address.words()[index >> 5] >> (31 - (index & 31))) & 1;}
+
+    static IPv6Address getPrefix(const IPv6Address& address, int length) {return address.getPrefix(length);}
+
+    static bool matches(const IPv6Address& prefix, const IPv6Address& address, int length)
+    {
+        return getCommonPrefixLength(prefix, address, length) == length;
+    }
+
+    static int getCommonPrefixLength(const IPv6Address& a, const IPv6Address& b, int maxLength)
+    {
+        int length = 0;
+        for (int i = 0; i < 4 && length < maxLength; i++)
+        {
+            uint32 diff = a.words()[i] ^ b.words()[i];
+            if (diff == 0)
+            {
+                length += 32;
+                continue;
+            }
+            while (!(diff & 0x80000000u))
+            {
+                diff <<= 1;
+                length++;
+            }
+            break;
+        }
+        return std::min(length, maxLength);
+    }
+};
+
+#endif
@@ -30,6 +30,14 @@
 #include "IPv6Datagram.h"
 #endif
 
+#ifdef WITH_UDP
+#include "UDPPacket.h"
+#endif
+
+#ifdef WITH_TCP_COMMON
+#include "TCPSegment.h"
+#endif
+
 
 #include "DiffservUtil.h"
 #include "DSCP_m.h"
@@ -219,6 +227,28 @@ cPacket *findIPDatagramInPacket(cPacket *packet)
     return NULL;
 }
 
+void getTransportPorts(cPacket *packet, int &srcPort, int &destPort)
+{
+    srcPort = destPort = -1;
+#ifdef WITH_UDP
+    UDPPacket *udpPacket = dynamic_cast<UDPPacket*>(packet);
+    if (udpPacket)
+    {
+        srcPort = udpPacket->getSourcePort();
+        destPort = udpPacket->getDestinationPort();
+        return;
+    }
+#endif
+#ifdef WITH_TCP_COMMON
+    TCPSegment *tcpSegment = dynamic_cast<TCPSegment*>(packet);
+    if (tcpSegment)
+    {
+        srcPort = tcpSegment->getSrcPort();
+        destPort = tcpSegment->getDestPort();
+    }
+#endif
+}
+
 class ColorAttribute : public cObject
 {
     public:
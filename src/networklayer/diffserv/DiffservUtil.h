@@ -99,6 +99,12 @@ namespace DiffservUtil
      */
     cPacket *findIPDatagramInPacket(cPacket *packet);
 
+    /**
+     * Returns the ports of the UDP packet or TCP segment in srcPort and destPort,
+     * or -1 if the packet is neither (e.g. it is NULL).
+     */
+    void getTransportPorts(cPacket *packet, int &srcPort, int &destPort);
+
     /**
      * Returns the color of the packet.
      * The color was set by a previous meter component.
@@ -28,23 +28,17 @@
 #include "IPv6Datagram.h"
 #endif
 
-#ifdef WITH_UDP
-#include "UDPPacket.h"
-#endif
-
-#ifdef WITH_TCP_COMMON
-#include "TCPSegment.h"
-#endif
-
 #include "MultiFieldClassifier.h"
+#include "MultiFieldDecisionTree.h"
 #include "DiffservUtil.h"
 
 #include <algorithm>
+#include <typeinfo>
 
 using namespace DiffservUtil;
 
 #ifdef WITH_IPv4
-bool MultiFieldClassifier::Filter::matches(IPv4Datagram *datagram)
+bool MultiFieldClassifier::Filter::matches(IPv4Datagram *datagram) const
 {
     if (srcPrefixLength > 0 && (srcAddr.isIPv6() || !datagram->getSrcAddress().prefixMatches(srcAddr.get4(), srcPrefixLength)))
         return false;
@@ -56,24 +50,8 @@ bool MultiFieldClassifier::Filter::matches(IPv4Datagram *datagram)
         return false;
     if (srcPortMin >= 0 || destPortMin >= 0)
     {
-        int srcPort = -1, destPort = -1;
-        cPacket *packet = datagram->getEncapsulatedPacket();
-#ifdef WITH_UDP
-        UDPPacket *udpPacket = dynamic_cast<UDPPacket*>(packet);
-        if (udpPacket)
-        {
-            srcPort = udpPacket->getSourcePort();
-            destPort = udpPacket->getDestinationPort();
-        }
-#endif
-#ifdef WITH_TCP_COMMON
-        TCPSegment *tcpSegment = dynamic_cast<TCPSegment*>(packet);
-        if (tcpSegment)
-        {
-            srcPort = tcpSegment->getSrcPort();
-            destPort = tcpSegment->getDestPort();
-        }
-#endif
+        int srcPort, destPort;
+        getTransportPorts(datagram->getEncapsulatedPacket(), srcPort, destPort);
 
         if (srcPortMin >= 0 && (srcPort < srcPortMin || srcPort > srcPortMax))
             return false;
@@ -86,7 +64,7 @@ bool MultiFieldClassifier::Filter::matches(IPv4Datagram *datagram)
 #endif
 
 #ifdef WITH_IPv6
-bool MultiFieldClassifier::Filter::matches(IPv6Datagram *datagram)
+bool MultiFieldClassifier::Filter::matches(IPv6Datagram *datagram) const
 {
     if (srcPrefixLength > 0 && (!srcAddr.isIPv6() || !datagram->getSrcAddress().matches(srcAddr.get6(), srcPrefixLength)))
         return false;
@@ -98,24 +76,8 @@ bool MultiFieldClassifier::Filter::matches(IPv6Datagram *datagram)
         return false;
     if (srcPortMin >= 0 || destPortMin >= 0)
     {
-        int srcPort = -1, destPort = -1;
-        cPacket *packet = datagram->getEncapsulatedPacket();
-#ifdef WITH_UDP
-        UDPPacket *udpPacket = dynamic_cast<UDPPacket*>(packet);
-        if (udpPacket)
-        {
-            srcPort = udpPacket->getSourcePort();
-            destPort = udpPacket->getDestinationPort();
-        }
-#endif
-#ifdef WITH_TCP_COMMON
-        TCPSegment *tcpSegment = dynamic_cast<TCPSegment*>(packet);
-        if (tcpSegment)
-        {
-            srcPort = tcpSegment->getSrcPort();
-            destPort = tcpSegment->getDestPort();
-        }
-#endif
+        int srcPort, destPort;
+        getTransportPorts(datagram->getEncapsulatedPacket(), srcPort, destPort);
 
         if (srcPortMin >= 0 && (srcPort < srcPortMin || srcPort > srcPortMax))
             return false;
@@ -132,6 +94,10 @@ Define_Module(MultiFieldClassifier);
 
 simsignal_t MultiFieldClassifier::pkClassSignal = registerSignal("pkClass");
 
+MultiFieldClassifier::~MultiFieldClassifier()
+{
+    delete decisionTree;
+}
 
 void MultiFieldClassifier::initialize(int stage)
 {
@@ -141,11 +107,26 @@ void MultiFieldClassifier::initialize(int stage)
     {
         numRcvd = 0;
         WATCH(numRcvd);
+
+        const char *filterLookup = par("filterLookup");
+        if (!strcmp(filterLookup, "decisionTree"))
+            useDecisionTree = true;
+        else if (!strcmp(filterLookup, "linear"))
+            useDecisionTree = false;
+        else
+            error("Unknown filterLookup '%s', should be 'linear' or 'decisionTree'", filterLookup);
     }
     else if (stage == 3)
     {
         cXMLElement *config = par("filters").xmlValue();
         configureFilters(config);
+
+        // build the decision tree now rather than on the first packet
+        if (useDecisionTree)
+        {
+            MultiFieldDecisionTree *tree = getDecisionTree();
+            EV << "Built decision tree of " << tree->getNumNodes() << " nodes for " << filters.size() << " filters\n";
+        }
     }
 }
 
@@ -170,35 +151,67 @@ void MultiFieldClassifier::handleMessage(cMessage *msg)
     }
 }
 
+template <class Datagram>
+int MultiFieldClassifier::classifyDatagram(Datagram *datagram)
+{
+    if (useDecisionTree)
+    {
+        int index = getDecisionTree()->classify(datagram);
+        return index >= 0 ? filters[index].gateIndex : -1;
+    }
+    for (std::vector<Filter>::iterator it = filters.begin(); it != filters.end(); ++it)
+        if (it->matches(datagram))
+            return it->gateIndex;
+    return -1;
+}
+
 int MultiFieldClassifier::classifyPacket(cPacket *packet)
 {
+    // the classifier normally receives the datagram itself: testing its exact
+    // class is cheaper than dynamic_cast, so only other packets are searched
+    // for an encapsulated datagram
+#ifdef WITH_IPv4
+    if (typeid(*packet) == typeid(IPv4Datagram))
+        return classifyDatagram(static_cast<IPv4Datagram *>(packet));
+#endif
+#ifdef WITH_IPv6
+    if (typeid(*packet) == typeid(IPv6Datagram))
+        return classifyDatagram(static_cast<IPv6Datagram *>(packet));
+#endif
+
     for (; packet; packet = packet->getEncapsulatedPacket())
     {
 #ifdef WITH_IPv4
         IPv4Datagram *ipv4Datagram = dynamic_cast<IPv4Datagram*>(packet);
         if (ipv4Datagram)
-        {
-            for (std::vector<Filter>::iterator it = filters.begin(); it != filters.end(); ++it)
-                if (it->matches(ipv4Datagram))
-                    return it->gateIndex;
-            return -1;
-        }
+            return classifyDatagram(ipv4Datagram);
 #endif
 #ifdef WITH_IPv6
         IPv6Datagram *ipv6Datagram = dynamic_cast<IPv6Datagram *>(packet);
         if (ipv6Datagram)
-        {
-            for (std::vector<Filter>::iterator it = filters.begin(); it != filters.end(); ++it)
-                if (it->matches(ipv6Datagram))
-                    return it->gateIndex;
-            return -1;
-        }
+            return classifyDatagram(ipv6Datagram);
 #endif
     }
 
     return -1;
 }
 
+MultiFieldDecisionTree *MultiFieldClassifier::getDecisionTree()
+{
+    if (!decisionTree)
+    {
+        decisionTree = new MultiFieldDecisionTree();
+        decisionTree->build(filters);
+    }
+    return decisionTree;
+}
+
+void MultiFieldClassifier::invalidateDecisionTree()
+{
+    delete decisionTree;
+    decisionTree = NULL;
+}
+
 void MultiFieldClassifier::addFilter(const Filter &filter)
 {
     if (filter.gateIndex < 0 || filter.gateIndex >= gateSize("outs"))
@@ -229,16 +242,19 @@ void MultiFieldClassifier::addFilter(const Filter &filter)
         throw cRuntimeError("destPortMin > destPortMax");
 
     filters.push_back(filter);
+    invalidateDecisionTree();
 }
 
 void MultiFieldClassifier::clearFilters()
 {
     filters.clear();
+    invalidateDecisionTree();
 }
 
 void MultiFieldClassifier::removeFilter(const Filter &filter)
 {
-    std::remove(filters.begin(), filters.end(), filter);
+    filters.erase(std::remove(filters.begin(), filters.end(), filter), filters.end());
+    invalidateDecisionTree();
 }
 
 const std::vector<MultiFieldClassifier::Filter> & MultiFieldClassifier::getFilters()
@@ -22,6 +22,12 @@
 
 #include "INETDefs.h"
 
+#include "IPvXAddress.h"
+
+class IPv4Datagram;
+class IPv6Datagram;
+class MultiFieldDecisionTree;
+
 /**
  * Absolute dropper.
  */
@@ -48,10 +54,10 @@ class INET_API MultiFieldClassifier : public cSimpleModule
                        srcPrefixLength(0), destPrefixLength(0), protocol(-1), tos(0), tosMask(0),
                        srcPortMin(-1), srcPortMax(-1), destPortMin(-1), destPortMax(-1)  {}
     #ifdef WITH_IPv4
-            bool matches(IPv4Datagram *datagram);
+            bool matches(IPv4Datagram *datagram) const;
     #endif
     #ifdef WITH_IPv6
-            bool matches(IPv6Datagram *datagram);
+            bool matches(IPv6Datagram *datagram) const;
     #endif
 
             bool operator==(const Filter &other) const {
@@ -73,6 +79,8 @@ class INET_API MultiFieldClassifier : public cSimpleModule
 
   protected:
     std::vector<Filter> filters;
+    bool useDecisionTree;
+    MultiFieldDecisionTree *decisionTree;  // built from filters on demand, NULL if out of date
 
     int numRcvd;
 
@@ -82,7 +90,8 @@ class INET_API MultiFieldClassifier : public cSimpleModule
     void configureFilters(cXMLElement *config);
 
   public:
-    MultiFieldClassifier() {}
+    MultiFieldClassifier() : useDecisionTree(false), decisionTree(NULL) {}
+    virtual ~MultiFieldClassifier();
 
     void addFilter(const Filter &filter);
     void clearFilters();
@@ -97,6 +106,10 @@ class INET_API MultiFieldClassifier : public cSimpleModule
     virtual void handleMessage(cMessage *msg);
 
     virtual int classifyPacket(cPacket *packet);
+    template <class Datagram> int classifyDatagram(Datagram *datagram);
+
+    virtual MultiFieldDecisionTree *getDecisionTree();
+    virtual void invalidateDecisionTree();
 };
 
 #endif
@@ -0,0 +1,315 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "INETDefs.h"
+#include "IPvXAddress.h"
+
+#ifdef WITH_IPv4
+#include "IPv4Datagram.h"
+#endif
+
+#ifdef WITH_IPv6
+#include "IPv6Datagram.h"
+#endif
+
+#include "MultiFieldDecisionTree.h"
+#include "DiffservUtil.h"
+
+// addresses, protocol number, port + 1 (0 if the packet has no ports)
+const int MultiFieldDecisionTree::dimensionBits[NUM_DIMENSIONS] = {32, 32, 8, 17, 17};
+
+// nodes below this depth are leaves regardless of the number of their filters
+static const int MAX_DEPTH = 32;
+
+// an inner node has at most 2^MAX_CUT_BITS children
+static const int MAX_CUT_BITS = 8;
+
+MultiFieldDecisionTree::MultiFieldDecisionTree(int maxLeafSize, double spaceFactor) :
+    ipv4Root(NULL), ipv6Root(NULL), numNodes(0), numReferences(0), maxReferences(0), usesPorts(false),
+    maxLeafSize(maxLeafSize), spaceFactor(spaceFactor)
+{
+}
+
+MultiFieldDecisionTree::~MultiFieldDecisionTree()
+{
+    clear();
+}
+
+uint32 MultiFieldDecisionTree::getPrefixLo(uint32 address, int prefixLength)
+{
+    return prefixLength <= 0 ? 0 : address & (0xffffffffu << (32 - prefixLength));
+}
+
+uint32 MultiFieldDecisionTree::getPrefixHi(uint32 address, int prefixLength)
+{
+    return prefixLength <= 0 ? 0xffffffffu : address | ~(0xffffffffu << (32 - prefixLength));
+}
+
+void MultiFieldDecisionTree::setPortRange(Box& box, int dimension, int portMin, int portMax)
+{
+    if (portMin >= 0)
+    {
+        box.lo[dimension] = portValue(portMin);
+        box.hi[dimension] = portValue(portMax);
+    }
+    else
+    {
+        box.lo[dimension] = 0;
+        box.hi[dimension] = (1u << dimensionBits[dimension]) - 1;
+    }
+}
+
+bool MultiFieldDecisionTree::getBox(const Filter& filter, bool isIPv6, Box& box)
+{
+    // filters with an address of the other IP version never match (see Filter::matches())
+    const IPvXAddress *addresses[2] = {&filter.srcAddr, &filter.destAddr};
+    int prefixLengths[2] = {filter.srcPrefixLength, filter.destPrefixLength};
+    for (int i = 0; i < 2; i++)
+    {
+        int dimension = i == 0 ? SRC_ADDR : DEST_ADDR;
+        int prefixLength = prefixLengths[i];
+        uint32 address = 0;
+        if (prefixLength > 0)
+        {
+            if (addresses[i]->isIPv6() != isIPv6)
+                return false;
+            address = isIPv6 ? addresses[i]->get6().words()[0] : addresses[i]->get4().getInt();
+            prefixLength = std::min(prefixLength, 32);
+        }
+        box.lo[dimension] = getPrefixLo(address, prefixLength);
+        box.hi[dimension] = getPrefixHi(address, prefixLength);
+    }
+
+    box.lo[PROTOCOL] = filter.protocol >= 0 ? filter.protocol : 0;
+    box.hi[PROTOCOL] = filter.protocol >= 0 ? filter.protocol : 0xff;
+    setPortRange(box, SRC_PORT, filter.srcPortMin, filter.srcPortMax);
+    setPortRange(box, DEST_PORT, filter.destPortMin, filter.destPortMax);
+    return true;
+}
+
+void MultiFieldDecisionTree::build(const std::vector<Filter>& filters)
+{
+    clear();
+    this->filters = filters;
+    for (int i = 0; i < (int)filters.size(); i++)
+        if (filters[i].srcPortMin >= 0 || filters[i].destPortMin >= 0)
+            usesPorts = true;
+    maxReferences = (int)std::max(1000.0, 4 * spaceFactor * filters.size());
+    ipv4Root = buildTree(false);
+    ipv6Root = buildTree(true);
+    boxes.clear();
+}
+
+MultiFieldDecisionTree::Node *MultiFieldDecisionTree::buildTree(bool isIPv6)
+{
+    boxes.resize(filters.size());
+    std::vector<int> filterIndices;
+    for (int i = 0; i < (int)filters.size(); i++)
+        if (getBox(filters[i], isIPv6, boxes[i]))
+            filterIndices.push_back(i);
+
+    Region region;
+    for (int d = 0; d < NUM_DIMENSIONS; d++)
+    {
+        region.lo[d] = 0;
+        region.bits[d] = dimensionBits[d];
+    }
+    return buildNode(filterIndices, region, 0);
+}
+
+MultiFieldDecisionTree::Node *MultiFieldDecisionTree::buildNode(const std::vector<int>& filterIndices, const Region& region, int depth)
+{
+    Node *node = new Node();
+    numNodes++;
+
+    int dimension, cutBits;
+    if ((int)filterIndices.size() <= maxLeafSize || depth >= MAX_DEPTH || numReferences >= maxReferences ||
+        !chooseCut(filterIndices, region, dimension, cutBits))
+    {
+        node->filterIndices = filterIndices;
+        numReferences += filterIndices.size();
+        return node;
+    }
+
+    node->dimension = dimension;
+    node->lo = region.lo[dimension];
+    node->shift = region.bits[dimension] - cutBits;
+
+    Region childRegion = region;
+    childRegion.bits[dimension] = node->shift;
+    std::vector<int> previousIndices;
+    for (int i = 0; i < (1 << cutBits); i++)
+    {
+        uint32 lo = node->lo + ((uint32)i << node->shift);
+        uint32 hi = lo + (((uint32)1 << node->shift) - 1);
+        std::vector<int> childIndices;
+        for (std::vector<int>::const_iterator it = filterIndices.begin(); it != filterIndices.end(); ++it)
+            if (boxes[*it].lo[dimension] <= hi && boxes[*it].hi[dimension] >= lo)
+                childIndices.push_back(*it);
+
+        if (i > 0 && childIndices == previousIndices)
+            node->children.push_back(node->children.back());
+        else
+        {
+            childRegion.lo[dimension] = lo;
+            node->children.push_back(buildNode(childIndices, childRegion, depth + 1));
+            previousIndices.swap(childIndices);
+        }
+    }
+    return node;
+}
+
+bool MultiFieldDecisionTree::chooseCut(const std::vector<int>& filterIndices, const Region& region, int& bestDimension, int& bestCutBits) const
+{
+    // the cut whose largest child has the fewest filters; filters that
+    // overlap much (e.g. wildcards) are copied into every child, so a cut
+    // is only worth it if it makes the largest child notably smaller
+    int n = filterIndices.size();
+    int bestMaxChildSize = n;
+    bestDimension = -1;
+    for (int d = 0; d < NUM_DIMENSIONS; d++)
+    {
+        if (region.bits[d] == 0)
+            continue;
+        int cutBits = chooseNumCutBits(filterIndices, region, d);
+        int maxChildSize = getMaxChildSize(filterIndices, region, d, cutBits);
+        if (maxChildSize < bestMaxChildSize)
+        {
+            bestDimension = d;
+            bestCutBits = cutBits;
+            bestMaxChildSize = maxChildSize;
+        }
+    }
+    return bestDimension != -1 && 4 * bestMaxChildSize <= 3 * n;
+}
+
+int MultiFieldDecisionTree::getMaxChildSize(const std::vector<int>& filterIndices, const Region& region, int dimension, int cutBits) const
+{
+    uint32 regionLo = region.lo[dimension];
+    uint32 regionHi = regionLo + (uint32)((((uint64)1) << region.bits[dimension]) - 1);
+    int shift = region.bits[dimension] - cutBits;
+    std::vector<int> sizeChanges((1 << cutBits) + 1, 0);
+    for (std::vector<int>::const_iterator it = filterIndices.begin(); it != filterIndices.end(); ++it)
+    {
+        uint32 lo = std::max(boxes[*it].lo[dimension], regionLo) - regionLo;
+        uint32 hi = std::min(boxes[*it].hi[dimension], regionHi) - regionLo;
+        sizeChanges[lo >> shift]++;
+        sizeChanges[(hi >> shift) + 1]--;
+    }
+    int size = 0, maxSize = 0;
+    for (int i = 0; i < (1 << cutBits); i++)
+    {
+        size += sizeChanges[i];
+        maxSize = std::max(maxSize, size);
+    }
+    return maxSize;
+}
+
+int MultiFieldDecisionTree::chooseNumCutBits(const std::vector<int>& filterIndices, const Region& region, int dimension) const
+{
+    // double the number of cuts while the number of filter references in the children stays below spaceFactor * n
+    uint32 regionLo = region.lo[dimension];
+    uint32 regionHi = regionLo + (uint32)((((uint64)1) << region.bits[dimension]) - 1);
+    int cutBits = 1;
+    while (cutBits < region.bits[dimension] && cutBits < MAX_CUT_BITS)
+    {
+        int shift = region.bits[dimension] - (cutBits + 1);
+        double cost = 1 << (cutBits + 1);
+        for (std::vector<int>::const_iterator it = filterIndices.begin(); it != filterIndices.end(); ++it)
+        {
+            uint32 lo = std::max(boxes[*it].lo[dimension], regionLo) - regionLo;
+            uint32 hi = std::min(boxes[*it].hi[dimension], regionHi) - regionLo;
+            cost += (hi >> shift) - (lo >> shift) + 1;
+        }
+        if (cost > spaceFactor * filterIndices.size())
+            break;
+        cutBits++;
+    }
+    return cutBits;
+}
+
+void MultiFieldDecisionTree::deleteNode(Node *node)
+{
+    for (int i = 0; i < (int)node->children.size(); i++)
+        if (i == 0 || node->children[i] != node->children[i - 1])
+            deleteNode(node->children[i]);
+    delete node;
+}
+
+void MultiFieldDecisionTree::clear()
+{
+    if (ipv4Root)
+        deleteNode(ipv4Root);
+    if (ipv6Root)
+        deleteNode(ipv6Root);
+    ipv4Root = ipv6Root = NULL;
+    numNodes = 0;
+    numReferences = 0;
+    usesPorts = false;
+    filters.clear();
+}
+
+template <class Datagram>
+int MultiFieldDecisionTree::findMatchingFilter(const Node *root, const uint32 *key, Datagram *datagram) const
+{
+    const Node *node = root;
+    while (node->dimension != -1)
+        node = node->children[(key[node->dimension] - node->lo) >> node->shift];
+    for (std::vector<int>::const_iterator it = node->filterIndices.begin(); it != node->filterIndices.end(); ++it)
+        if (filters[*it].matches(datagram))
+            return *it;
+    return -1;
+}
+
+void MultiFieldDecisionTree::getPortKeys(cPacket *transportPacket, uint32 *key) const
+{
+    // out of range values are folded into the range of the dimension: only
+    // wildcard filters match them, and those are in every leaf
+    int srcPort = -1, destPort = -1;
+    if (usesPorts)
+        DiffservUtil::getTransportPorts(transportPacket, srcPort, destPort);
+    key[SRC_PORT] = portValue(srcPort) & ((1u << dimensionBits[SRC_PORT]) - 1);
+    key[DEST_PORT] = portValue(destPort) & ((1u << dimensionBits[DEST_PORT]) - 1);
+}
+
+#ifdef WITH_IPv4
+int MultiFieldDecisionTree::classify(IPv4Datagram *datagram) const
+{
+    if (!ipv4Root)
+        return -1;
+    uint32 key[NUM_DIMENSIONS];
+    key[SRC_ADDR] = datagram->getSrcAddress().getInt();
+    key[DEST_ADDR] = datagram->getDestAddress().getInt();
+    key[PROTOCOL] = datagram->getTransportProtocol() & 0xff;  // folded like ports
+    getPortKeys(datagram->getEncapsulatedPacket(), key);
+    return findMatchingFilter(ipv4Root, key, datagram);
+}
+#endif
+
+#ifdef WITH_IPv6
+int MultiFieldDecisionTree::classify(IPv6Datagram *datagram) const
+{
+    if (!ipv6Root)
+        return -1;
+    uint32 key[NUM_DIMENSIONS];
+    key[SRC_ADDR] = datagram->getSrcAddress().words()[0];
+    key[DEST_ADDR] = datagram->getDestAddress().words()[0];
+    key[PROTOCOL] = datagram->getTransportProtocol() & 0xff;  // folded like ports
+    getPortKeys(datagram->getEncapsulatedPacket(), key);
+    return findMatchingFilter(ipv6Root, key, datagram);
+}
+#endif
@@ -0,0 +1,137 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_MULTIFIELDDECISIONTREE_H
+#define __INET_MULTIFIELDDECISIONTREE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "MultiFieldClassifier.h"
+
+/**
+ * Decision tree over the filters of MultiFieldClassifier (HiCuts, Gupta and
+ * McKeown 1999). Each inner node cuts the range of one packet field (source
+ * and destination address, protocol, source and destination port) into
+ * equal parts; each leaf lists the filters that may match packets in its
+ * region, in their original order. classify() walks down to the leaf of the
+ * packet and tests only those filters with Filter::matches(), so it returns
+ * the same filter as a linear search of the filter list.
+ *
+ * Filters that overlap in every field (e.g. wildcards) are copied into every
+ * child, so a node is only cut if its largest child gets at most 3/4 of its
+ * filters, and cutting stops when the leaves hold 4 * spaceFactor times as
+ * many filter references as there are filters; such filters just make the
+ * leaves longer.
+ *
+ * IPv4 and IPv6 datagrams have separate trees; for IPv6 addresses only the
+ * most significant 32 bits are cut on. The ToS/traffic class is only checked
+ * in the leaves.
+ */
+class INET_API MultiFieldDecisionTree
+{
+  public:
+    typedef MultiFieldClassifier::Filter Filter;
+
+  protected:
+    enum Dimension {SRC_ADDR, DEST_ADDR, PROTOCOL, SRC_PORT, DEST_PORT, NUM_DIMENSIONS};
+
+    struct Node
+    {
+        int dimension;   // -1 for leaves
+        uint32 lo;       // start of the range of the node in dimension
+        int shift;       // child index is (value - lo) >> shift
+        std::vector<Node *> children;  // adjacent children with the same filters are shared
+        std::vector<int> filterIndices;  // leaves only, in ascending order
+
+        Node() : dimension(-1), lo(0), shift(0) {}
+    };
+
+    struct Box
+    {
+        uint32 lo[NUM_DIMENSIONS];
+        uint32 hi[NUM_DIMENSIONS];
+    };
+
+    struct Region
+    {
+        uint32 lo[NUM_DIMENSIONS];
+        int bits[NUM_DIMENSIONS];  // the region is lo..lo+2^bits-1
+    };
+
+    std::vector<Filter> filters;
+    std::vector<Box> boxes;  // filter ranges of the tree being built
+    Node *ipv4Root;
+    Node *ipv6Root;
+    int numNodes;
+    int numReferences;  // total length of the filter lists of the leaves
+    int maxReferences;  // no more cuts are made above this
+    bool usesPorts;     // whether any filter has ports
+    int maxLeafSize;    // binth of HiCuts
+    double spaceFactor; // spfac of HiCuts
+
+  protected:
+    static const int dimensionBits[NUM_DIMENSIONS];
+    static uint32 getPrefixLo(uint32 address, int prefixLength);
+    static uint32 getPrefixHi(uint32 address, int prefixLength);
+    static uint32 portValue(int port) {return port + 1;}  // 0 means no port
+    static void setPortRange(Box& box, int dimension, int portMin, int portMax);
+    static bool getBox(const Filter& filter, bool isIPv6, Box& box);
+
+    Node *buildTree(bool isIPv6);
+    Node *buildNode(const std::vector<int>& filterIndices, const Region& region, int depth);
+    bool chooseCut(const std::vector<int>& filterIndices, const Region& region, int& dimension, int& cutBits) const;
+    int getMaxChildSize(const std::vector<int>& filterIndices, const Region& region, int dimension, int cutBits) const;
+    int chooseNumCutBits(const std::vector<int>& filterIndices, const Region& region, int dimension) const;
+    void deleteNode(Node *node);
+    void getPortKeys(cPacket *transportPacket, uint32 *key) const;
+    template <class Datagram> int findMatchingFilter(const Node *root, const uint32 *key, Datagram *datagram) const;
+
+  private:
+    MultiFieldDecisionTree(const MultiFieldDecisionTree&);  // not copyable
+    MultiFieldDecisionTree& operator=(const MultiFieldDecisionTree&);
+
+  public:
+    MultiFieldDecisionTree(int maxLeafSize = 8, double spaceFactor = 4);
+    ~MultiFieldDecisionTree();
+
+    /**
+     * Builds the trees for the given filter list, replacing the previous ones.
+     */
+    void build(const std::vector<Filter>& filters);
+
+    /**
+     * Deletes the trees; classify() returns -1 until the next build().
+     */
+    void clear();
+
+#ifdef WITH_IPv4
+    /**
+     * Returns the index of the first filter matching the datagram, or -1.
+     */
+    int classify(IPv4Datagram *datagram) const;
+#endif
+#ifdef WITH_IPv6
+    /**
+     * Returns the index of the first filter matching the datagram, or -1.
+     */
+    int classify(IPv6Datagram *datagram) const;
+#endif
+
+    int getNumNodes() const {return numNodes;}
+};
+
+#endif
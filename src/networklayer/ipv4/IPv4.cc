@@ -53,6 +53,7 @@ void IPv4::initialize(int stage)
 
         ift = InterfaceTableAccess().get();
         rt = check_and_cast<IRoutingTable *>(getModuleByPath(par("routingTableModule")));
+        rtFastPath = rt->getFastPath();
         nb = NotificationBoardAccess().getIfExists(); // needed only for multicast forwarding
 
         arpInGate = gate("arpIn");
@@ -76,6 +77,7 @@ void IPv4::initialize(int stage)
 
         // NetFilter:
         hooks.clear();
+        updateHooksByType();
         queuedDatagramsForHooks.clear();
 
         pendingPackets.clear();
@@ -197,7 +199,7 @@ void IPv4::preroutingFinish(IPv4Datagram *datagram, const InterfaceEntry *fromIE
 
     // handle router alert option field -> This ist handled only on intermediate routers and not on the endpoints
     //  also the packet is not handled again if it returns from the router alert handler
-    if ((!datagram->getArrivalGate()->isName("routerAlertReturn")) && !(rt->isLocalAddress(destAddr)) && datagram->getOptionCode() == IPOPTION_ROUTER_ALERT)  // FIXME If the option code handling is changed to support multiple options, we have to change this here too
+    if ((!datagram->getArrivalGate()->isName("routerAlertReturn")) && !(rtFastPath->isLocalAddress(destAddr)) && datagram->getOptionCode() == IPOPTION_ROUTER_ALERT)  // FIXME If the option code handling is changed to support multiple options, we have to change this here too
     {
         // send the datagram to the router alert gate
         cGate *rout = gate("routerAlertOut");
@@ -245,11 +247,11 @@ void IPv4::preroutingFinish(IPv4Datagram *datagram, const InterfaceEntry *fromIE
 
         // check for local delivery; we must accept also packets coming from the interfaces that
         // do not yet have an IP address assigned. This happens during DHCP requests.
-        if (rt->isLocalAddress(destAddr) || fromIE->ipv4Data()->getIPAddress().isUnspecified())
+        if (rtFastPath->isLocalAddress(destAddr) || fromIE->ipv4Data()->getIPAddress().isUnspecified())
         {
             reassembleAndDeliver(datagram);
         }
-        else if (destAddr.isLimitedBroadcastAddress() || (broadcastIE=rt->findInterfaceByLocalBroadcastAddress(destAddr)))
+        else if (destAddr.isLimitedBroadcastAddress() || (broadcastIE=rtFastPath->findInterfaceByLocalBroadcastAddress(destAddr)))
         {
             // broadcast datagram on the target subnet if we are a router
             if (broadcastIE && fromIE != broadcastIE && rt->isIPForwardingEnabled())
@@ -386,7 +388,7 @@ void IPv4::datagramLocalOut(IPv4Datagram* datagram, const InterfaceEntry* destIE
     else // unicast and broadcast
     {
         // check for local delivery
-        if (rt->isLocalAddress(destAddr))
+        if (rtFastPath->isLocalAddress(destAddr))
         {
             EV << "local delivery\n";
             if (destIE && !destIE->isLoopback())
@@ -399,7 +401,7 @@ void IPv4::datagramLocalOut(IPv4Datagram* datagram, const InterfaceEntry* destIE
             ASSERT(destIE);
             routeUnicastPacket(datagram, NULL, destIE, destAddr);
         }
-        else if (destAddr.isLimitedBroadcastAddress() || rt->isLocalBroadcastAddress(destAddr))
+        else if (destAddr.isLimitedBroadcastAddress() || rtFastPath->isLocalBroadcastAddress(destAddr))
             routeLocalBroadcastPacket(datagram, destIE);
         else
             routeUnicastPacket(datagram, NULL, destIE, requestedNextHopAddress);
@@ -422,7 +424,7 @@ const InterfaceEntry *IPv4::determineOutgoingInterfaceForMulticastDatagram(IPv4D
     }
     if (!ie)
     {
-        IPv4Route *route = rt->findBestMatchingRoute(datagram->getDestAddress());
+        IPv4Route *route = rtFastPath->findBestMatchingRoute(datagram->getDestAddress());
         if (route)
             ie = route->getInterface();
         if (ie)
@@ -430,7 +432,7 @@ const InterfaceEntry *IPv4::determineOutgoingInterfaceForMulticastDatagram(IPv4D
     }
     if (!ie)
     {
-        ie = rt->getInterfaceByAddress(datagram->getSrcAddress());
+        ie = rtFastPath->getInterfaceByAddress(datagram->getSrcAddress());
         if (ie)
             EV << "multicast packet routed by source address via output interface " << ie->getName() << "\n";
     }
@@ -462,7 +464,7 @@ void IPv4::routeUnicastPacket(IPv4Datagram *datagram, const InterfaceEntry *from
         else if (destIE->isBroadcast())
         {
             // if the interface is broadcast we must search the next hop
-            const IPv4Route *re = rt->findBestMatchingRoute(destAddr);
+            const IPv4Route *re = rtFastPath->findBestMatchingRoute(destAddr);
             if (re && re->getInterface() == destIE)
                 nextHopAddr = re->getGateway();
         }
@@ -470,7 +472,7 @@ void IPv4::routeUnicastPacket(IPv4Datagram *datagram, const InterfaceEntry *from
     else
     {
         // use IPv4 routing (lookup in routing table)
-        const IPv4Route *re = rt->findBestMatchingRoute(destAddr);
+        const IPv4Route *re = rtFastPath->findBestMatchingRoute(destAddr);
         if (re)
         {
             destIE = re->getInterface();
@@ -531,7 +533,7 @@ void IPv4::routeLocalBroadcastPacket(IPv4Datagram *datagram, const InterfaceEntr
 
 const InterfaceEntry *IPv4::getShortestPathInterfaceToSource(IPv4Datagram *datagram)
 {
-    return rt->getInterfaceForDestAddr(datagram->getSrcAddress());
+    return rtFastPath->getInterfaceForDestAddr(datagram->getSrcAddress());
 }
 
 void IPv4::forwardMulticastPacket(IPv4Datagram *datagram, const InterfaceEntry *fromIE)
@@ -546,14 +548,14 @@ void IPv4::forwardMulticastPacket(IPv4Datagram *datagram, const InterfaceEntry *
 
     numMulticast++;
 
-    const IPv4MulticastRoute *route = rt->findBestMatchingMulticastRoute(srcAddr, destAddr);
+    const IPv4MulticastRoute *route = rtFastPath->findBestMatchingMulticastRoute(srcAddr, destAddr);
     if (!route)
     {
         EV << "Multicast route does not exist, try to add.\n";
         nb->fireChangeNotification(NF_IPv4_NEW_MULTICAST, datagram);
 
         // read new record
-        route = rt->findBestMatchingMulticastRoute(srcAddr, destAddr);
+        route = rtFastPath->findBestMatchingMulticastRoute(srcAddr, destAddr);
 
         if (!route)
         {
@@ -809,7 +811,7 @@ IPv4Datagram *IPv4::encapsulate(cPacket *transportPacket, IPv4ControlInfo *contr
     if (!src.isUnspecified())
     {
         // if interface parameter does not match existing interface, do not send datagram
-        if (rt->getInterfaceByAddress(src)==NULL)
+        if (rtFastPath->getInterfaceByAddress(src)==NULL)
             throw cRuntimeError("Wrong source address %s in (%s)%s: no interface with such address",
                       src.str().c_str(), transportPacket->getClassName(), transportPacket->getFullName());
 
@@ -957,20 +959,39 @@ void IPv4::sendPacketToNIC(cPacket *packet, const InterfaceEntry *ie)
 void IPv4::registerHook(int priority, INetfilter::IHook* hook)
 {
     Enter_Method("registerHook()");
-    hooks.insert(std::pair<int, INetfilter::IHook*>(priority, hook));
+    HookList::iterator iter = hooks.begin();
+    while (iter != hooks.end() && iter->priority <= priority)
+        ++iter;
+    RegisteredHook registeredHook;
+    registeredHook.priority = priority;
+    registeredHook.hook = hook;
+    hooks.insert(iter, registeredHook);
+    updateHooksByType();
 }
 
 void IPv4::unregisterHook(int priority, INetfilter::IHook* hook)
 {
     Enter_Method("unregisterHook()");
     for (HookList::iterator iter = hooks.begin(); iter != hooks.end(); iter++) {
-        if ((iter->first == priority) && (iter->second == hook)) {
+        if ((iter->priority == priority) && (iter->hook == hook)) {
             hooks.erase(iter);
+            updateHooksByType();
             return;
         }
     }
 }
 
+void IPv4::updateHooksByType()
+{
+    for (int type = 0; type <= INetfilter::IHook::LOCALOUT; type++)
+    {
+        hooksByType[type].clear();
+        for (HookList::iterator iter = hooks.begin(); iter != hooks.end(); iter++)
+            if (iter->hook->isHookTypeUsed((INetfilter::IHook::Type)type))
+                hooksByType[type].push_back(iter->hook);
+    }
+}
+
 void IPv4::dropQueuedDatagram(const IPv4Datagram* datagram)
 {
     Enter_Method("dropQueuedDatagram()");
@@ -1018,8 +1039,9 @@ void IPv4::reinjectQueuedDatagram(const IPv4Datagram* datagram)
 
 INetfilter::IHook::Result IPv4::datagramPreRoutingHook(IPv4Datagram* datagram, const InterfaceEntry* inIE, const InterfaceEntry*& outIE, IPv4Address& nextHopAddr)
 {
-    for (HookList::iterator iter = hooks.begin(); iter != hooks.end(); iter++) {
-        IHook::Result r = iter->second->datagramPreRoutingHook(datagram, inIE, outIE, nextHopAddr);
+    const HookVector& typeHooks = hooksByType[INetfilter::IHook::PREROUTING];
+    for (unsigned int i = 0; i < typeHooks.size(); i++) {
+        IHook::Result r = typeHooks[i]->datagramPreRoutingHook(datagram, inIE, outIE, nextHopAddr);
         switch(r)
         {
             case INetfilter::IHook::ACCEPT: break;   // continue iteration
@@ -1034,8 +1056,9 @@ INetfilter::IHook::Result IPv4::datagramPreRoutingHook(IPv4Datagram* datagram, c
 
 INetfilter::IHook::Result IPv4::datagramForwardHook(IPv4Datagram* datagram, const InterfaceEntry* inIE, const InterfaceEntry*& outIE, IPv4Address& nextHopAddr)
 {
-    for (HookList::iterator iter = hooks.begin(); iter != hooks.end(); iter++) {
-        IHook::Result r = iter->second->datagramForwardHook(datagram, inIE, outIE, nextHopAddr);
+    const HookVector& typeHooks = hooksByType[INetfilter::IHook::FORWARD];
+    for (unsigned int i = 0; i < typeHooks.size(); i++) {
+        IHook::Result r = typeHooks[i]->datagramForwardHook(datagram, inIE, outIE, nextHopAddr);
         switch(r)
         {
             case INetfilter::IHook::ACCEPT: break;   // continue iteration
@@ -1050,8 +1073,9 @@ INetfilter::IHook::Result IPv4::datagramForwardHook(IPv4Datagram* datagram, cons
 
 INetfilter::IHook::Result IPv4::datagramPostRoutingHook(IPv4Datagram* datagram, const InterfaceEntry* inIE, const InterfaceEntry*& outIE, IPv4Address& nextHopAddr)
 {
-    for (HookList::iterator iter = hooks.begin(); iter != hooks.end(); iter++) {
-        IHook::Result r = iter->second->datagramPostRoutingHook(datagram, inIE, outIE, nextHopAddr);
+    const HookVector& typeHooks = hooksByType[INetfilter::IHook::POSTROUTING];
+    for (unsigned int i = 0; i < typeHooks.size(); i++) {
+        IHook::Result r = typeHooks[i]->datagramPostRoutingHook(datagram, inIE, outIE, nextHopAddr);
         switch(r)
         {
             case INetfilter::IHook::ACCEPT: break;   // continue iteration
@@ -1109,8 +1133,9 @@ bool IPv4::isNodeUp()
 
 INetfilter::IHook::Result IPv4::datagramLocalInHook(IPv4Datagram* datagram, const InterfaceEntry* inIE)
 {
-    for (HookList::iterator iter = hooks.begin(); iter != hooks.end(); iter++) {
-        IHook::Result r = iter->second->datagramLocalInHook(datagram, inIE);
+    const HookVector& typeHooks = hooksByType[INetfilter::IHook::LOCALIN];
+    for (unsigned int i = 0; i < typeHooks.size(); i++) {
+        IHook::Result r = typeHooks[i]->datagramLocalInHook(datagram, inIE);
         switch(r)
         {
             case INetfilter::IHook::ACCEPT: break;   // continue iteration
@@ -1125,8 +1150,9 @@ INetfilter::IHook::Result IPv4::datagramLocalInHook(IPv4Datagram* datagram, cons
 
 INetfilter::IHook::Result IPv4::datagramLocalOutHook(IPv4Datagram* datagram, const InterfaceEntry*& outIE, IPv4Address& nextHopAddr)
 {
-    for (HookList::iterator iter = hooks.begin(); iter != hooks.end(); iter++) {
-        IHook::Result r = iter->second->datagramLocalOutHook(datagram, outIE, nextHopAddr);
+    const HookVector& typeHooks = hooksByType[INetfilter::IHook::LOCALOUT];
+    for (unsigned int i = 0; i < typeHooks.size(); i++) {
+        IHook::Result r = typeHooks[i]->datagramLocalOutHook(datagram, outIE, nextHopAddr);
         switch(r)
         {
             case INetfilter::IHook::ACCEPT: break;   // continue iteration
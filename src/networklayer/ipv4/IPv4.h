@@ -35,6 +35,7 @@ class ARPPacket;
 class ICMPMessage;
 class IInterfaceTable;
 class IRoutingTable;
+class IRoutingTableFastPath;
 class NotificationBoard;
 
 /**
@@ -65,6 +66,7 @@ class INET_API IPv4 : public QueueBase, public INetfilter, public ILifecycle, pu
     static simsignal_t failedARPResolutionSignal;
 
     IRoutingTable *rt;
+    const IRoutingTableFastPath *rtFastPath;  // for the queries on the per-packet path
     IInterfaceTable *ift;
     NotificationBoard *nb;
     IARPCache *arp;
@@ -99,8 +101,17 @@ class INET_API IPv4 : public QueueBase, public INetfilter, public ILifecycle, pu
     int numForwarded;
 
     // hooks
-    typedef std::multimap<int, IHook*> HookList;
-    HookList hooks;
+    struct RegisteredHook
+    {
+        int priority;
+        IHook *hook;
+    };
+    typedef std::vector<RegisteredHook> HookList;
+    HookList hooks;  // in ascending priority order, in registration order among equal priorities
+    // for each hook type, the hooks that use it (see IHook::isHookTypeUsed()), in the same order;
+    // with no hooks, a hook point costs a single emptiness check
+    typedef std::vector<IHook *> HookVector;
+    HookVector hooksByType[IHook::LOCALOUT + 1];
     typedef std::list<QueuedDatagramForHook> DatagramQueueForHooks;
     DatagramQueueForHooks queuedDatagramsForHooks;
 
@@ -230,7 +241,7 @@ class INET_API IPv4 : public QueueBase, public INetfilter, public ILifecycle, pu
     virtual void sendPacketToNIC(cPacket *packet, const InterfaceEntry *ie);
 
   public:
-    IPv4() { rt = NULL; ift = NULL; arp = NULL; arpOutGate = NULL; }
+    IPv4() { rt = NULL; rtFastPath = NULL; ift = NULL; arp = NULL; arpOutGate = NULL; }
 
   protected:
     virtual int numInitStages() const { return 2; }
@@ -245,6 +256,11 @@ class INET_API IPv4 : public QueueBase, public INetfilter, public ILifecycle, pu
 
     // NetFilter functions:
   protected:
+    /**
+     * rebuilds hooksByType from hooks
+     */
+    void updateHooksByType();
+
     /**
      * called before a packet arriving from the network is routed
      */
@@ -32,13 +32,8 @@ IPv4FragBuf::IPv4FragBuf()
 
 IPv4FragBuf::~IPv4FragBuf()
 {
-    while (!bufs.empty())
-    {
-        if (bufs.begin()->second.datagram)
-            delete bufs.begin()->second.datagram;
-
-        bufs.erase(bufs.begin());
-    }
+    for (DatagramBuffer *buf = bufs.getOldest(); buf; buf = buf->next)
+        delete buf->datagram;
 }
 
 void IPv4FragBuf::init(ICMP *icmp)
@@ -54,20 +49,12 @@ IPv4Datagram *IPv4FragBuf::addFragment(IPv4Datagram *datagram, simtime_t now)
     key.src = datagram->getSrcAddress();
     key.dest = datagram->getDestAddress();
 
-    Buffers::iterator i = bufs.find(key);
-
-    DatagramBuffer *buf = NULL;
+    DatagramBuffer *buf = bufs.find(key);
 
-    if (i == bufs.end())
+    if (buf == NULL)
     {
         // this is the first fragment of that datagram, create reassembly buffer for it
-        buf = &bufs[key];
-        buf->datagram = NULL;
-    }
-    else
-    {
-        // use existing buffer
-        buf = &(i->second);
+        buf = bufs.add(key, now);
     }
 
     // add fragment into reassembly buffer
@@ -101,45 +88,34 @@ IPv4Datagram *IPv4FragBuf::addFragment(IPv4Datagram *datagram, simtime_t now)
         ret->setByteLength(ret->getHeaderLength()+buf->buf.getTotalLength());
         ret->setFragmentOffset(0);
         ret->setMoreFragments(false);
-        bufs.erase(i);
+        bufs.remove(buf);
         return ret;
     }
     else
     {
         // there are still missing fragments
-        buf->lastupdate = now;
+        bufs.touch(buf, now);
         return NULL;
     }
 }
 
 void IPv4FragBuf::purgeStaleFragments(simtime_t lastupdate)
 {
-    // this method shouldn't be called too often because iteration on
-    // an std::map is *very* slow...
-
     ASSERT(icmpModule);
 
-    for (Buffers::iterator i = bufs.begin(); i != bufs.end(); )
+    // buffers are in last update order, so only the stale ones are visited
+    while (bufs.getOldest() && bufs.getOldest()->time < lastupdate)
     {
-        // if too old, remove it
-        DatagramBuffer& buf = i->second;
-        if (buf.lastupdate < lastupdate)
-        {
-            // send ICMP error.
-            // Note: receiver MUST NOT call decapsulate() on the datagram fragment,
-            // because its length (being a fragment) is smaller than the encapsulated
-            // packet, resulting in "length became negative" error. Use getEncapsulatedPacket().
-            EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
-            icmpModule->sendErrorMessage(buf.datagram, -1 /*TODO*/, ICMP_TIME_EXCEEDED, 0);
-
-            // delete
-            Buffers::iterator oldi = i++;
-            bufs.erase(oldi);
-        }
-        else
-        {
-            ++i;
-        }
+        DatagramBuffer *buf = bufs.getOldest();
+
+        // send ICMP error.
+        // Note: receiver MUST NOT call decapsulate() on the datagram fragment,
+        // because its length (being a fragment) is smaller than the encapsulated
+        // packet, resulting in "length became negative" error. Use getEncapsulatedPacket().
+        EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
+        icmpModule->sendErrorMessage(buf->datagram, -1 /*TODO*/, ICMP_TIME_EXCEEDED, 0);
+
+        // delete
+        bufs.remove(buf);
     }
 }
-
@@ -19,12 +19,10 @@
 #define __INET_IPv4FRAGBUF_H
 
 
-#include <map>
-
 #include "INETDefs.h"
 
 #include "IPv4Address.h"
-#include "ReassemblyBuffer.h"
+#include "ReassemblyTable.h"
 
 
 class ICMP;
@@ -46,23 +44,19 @@ class INET_API IPv4FragBuf
         IPv4Address src;
         IPv4Address dest;
 
-        inline bool operator<(const Key& b) const {
-            return (id!=b.id) ? (id<b.id) : (src!=b.src) ? (src<b.src) : (dest<b.dest);
+        inline bool operator==(const Key& b) const {
+            return id==b.id && src==b.src && dest==b.dest;
+        }
+        inline uint32 hash() const {
+            uint32 h = (src.getInt() * 31 + dest.getInt()) * 31 + id;
+            return h ^ (h >> 16);
         }
     };
 
-    //
-    // Reassembly buffer for the datagram
-    //
-    struct DatagramBuffer
-    {
-        ReassemblyBuffer buf;  // reassembly buffer
-        IPv4Datagram *datagram;  // the actual datagram
-        simtime_t lastupdate;  // last time a new fragment arrived
-    };
-
-    // we use std::map for fast lookup by datagram Id
-    typedef std::map<Key,DatagramBuffer> Buffers;
+    // we use a hash table for fast lookup by datagram Id; the reassembly
+    // buffers are kept in last update order, so stale ones are at the front
+    typedef ReassemblyTable<Key,IPv4Datagram> Buffers;
+    typedef Buffers::Entry DatagramBuffer;  // time: last time a new fragment arrived
 
     // the reassembly buffers
     Buffers bufs;
@@ -0,0 +1,83 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "IPv4RouteTrie.h"
+
+#include "IPv4Route.h"
+
+
+// same order as RoutingTable::routeLessThan() for routes with the same destination/netmask
+bool IPv4RouteTrie::routeLessThan(const IPv4Route *a, const IPv4Route *b)
+{
+    if (a->getAdminDist() != b->getAdminDist())
+        return a->getAdminDist() < b->getAdminDist();
+    return a->getMetric() < b->getMetric();
+}
+
+IPv4RouteTrie::Trie::Node *IPv4RouteTrie::findNodeOfRoute(Trie::Node *node, const IPv4Route *route) const
+{
+    if (!node)
+        return NULL;
+    if (std::find(node->data.begin(), node->data.end(), route) != node->data.end())
+        return node;
+    Trie::Node *result = findNodeOfRoute(node->children[0], route);
+    return result ? result : findNodeOfRoute(node->children[1], route);
+}
+
+void IPv4RouteTrie::addRoute(IPv4Route *route)
+{
+    int length = route->getNetmask().getNetmaskLength();
+    RouteVector& routes = trie.findOrCreateNode(IPv4PrefixTraits::getPrefix(route->getDestination(), length), length)->data;
+    routes.insert(std::upper_bound(routes.begin(), routes.end(), route, routeLessThan), route);
+    numRoutes++;
+}
+
+bool IPv4RouteTrie::removeRoute(IPv4Route *route)
+{
+    int length = route->getNetmask().getNetmaskLength();
+    Trie::Node *node = trie.findNode(IPv4PrefixTraits::getPrefix(route->getDestination(), length), length);
+    RouteVector::iterator it;
+    if (!node || (it = std::find(node->data.begin(), node->data.end(), route)) == node->data.end())
+    {
+        // the destination or netmask of the route has been changed since it was added
+        node = findNodeOfRoute(trie.getRoot(), route);
+        if (!node)
+            return false;
+        it = std::find(node->data.begin(), node->data.end(), route);
+    }
+    node->data.erase(it);
+    numRoutes--;
+    trie.removeNodeIfUnused(node);
+    return true;
+}
+
+IPv4Route *IPv4RouteTrie::findBestMatchingRoute(const IPv4Address& dest) const
+{
+    IPv4Route *bestRoute = NULL;
+    for (const Trie::Node *node = trie.getRoot(); node; node = trie.getMatchingChild(node, dest))
+    {
+        for (RouteVector::const_iterator it = node->data.begin(); it != node->data.end(); ++it)
+        {
+            if ((*it)->isValid())
+            {
+                bestRoute = *it;
+                break;
+            }
+        }
+    }
+    return bestRoute;
+}
@@ -0,0 +1,84 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IPv4ROUTETRIE_H
+#define __INET_IPv4ROUTETRIE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "IPv4Address.h"
+#include "PrefixTrie.h"
+
+class IPv4Route;
+
+/**
+ * Longest prefix match index over IPv4 unicast routes, keyed by
+ * destination/netmask (see PrefixTrie).
+ *
+ * Routes with the same prefix are kept in their node in ascending
+ * administrative distance / metric order (and in insertion order among
+ * equals), which is the order RoutingTable keeps them in.
+ *
+ * findBestMatchingRoute() returns the first valid route of the longest
+ * matching prefix that has a valid route, i.e. the same route as the linear
+ * scan of the sorted route vector in RoutingTable. The routes are not owned.
+ *
+ * @see RoutingTable
+ */
+class INET_API IPv4RouteTrie
+{
+  protected:
+    typedef std::vector<IPv4Route *> RouteVector;  // routes with exactly the same prefix
+    typedef PrefixTrie<IPv4Address, RouteVector, IPv4PrefixTraits> Trie;
+
+    Trie trie;
+    int numRoutes;
+
+  protected:
+    static bool routeLessThan(const IPv4Route *a, const IPv4Route *b);
+    Trie::Node *findNodeOfRoute(Trie::Node *node, const IPv4Route *route) const;
+
+  public:
+    IPv4RouteTrie() : numRoutes(0) {}
+
+    /**
+     * Adds a route; its netmask must be a valid (contiguous) netmask.
+     */
+    void addRoute(IPv4Route *route);
+
+    /**
+     * Removes the route and returns true if it was found. The route is also
+     * found if its destination or netmask has been changed after it was added.
+     */
+    bool removeRoute(IPv4Route *route);
+
+    /**
+     * Removes all routes.
+     */
+    void clear() {trie.clear(); numRoutes = 0;}
+
+    /**
+     * Returns the first valid route with the longest prefix matching dest,
+     * or NULL if there is none.
+     */
+    IPv4Route *findBestMatchingRoute(const IPv4Address& dest) const;
+
+    int getNumRoutes() const {return numRoutes;}
+    int getNumNodes() const {return trie.getNumNodes();}
+};
+
+#endif
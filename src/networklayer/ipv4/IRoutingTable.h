@@ -24,6 +24,7 @@
 
 #include "IPv4Address.h"
 #include "IPv4Route.h"  // not strictly required, but most clients will need it anyway
+#include "IRoutingTableFastPath.h"
 
 /**
  * A C++ interface to abstract the functionality of IRoutingTable.
@@ -127,6 +128,13 @@ class INET_API IRoutingTable
      * is not filled in in the route.
      */
     virtual IPv4Address getGatewayForDestAddr(const IPv4Address& dest) const = 0;
+
+    /**
+     * Returns a view of the query functions that skips Enter_Method(), for
+     * the per-packet path of the forwarding code. The view stays valid as
+     * long as the routing table exists.
+     */
+    virtual const IRoutingTableFastPath *getFastPath() const = 0;
     //@}
 
     /** @name Multicast routing functions */
@@ -0,0 +1,67 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IROUTINGTABLEFASTPATH_H
+#define __INET_IROUTINGTABLEFASTPATH_H
+
+#include "INETDefs.h"
+
+#include "IPv4Address.h"
+
+class InterfaceEntry;
+class IPv4Route;
+class IPv4MulticastRoute;
+
+/**
+ * Read-only view of the query functions of IRoutingTable, for the
+ * per-packet path of the forwarding code (see IRoutingTable::getFastPath()).
+ *
+ * The functions return the same results as their IRoutingTable counterparts,
+ * but they are called without switching to the context of the routing table
+ * module (no Enter_Method()), so they neither show up as method calls in the
+ * GUI nor in the event log. Modifications of the routing table must still go
+ * through IRoutingTable.
+ */
+class INET_API IRoutingTableFastPath
+{
+  public:
+    virtual ~IRoutingTableFastPath() {}
+
+    /** @see IRoutingTable::getInterfaceByAddress() */
+    virtual InterfaceEntry *getInterfaceByAddress(const IPv4Address& address) const = 0;
+
+    /** @see IRoutingTable::isLocalAddress() */
+    virtual bool isLocalAddress(const IPv4Address& dest) const = 0;
+
+    /** @see IRoutingTable::isLocalBroadcastAddress() */
+    virtual bool isLocalBroadcastAddress(const IPv4Address& dest) const = 0;
+
+    /** @see IRoutingTable::findInterfaceByLocalBroadcastAddress() */
+    virtual InterfaceEntry *findInterfaceByLocalBroadcastAddress(const IPv4Address& dest) const = 0;
+
+    /** @see IRoutingTable::findBestMatchingRoute() */
+    virtual IPv4Route *findBestMatchingRoute(const IPv4Address& dest) const = 0;
+
+    /** @see IRoutingTable::getInterfaceForDestAddr() */
+    virtual InterfaceEntry *getInterfaceForDestAddr(const IPv4Address& dest) const = 0;
+
+    /** @see IRoutingTable::isLocalMulticastAddress() */
+    virtual bool isLocalMulticastAddress(const IPv4Address& dest) const = 0;
+
+    /** @see IRoutingTable::findBestMatchingMulticastRoute() */
+    virtual const IPv4MulticastRoute *findBestMatchingMulticastRoute(const IPv4Address& origin, const IPv4Address& group) const = 0;
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include "InterfaceTableAccess.h"
 #include "IPv4InterfaceData.h"
 #include "IPv4Route.h"
+#include "IPv4RouteTrie.h"
 #include "NotificationBoard.h"
 #include "NotifierConsts.h"
 #include "RoutingTableParser.h"
@@ -56,6 +57,9 @@ RoutingTable::RoutingTable()
 {
     ift = NULL;
     nb = NULL;
+    routeTrie = NULL;
+    numCacheHits = numCacheMisses = numCacheEvictions = 0;
+    fastPath.rt = this;
 }
 
 RoutingTable::~RoutingTable()
@@ -64,6 +68,7 @@ RoutingTable::~RoutingTable()
         delete routes[i];
     for (unsigned int i=0; i<multicastRoutes.size(); i++)
         delete multicastRoutes[i];
+    delete routeTrie;
 }
 
 void RoutingTable::initialize(int stage)
@@ -78,6 +83,12 @@ void RoutingTable::initialize(int stage)
         IPForward = par("IPForward").boolValue();
         multicastForward = par("forwardMulticast");
 
+        const char *routeLookup = par("routeLookup");
+        if (!strcmp(routeLookup, "trie"))
+            routeTrie = new IPv4RouteTrie();
+        else if (strcmp(routeLookup, "linear"))
+            error("Unknown routeLookup '%s', should be 'linear' or 'trie'", routeLookup);
+
         nb->subscribe(this, NF_INTERFACE_CREATED);
         nb->subscribe(this, NF_INTERFACE_DELETED);
         nb->subscribe(this, NF_INTERFACE_STATE_CHANGED);
@@ -182,6 +193,16 @@ void RoutingTable::handleMessage(cMessage *msg)
     throw cRuntimeError("This module doesn't process messages");
 }
 
+void RoutingTable::finish()
+{
+    if (!routeTrie)
+    {
+        recordScalar("routing cache hits", numCacheHits);
+        recordScalar("routing cache misses", numCacheMisses);
+        recordScalar("routing cache evictions", numCacheEvictions);
+    }
+}
+
 void RoutingTable::receiveChangeNotification(int category, const cObject *details)
 {
     if (simulation.getContextType()==CTX_INITIALIZE)
@@ -233,6 +254,8 @@ void RoutingTable::deleteInterfaceRoutes(InterfaceEntry *entry)
         if (route->getInterface() == entry)
         {
             it = routes.erase(it);
+            if (routeTrie)
+                routeTrie->removeRoute(route);
             ASSERT(route->getRoutingTable() == this); // still filled in, for the listeners' benefit
             nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, route);
             delete route;
@@ -277,11 +300,22 @@ void RoutingTable::deleteInterfaceRoutes(InterfaceEntry *entry)
 
 void RoutingTable::invalidateCache()
 {
+    numCacheEvictions += routingCache.size();
     routingCache.clear();
-    localAddresses.clear();
     localBroadcastAddresses.clear();
 }
 
+void RoutingTable::invalidateRoutingCache(const IPv4Address& destination, const IPv4Address& netmask)
+{
+    // routingCache is ordered by address, so the destinations covered by the
+    // prefix (the only ones whose best route may have changed) form a contiguous range
+    RoutingCache::iterator first = routingCache.lower_bound(destination.doAnd(netmask));
+    RoutingCache::iterator last = routingCache.upper_bound(IPv4Address(destination.getInt() | ~netmask.getInt()));
+    for (RoutingCache::iterator it = first; it != last; ++it)
+        numCacheEvictions++;
+    routingCache.erase(first, last);
+}
+
 void RoutingTable::printRoutingTable() const
 {
     EV << "-- Routing table --\n";
@@ -359,15 +393,13 @@ InterfaceEntry *RoutingTable::getInterfaceByAddress(const IPv4Address& addr) con
 {
     Enter_Method("getInterfaceByAddress(%u.%u.%u.%u)", addr.getDByte(0), addr.getDByte(1), addr.getDByte(2), addr.getDByte(3)); // note: str().c_str() too slow here
 
-    if (addr.isUnspecified())
-        return NULL;
-    for (int i=0; i<ift->getNumInterfaces(); ++i)
-    {
-        InterfaceEntry *ie = ift->getInterface(i);
-        if (ie->ipv4Data()->getIPAddress()==addr)
-            return ie;
-    }
-    return NULL;
+    return doGetInterfaceByAddress(addr);
+}
+
+InterfaceEntry *RoutingTable::doGetInterfaceByAddress(const IPv4Address& addr) const
+{
+    // the interface table keeps a hash index of the interface addresses
+    return ift->findInterfaceByAddress(addr);
 }
 
 
@@ -391,18 +423,20 @@ bool RoutingTable::isLocalAddress(const IPv4Address& dest) const
 {
     Enter_Method("isLocalAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
-    if (localAddresses.empty())
-    {
-        // collect interface addresses if not yet done
-        for (int i=0; i<ift->getNumInterfaces(); i++)
-        {
-            IPv4Address interfaceAddr = ift->getInterface(i)->ipv4Data()->getIPAddress();
-            localAddresses.insert(interfaceAddr);
-        }
-    }
+    return doIsLocalAddress(dest);
+}
+
+bool RoutingTable::doIsLocalAddress(const IPv4Address& dest) const
+{
+    // the interface table keeps a hash index of the interface addresses
+    if (!dest.isUnspecified())
+        return ift->findInterfaceByAddress(dest) != NULL;
 
-    AddressSet::iterator it = localAddresses.find(dest);
-    return it!=localAddresses.end();
+    // the unspecified address is not indexed: it is local if some interface has no address yet
+    for (int i=0; i<ift->getNumInterfaces(); i++)
+        if (ift->getInterface(i)->ipv4Data()->getIPAddress().isUnspecified())
+            return true;
+    return false;
 }
 
 // JcM add: check if the dest addr is local network broadcast
@@ -410,6 +444,11 @@ bool RoutingTable::isLocalBroadcastAddress(const IPv4Address& dest) const
 {
     Enter_Method("isLocalBroadcastAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
+    return doIsLocalBroadcastAddress(dest);
+}
+
+bool RoutingTable::doIsLocalBroadcastAddress(const IPv4Address& dest) const
+{
     if (localBroadcastAddresses.empty())
     {
         // collect interface addresses if not yet done
@@ -445,6 +484,11 @@ bool RoutingTable::isLocalMulticastAddress(const IPv4Address& dest) const
 {
     Enter_Method("isLocalMulticastAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
+    return doIsLocalMulticastAddress(dest);
+}
+
+bool RoutingTable::doIsLocalMulticastAddress(const IPv4Address& dest) const
+{
     for (int i=0; i<ift->getNumInterfaces(); i++)
     {
         InterfaceEntry *ie = ift->getInterface(i);
@@ -467,6 +511,9 @@ void RoutingTable::purge()
         else
         {
             it = routes.erase(it);
+            if (routeTrie)
+                routeTrie->removeRoute(route);
+            invalidateRoutingCache(route->getDestination(), route->getNetmask());
             ASSERT(route->getRoutingTable() == this); // still filled in, for the listeners' benefit
             nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, route);
             delete route;
@@ -491,22 +538,31 @@ void RoutingTable::purge()
     }
 
     if (deleted)
-    {
-        invalidateCache();
         updateDisplayString();
-    }
 }
 
 IPv4Route *RoutingTable::findBestMatchingRoute(const IPv4Address& dest) const
 {
     Enter_Method("findBestMatchingRoute(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
+    return doFindBestMatchingRoute(dest);
+}
+
+IPv4Route *RoutingTable::doFindBestMatchingRoute(const IPv4Address& dest) const
+{
+    if (routeTrie)
+        return routeTrie->findBestMatchingRoute(dest);
+
     RoutingCache::iterator it = routingCache.find(dest);
     if (it != routingCache.end())
     {
         if (it->second==NULL || it->second->isValid())
+        {
+            numCacheHits++;
             return it->second;
+        }
     }
+    numCacheMisses++;
 
     // find best match (one with longest prefix)
     // default route has zero prefix length, so (if exists) it'll be selected as last resort
@@ -532,7 +588,12 @@ InterfaceEntry *RoutingTable::getInterfaceForDestAddr(const IPv4Address& dest) c
 {
     Enter_Method("getInterfaceForDestAddr(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
-    const IPv4Route *e = findBestMatchingRoute(dest);
+    return doGetInterfaceForDestAddr(dest);
+}
+
+InterfaceEntry *RoutingTable::doGetInterfaceForDestAddr(const IPv4Address& dest) const
+{
+    const IPv4Route *e = doFindBestMatchingRoute(dest);
     return e ? e->getInterface() : NULL;
 }
 
@@ -551,6 +612,11 @@ const IPv4MulticastRoute *RoutingTable::findBestMatchingMulticastRoute(const IPv
             origin.getDByte(0), origin.getDByte(1), origin.getDByte(2), origin.getDByte(3),
             group.getDByte(0), group.getDByte(1), group.getDByte(2), group.getDByte(3)); // note: str().c_str() too slow here here
 
+    return doFindBestMatchingMulticastRoute(origin, group);
+}
+
+const IPv4MulticastRoute *RoutingTable::doFindBestMatchingMulticastRoute(const IPv4Address &origin, const IPv4Address &group) const
+{
     // TODO caching?
 
     for (MulticastRouteVector::const_iterator i=multicastRoutes.begin(); i!=multicastRoutes.end(); ++i)
@@ -644,6 +710,8 @@ void RoutingTable::internalAddRoute(IPv4Route *entry)
     // stop at the first match when doing the longest netmask matching
     RouteVector::iterator pos = upper_bound(routes.begin(), routes.end(), entry, routeLessThan);
     routes.insert(pos, entry);
+    if (routeTrie)
+        routeTrie->addRoute(entry);
 
     entry->setRoutingTable(this);
 }
@@ -654,7 +722,7 @@ void RoutingTable::addRoute(IPv4Route *entry)
 
     internalAddRoute(entry);
 
-    invalidateCache();
+    invalidateRoutingCache(entry->getDestination(), entry->getNetmask());
     updateDisplayString();
 
     nb->fireChangeNotification(NF_IPv4_ROUTE_ADDED, entry);
@@ -666,6 +734,8 @@ IPv4Route *RoutingTable::internalRemoveRoute(IPv4Route *entry)
     if (i!=routes.end())
     {
         routes.erase(i);
+        if (routeTrie)
+            routeTrie->removeRoute(entry);
         return entry;
     }
     return NULL;
@@ -679,7 +749,7 @@ IPv4Route *RoutingTable::removeRoute(IPv4Route *entry)
 
     if (entry != NULL)
     {
-        invalidateCache();
+        invalidateRoutingCache(entry->getDestination(), entry->getNetmask());
         updateDisplayString();
         ASSERT(entry->getRoutingTable() == this); // still filled in, for the listeners' benefit
         nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, entry);
@@ -696,7 +766,7 @@ bool RoutingTable::deleteRoute(IPv4Route *entry)
 
     if (entry != NULL)
     {
-        invalidateCache();
+        invalidateRoutingCache(entry->getDestination(), entry->getNetmask());
         updateDisplayString();
         ASSERT(entry->getRoutingTable() == this); // still filled in, for the listeners' benefit
         nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, entry);
@@ -768,7 +838,6 @@ void RoutingTable::addMulticastRoute(IPv4MulticastRoute *entry)
 
     internalAddMulticastRoute(entry);
 
-    invalidateCache();
     updateDisplayString();
 
     nb->fireChangeNotification(NF_IPv4_MROUTE_ADDED, entry);
@@ -793,7 +862,6 @@ IPv4MulticastRoute *RoutingTable::removeMulticastRoute(IPv4MulticastRoute *entry
 
     if (entry != NULL)
     {
-        invalidateCache();
         updateDisplayString();
         ASSERT(entry->getRoutingTable() == this); // still filled in, for the listeners' benefit
         nb->fireChangeNotification(NF_IPv4_MROUTE_DELETED, entry);
@@ -810,7 +878,6 @@ bool RoutingTable::deleteMulticastRoute(IPv4MulticastRoute *entry)
 
     if (entry != NULL)
     {
-        invalidateCache();
         updateDisplayString();
         ASSERT(entry->getRoutingTable() == this); // still filled in, for the listeners' benefit
         nb->fireChangeNotification(NF_IPv4_MROUTE_DELETED, entry);
@@ -827,7 +894,11 @@ void RoutingTable::routeChanged(IPv4Route *entry, int fieldCode)
         ASSERT(entry != NULL);  // failure means inconsistency: route was not found in this routing table
         internalAddRoute(entry);
 
-        invalidateCache();
+        // the cached destinations of the old prefix are not known after a destination or netmask change
+        if (fieldCode==IPv4Route::F_METRIC)
+            invalidateRoutingCache(entry->getDestination(), entry->getNetmask());
+        else
+            invalidateCache();
         updateDisplayString();
     }
     nb->fireChangeNotification(NF_IPv4_ROUTE_CHANGED, entry); // TODO include fieldCode in the notification
@@ -842,7 +913,6 @@ void RoutingTable::multicastRouteChanged(IPv4MulticastRoute *entry, int fieldCod
         ASSERT(entry != NULL);  // failure means inconsistency: route was not found in this routing table
         internalAddMulticastRoute(entry);
 
-        invalidateCache();
         updateDisplayString();
     }
     nb->fireChangeNotification(NF_IPv4_MROUTE_CHANGED, entry); // TODO include fieldCode in the notification
@@ -858,6 +928,8 @@ void RoutingTable::updateNetmaskRoutes()
             std::vector<IPv4Route *>::iterator it = routes.begin()+(k--);  // '--' is necessary because indices shift down
             IPv4Route *route = *it;
             routes.erase(it);
+            if (routeTrie)
+                routeTrie->removeRoute(route);
             ASSERT(route->getRoutingTable() == this); // still filled in, for the listeners' benefit
             nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, route);
             delete route;
@@ -884,6 +956,8 @@ void RoutingTable::updateNetmaskRoutes()
             route->setRoutingTable(this);
             RouteVector::iterator pos = upper_bound(routes.begin(), routes.end(), route, routeLessThan);
             routes.insert(pos, route);
+            if (routeTrie)
+                routeTrie->addRoute(route);
             nb->fireChangeNotification(NF_IPv4_ROUTE_ADDED, route);
         }
     }
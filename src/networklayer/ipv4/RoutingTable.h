@@ -38,6 +38,7 @@
 #include "ILifecycle.h"
 
 class IInterfaceTable;
+class IPv4RouteTrie;
 class NotificationBoard;
 class RoutingTableParser;
 
@@ -89,13 +90,37 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
     // routing cache: maps destination address to the route
     typedef std::map<IPv4Address, IPv4Route *> RoutingCache;
     mutable RoutingCache routingCache;
+    mutable long numCacheHits;    // findBestMatchingRoute() calls served from routingCache
+    mutable long numCacheMisses;  // findBestMatchingRoute() calls that had to scan the routes
+    long numCacheEvictions;       // destinations removed from routingCache because of route changes
+
+    // longest prefix match index over the unicast routes (routeLookup="trie");
+    // if present, findBestMatchingRoute() uses it instead of the scan and the routing cache
+    IPv4RouteTrie *routeTrie;
 
-    // local addresses cache (to speed up isLocalAddress())
-    typedef std::set<IPv4Address> AddressSet;
-    mutable AddressSet localAddresses;
     // JcM add: to handle the local broadcast address
+    typedef std::set<IPv4Address> AddressSet;
     mutable AddressSet localBroadcastAddresses;
 
+    // the view returned by getFastPath(): calls the do...() functions below
+    // directly, i.e. without Enter_Method()
+    class FastPath : public IRoutingTableFastPath
+    {
+      public:
+        const RoutingTable *rt;
+        FastPath() {rt = NULL;}
+        virtual InterfaceEntry *getInterfaceByAddress(const IPv4Address& address) const {return rt->doGetInterfaceByAddress(address);}
+        virtual bool isLocalAddress(const IPv4Address& dest) const {return rt->doIsLocalAddress(dest);}
+        virtual bool isLocalBroadcastAddress(const IPv4Address& dest) const {return rt->doIsLocalBroadcastAddress(dest);}
+        virtual InterfaceEntry *findInterfaceByLocalBroadcastAddress(const IPv4Address& dest) const {return rt->findInterfaceByLocalBroadcastAddress(dest);}
+        virtual IPv4Route *findBestMatchingRoute(const IPv4Address& dest) const {return rt->doFindBestMatchingRoute(dest);}
+        virtual InterfaceEntry *getInterfaceForDestAddr(const IPv4Address& dest) const {return rt->doGetInterfaceForDestAddr(dest);}
+        virtual bool isLocalMulticastAddress(const IPv4Address& dest) const {return rt->doIsLocalMulticastAddress(dest);}
+        virtual const IPv4MulticastRoute *findBestMatchingMulticastRoute(const IPv4Address& origin, const IPv4Address& group) const {return rt->doFindBestMatchingMulticastRoute(origin, group);}
+    };
+    friend class FastPath;
+    FastPath fastPath;
+
   private:
     // The vectors storing routes are ordered by prefix length, administrative distance, and metric.
     // Subclasses should use internalAdd[Multicast]Route() and internalRemove[Multicast]Route() methods
@@ -130,12 +155,25 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
     // invalidates routing cache and local addresses cache
     virtual void invalidateCache();
 
+    // removes the destinations covered by the given prefix from the routing cache
+    virtual void invalidateRoutingCache(const IPv4Address& destination, const IPv4Address& netmask);
+
     // helper for sorting routing table, used by addRoute()
     static bool routeLessThan(const IPv4Route *a, const IPv4Route *b);
 
     // helper for sorting multicast routing table, used by addMulticastRoute()
     static bool multicastRouteLessThan(const IPv4MulticastRoute *a, const IPv4MulticastRoute *b);
 
+    // implementations of the query functions, shared by the public ones
+    // (which do Enter_Method()) and the fast path
+    InterfaceEntry *doGetInterfaceByAddress(const IPv4Address& address) const;
+    bool doIsLocalAddress(const IPv4Address& dest) const;
+    bool doIsLocalBroadcastAddress(const IPv4Address& dest) const;
+    IPv4Route *doFindBestMatchingRoute(const IPv4Address& dest) const;
+    InterfaceEntry *doGetInterfaceForDestAddr(const IPv4Address& dest) const;
+    bool doIsLocalMulticastAddress(const IPv4Address& dest) const;
+    const IPv4MulticastRoute *doFindBestMatchingMulticastRoute(const IPv4Address& origin, const IPv4Address& group) const;
+
     // helper functions:
     void internalAddRoute(IPv4Route *entry);
     IPv4Route *internalRemoveRoute(IPv4Route *entry);
@@ -155,6 +193,11 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
      */
     virtual void handleMessage(cMessage *);
 
+    /**
+     * Records the routing cache statistics (not with routeLookup="trie").
+     */
+    virtual void finish();
+
     /**
      * Called by the NotificationBoard whenever a change of a category
      * occurs to which this client has subscribed.
@@ -251,6 +294,11 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
      * is not filled in in the route.
      */
     virtual IPv4Address getGatewayForDestAddr(const IPv4Address& dest) const;
+
+    /**
+     * Returns a view of the query functions that skips Enter_Method().
+     */
+    virtual const IRoutingTableFastPath *getFastPath() const {return &fastPath;}
     //@}
 
     /** @name Multicast routing functions */
@@ -35,6 +35,8 @@ IPv6FragBuf::IPv6FragBuf()
 
 IPv6FragBuf::~IPv6FragBuf()
 {
+    for (DatagramBuffer *buf = bufs.getOldest(); buf; buf = buf->next)
+        delete buf->datagram;
 }
 
 void IPv6FragBuf::init(ICMPv6 *icmp)
@@ -50,20 +52,11 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
     key.src = datagram->getSrcAddress();
     key.dest = datagram->getDestAddress();
 
-    Buffers::iterator i = bufs.find(key);
-
-    DatagramBuffer *buf = NULL;
-    if (i==bufs.end())
+    DatagramBuffer *buf = bufs.find(key);
+    if (buf==NULL)
     {
         // this is the first fragment of that datagram, create reassembly buffer for it
-        buf = &bufs[key];
-        buf->datagram = NULL;
-        buf->createdAt = now;
-    }
-    else
-    {
-        // use existing buffer
-        buf = &(i->second);
+        buf = bufs.add(key, now);
     }
 
     int fragmentLength = datagram->calculateFragmentLength();
@@ -122,7 +115,7 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
         ASSERT(ret);
         ret->removeExtensionHeader(IP_PROT_IPv6EXT_FRAGMENT);
         ret->setByteLength(ret->calculateUnfragmentableHeaderByteLength()+buf->buf.getTotalLength());
-        bufs.erase(i);
+        bufs.remove(buf);
         return ret;
     }
     else
@@ -145,32 +138,20 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
  */
 void IPv6FragBuf::purgeStaleFragments(simtime_t lastupdate)
 {
-    // this method shouldn't be called too often because iteration on
-    // an std::map is *very* slow...
-
     ASSERT(icmpModule);
 
-    for (Buffers::iterator i=bufs.begin(); i!=bufs.end(); )
+    // buffers are in creation order, so only the stale ones are visited
+    while (bufs.getOldest() && bufs.getOldest()->time < lastupdate)
     {
-        // if too old, remove it
-        DatagramBuffer& buf = i->second;
-        if (buf.createdAt < lastupdate)
-        {
-            if (buf.datagram)
-            {
-                // send ICMP error
-                EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
-                icmpModule->sendErrorMessage(buf.datagram, ICMPv6_TIME_EXCEEDED, 0);
-            }
-
-            // delete
-            Buffers::iterator oldi = i++;
-            bufs.erase(oldi);
-        }
-        else
+        DatagramBuffer *buf = bufs.getOldest();
+        if (buf->datagram)
         {
-            ++i;
+            // send ICMP error
+            EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
+            icmpModule->sendErrorMessage(buf->datagram, ICMPv6_TIME_EXCEEDED, 0);
         }
+
+        // delete
+        bufs.remove(buf);
     }
 }
-
@@ -18,10 +18,8 @@
 #ifndef __IPv6FRAGBUF_H__
 #define __IPv6FRAGBUF_H__
 
-#include <map>
-#include <vector>
 #include "INETDefs.h"
-#include "ReassemblyBuffer.h"
+#include "ReassemblyTable.h"
 #include "IPv6Address.h"
 
 class ICMPv6;
@@ -43,23 +41,23 @@ class INET_API IPv6FragBuf
         IPv6Address src;
         IPv6Address dest;
 
-        inline bool operator<(const Key& b) const {
-            return (id!=b.id) ? (id<b.id) : (src!=b.src) ? (src<b.src) : (dest<b.dest);
+        inline bool operator==(const Key& b) const {
+            return id==b.id && src==b.src && dest==b.dest;
+        }
+        inline uint32 hash() const {
+            const uint32 *s = src.words();
+            const uint32 *d = dest.words();
+            uint32 h = id;
+            for (int i = 0; i < 4; i++)
+                h = (h * 31 + s[i]) * 31 + d[i];
+            return h ^ (h >> 16);
         }
     };
 
-    //
-    // Reassembly buffer for the datagram
-    //
-    struct DatagramBuffer
-    {
-        ReassemblyBuffer buf;  // reassembly buffer
-        IPv6Datagram *datagram;  // the actual datagram
-        simtime_t createdAt;  // time of the buffer creation (i.e. reception time of first-arriving fragment)
-    };
-
-    // we use std::map for fast lookup by datagram Id
-    typedef std::map<Key,DatagramBuffer> Buffers;
+    // we use a hash table for fast lookup by datagram Id; the reassembly
+    // buffers are kept in creation order, so stale ones are at the front
+    typedef ReassemblyTable<Key,IPv6Datagram> Buffers;
+    typedef Buffers::Entry DatagramBuffer;  // time: time of the buffer creation (i.e. reception time of first-arriving fragment)
 
     // the reassembly buffers
     Buffers bufs;
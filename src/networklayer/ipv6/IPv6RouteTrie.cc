@@ -0,0 +1,74 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "IPv6RouteTrie.h"
+
+#include "RoutingTable6.h"
+
+
+// same order as RoutingTable6::routeLessThan() for routes with the same prefix
+bool IPv6RouteTrie::routeLessThan(const IPv6Route *a, const IPv6Route *b)
+{
+    if (a->getAdminDist() != b->getAdminDist())
+        return a->getAdminDist() < b->getAdminDist();
+    return a->getMetric() < b->getMetric();
+}
+
+bool IPv6RouteTrie::isExpired(const IPv6Route *route, simtime_t now)
+{
+    return route->getExpiryTime() != 0 && now > route->getExpiryTime();  // 0 represents infinity
+}
+
+void IPv6RouteTrie::addRoute(IPv6Route *route)
+{
+    int length = route->getPrefixLength();
+    RouteVector& routes = trie.findOrCreateNode(route->getDestPrefix().getPrefix(length), length)->data;
+    routes.insert(std::upper_bound(routes.begin(), routes.end(), route, routeLessThan), route);
+    numRoutes++;
+}
+
+bool IPv6RouteTrie::removeRoute(IPv6Route *route)
+{
+    int length = route->getPrefixLength();
+    Trie::Node *node = trie.findNode(route->getDestPrefix().getPrefix(length), length);
+    if (!node)
+        return false;
+    RouteVector::iterator it = std::find(node->data.begin(), node->data.end(), route);
+    if (it == node->data.end())
+        return false;
+    node->data.erase(it);
+    numRoutes--;
+    trie.removeNodeIfUnused(node);
+    return true;
+}
+
+IPv6Route *IPv6RouteTrie::findBestMatchingRoute(const IPv6Address& dest, simtime_t now) const
+{
+    IPv6Route *bestRoute = NULL;
+    for (const Trie::Node *node = trie.getRoot(); node; node = trie.getMatchingChild(node, dest))
+    {
+        for (RouteVector::const_iterator it = node->data.begin(); it != node->data.end(); ++it)
+        {
+            if (!isExpired(*it, now))
+            {
+                bestRoute = *it;
+                break;
+            }
+        }
+    }
+    return bestRoute;
+}
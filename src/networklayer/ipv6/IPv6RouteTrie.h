@@ -0,0 +1,85 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IPv6ROUTETRIE_H
+#define __INET_IPv6ROUTETRIE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "IPv6Address.h"
+#include "PrefixTrie.h"
+
+class IPv6Route;
+
+/**
+ * Longest prefix match index over the routes of RoutingTable6, keyed by
+ * the 128-bit destination prefix (see PrefixTrie).
+ *
+ * Routes with the same prefix are kept in their node in ascending
+ * administrative distance / metric order (and in insertion order among
+ * equals), which is the order RoutingTable6 keeps them in.
+ *
+ * findBestMatchingRoute() returns the first unexpired route of the longest
+ * matching prefix that has one, i.e. the same route as the linear scan of
+ * the sorted route list. The routes are not owned; their prefix must not
+ * change while they are in the trie (IPv6Route does not allow that anyway).
+ *
+ * @see RoutingTable6, IPv4RouteTrie
+ */
+class INET_API IPv6RouteTrie
+{
+  protected:
+    typedef std::vector<IPv6Route *> RouteVector;  // routes with exactly the same prefix
+    typedef PrefixTrie<IPv6Address, RouteVector, IPv6PrefixTraits> Trie;
+
+    Trie trie;
+    int numRoutes;
+
+  protected:
+    static bool routeLessThan(const IPv6Route *a, const IPv6Route *b);
+    static bool isExpired(const IPv6Route *route, simtime_t now);
+
+  public:
+    IPv6RouteTrie() : numRoutes(0) {}
+
+    /**
+     * Adds a route.
+     */
+    void addRoute(IPv6Route *route);
+
+    /**
+     * Removes the route and returns true if it was found.
+     */
+    bool removeRoute(IPv6Route *route);
+
+    /**
+     * Removes all routes.
+     */
+    void clear() {trie.clear(); numRoutes = 0;}
+
+    /**
+     * Returns the first route with the longest prefix matching dest that
+     * has not expired at the given time (expiry time 0 means infinite),
+     * or NULL if there is none.
+     */
+    IPv6Route *findBestMatchingRoute(const IPv6Address& dest, simtime_t now) const;
+
+    int getNumRoutes() const {return numRoutes;}
+    int getNumNodes() const {return trie.getNumNodes();}
+};
+
+#endif
@@ -84,12 +84,14 @@ std::ostream& operator<<(std::ostream& os, const RoutingTable6::DestCacheEntry&
 
 RoutingTable6::RoutingTable6()
 {
+    expiryTimer = NULL;
 }
 
 RoutingTable6::~RoutingTable6()
 {
     for (unsigned int i=0; i<routeList.size(); i++)
         delete routeList[i];
+    cancelAndDelete(expiryTimer);
 }
 
 IPv6Route *RoutingTable6::createNewRoute(IPv6Address destPrefix, int prefixLength, IPv6Route::RouteSrc src)
@@ -99,7 +101,12 @@ IPv6Route *RoutingTable6::createNewRoute(IPv6Address destPrefix, int prefixLengt
 
 void RoutingTable6::initialize(int stage)
 {
-    if (stage==1)
+    if (stage==0)
+    {
+        expiryTimer = new cMessage("expiryTimer");
+        rescheduleExpiryTimer();  // other modules may have added routes already
+    }
+    else if (stage==1)
     {
         //TODO isNodeUp???
 
@@ -215,7 +222,10 @@ void RoutingTable6::updateDisplayString()
 
 void RoutingTable6::handleMessage(cMessage *msg)
 {
-    throw cRuntimeError("This module doesn't process messages");
+    if (msg == expiryTimer)
+        purgeExpiredEntries();
+    else
+        throw cRuntimeError("This module doesn't process messages");
 }
 
 void RoutingTable6::receiveChangeNotification(int category, const cObject *details)
@@ -269,6 +279,14 @@ void RoutingTable6::routeChanged(IPv6Route *entry, int fieldCode)
      route information.*/
     if (fieldCode==IPv6Route::F_NEXTHOP || fieldCode==IPv6Route::F_IFACE)
         purgeDestCache();
+    else if (fieldCode==IPv6Route::F_EXPIRYTIME)
+        updateRouteExpiry(entry);
+    else if (fieldCode==IPv6Route::F_METRIC || fieldCode==IPv6Route::F_ADMINDIST)
+    {
+        // reinsert to keep the routes of the prefix in order
+        routeTrie.removeRoute(entry);
+        routeTrie.addRoute(entry);
+    }
 
     updateDisplayString();
 
@@ -482,16 +500,8 @@ InterfaceEntry *RoutingTable6::getInterfaceByAddress(const IPv6Address& addr)
 {
     Enter_Method("getInterfaceByAddress(%s)=?", addr.str().c_str());
 
-    if (addr.isUnspecified())
-        return NULL;
-
-    for (int i=0; i<ift->getNumInterfaces(); ++i)
-    {
-        InterfaceEntry *ie = ift->getInterface(i);
-        if (ie->ipv6Data()->hasAddress(addr))
-            return ie;
-    }
-    return NULL;
+    // the interface table keeps a hash index of the interface addresses
+    return ift->findInterfaceByAddress(addr);
 }
 
 bool RoutingTable6::isLocalAddress(const IPv6Address& dest) const
@@ -499,12 +509,8 @@ bool RoutingTable6::isLocalAddress(const IPv6Address& dest) const
     Enter_Method("isLocalAddress(%s) y/n", dest.str().c_str());
 
     // first, check if we have an interface with this address
-    for (int i=0; i<ift->getNumInterfaces(); i++)
-    {
-        InterfaceEntry *ie = ift->getInterface(i);
-        if (ie->ipv6Data()->hasAddress(dest))
-            return true;
-    }
+    if (ift->findInterfaceByAddress(dest))
+        return true;
 
     // then check for special, preassigned multicast addresses
     // (these addresses occur more rarely than specific interface addresses,
@@ -542,7 +548,7 @@ const IPv6Address& RoutingTable6::lookupDestCache(const IPv6Address& dest, int&
     DestCacheEntry &entry = it->second;
     if (entry.expiryTime > 0 && simTime() > entry.expiryTime)
     {
-        destCache.erase(it);
+        eraseDestCacheEntry(it);
         outInterfaceId = -1;
         return IPv6Address::UNSPECIFIED_ADDRESS;
     }
@@ -555,33 +561,10 @@ const IPv6Route *RoutingTable6::doLongestPrefixMatch(const IPv6Address& dest)
 {
     Enter_Method("doLongestPrefixMatch(%s)", dest.str().c_str());
 
-    // we'll just stop at the first match, because the table is sorted
-    // by prefix lengths and metric (see addRoute())
-
-    // bugfix - CB
-    RouteList::iterator it = routeList.begin();
-    while (it!=routeList.end())
-    {
-        if (dest.matches((*it)->getDestPrefix(), (*it)->getPrefixLength()))
-        {
-            if (simTime() > (*it)->getExpiryTime() && (*it)->getExpiryTime() != 0)//since 0 represents infinity.
-            {
-                if ( (*it)->getSrc()==IPv6Route::FROM_RA )
-                {
-                    EV << "Expired prefix detected!!" << endl;
-                    it = routeList.erase(it);
-                    //RouteList::iterator oldIt = it++;
-                    //removeOnLinkPrefix((*oldIt)->getDestPrefix(), (*oldIt)->getPrefixLength());
-                }
-            }
-            else
-                return *it;
-        }
-        else
-            ++it;
-    }
-    // FIXME todo: if we selected an expired route, throw it out and select again!
-    return NULL;
+    // the trie returns the first unexpired route with the longest matching
+    // prefix, i.e. the first match in routeList (see addRoute()). Expired
+    // on-link prefixes are removed by the expiry timer (purgeExpiredEntries()).
+    return routeTrie.findBestMatchingRoute(dest, simTime());
 }
 
 bool RoutingTable6::isPrefixPresent(const IPv6Address& prefix) const
@@ -595,15 +578,22 @@ bool RoutingTable6::isPrefixPresent(const IPv6Address& prefix) const
 void RoutingTable6::updateDestCache(const IPv6Address& dest, const IPv6Address& nextHopAddr, int interfaceId, simtime_t expiryTime)
 {
     DestCacheEntry &entry = destCache[dest];
+    if (entry.expiryTime > 0)
+        expiryQueue.erase(entry.expiryIt);
     entry.nextHopAddr = nextHopAddr;
     entry.interfaceId = interfaceId;
     entry.expiryTime = expiryTime;
+    if (expiryTime > 0)
+        entry.expiryIt = addExpiry(expiryTime, NULL, dest);
 
     updateDisplayString();
 }
 
 void RoutingTable6::purgeDestCache()
 {
+    for (DestCache::iterator it=destCache.begin(); it!=destCache.end(); ++it)
+        if (it->second.expiryTime > 0)
+            expiryQueue.erase(it->second.expiryIt);
     destCache.clear();
     updateDisplayString();
 }
@@ -615,7 +605,7 @@ void RoutingTable6::purgeDestCacheEntriesToNeighbour(const IPv6Address& nextHopA
         if (it->second.interfaceId==interfaceId && it->second.nextHopAddr==nextHopAddr)
         {
             // move the iterator past this element before removing it
-            destCache.erase(it++);
+            eraseDestCacheEntry(it++);
         }
         else
         {
@@ -633,7 +623,7 @@ void RoutingTable6::purgeDestCacheForInterfaceID(int interfaceId)
         if (it->second.interfaceId==interfaceId)
         {
             // move the iterator past this element before removing it
-            destCache.erase(it++);
+            eraseDestCacheEntry(it++);
         }
         else
         {
@@ -729,6 +719,7 @@ void RoutingTable6::removeOnLinkPrefix(const IPv6Address& destPrefix, int prefix
     {
         if ((*it)->getSrc()==IPv6Route::FROM_RA && (*it)->getDestPrefix()==destPrefix && (*it)->getPrefixLength()==prefixLength)
         {
+            unindexRoute(*it);
             routeList.erase(it);
             return; // there can be only one such route, addOrUpdateOnLinkPrefix() guarantees that
         }
@@ -802,6 +793,7 @@ void RoutingTable6::addRoute(IPv6Route *route)
     // we keep entries sorted by prefix length in routeList, so that we can
     // stop at the first match when doing the longest prefix matching
     std::sort(routeList.begin(), routeList.end(), routeLessThan);
+    indexRoute(route);
 
     /*XXX: this deletes some cache entries we want to keep, but the node MUST update
      the Destination Cache in such a way that the latest route information are used.*/
@@ -818,6 +810,7 @@ void RoutingTable6::removeRoute(IPv6Route *route)
 
     nb->fireChangeNotification(NF_IPv6_ROUTE_DELETED, route); // rather: going to be deleted
 
+    unindexRoute(route);
     routeList.erase(it);
     delete route;
 
@@ -840,6 +833,98 @@ IPv6Route *RoutingTable6::getRoute(int i)
     return routeList[i];
 }
 
+void RoutingTable6::indexRoute(IPv6Route *route)
+{
+    routeTrie.addRoute(route);
+    updateRouteExpiry(route);
+}
+
+void RoutingTable6::unindexRoute(IPv6Route *route)
+{
+    routeTrie.removeRoute(route);
+    cancelRouteExpiry(route);
+    route->setRoutingTable(NULL);  // no more routeChanged() calls for a route no longer in the table
+}
+
+void RoutingTable6::updateRouteExpiry(IPv6Route *route)
+{
+    cancelRouteExpiry(route);
+
+    // only on-link prefixes get removed when they expire; doLongestPrefixMatch()
+    // skips the other expired routes
+    if (route->getSrc()==IPv6Route::FROM_RA && route->getExpiryTime() > 0)
+        routeExpiries[route] = addExpiry(route->getExpiryTime(), route, IPv6Address::UNSPECIFIED_ADDRESS);
+}
+
+void RoutingTable6::cancelRouteExpiry(IPv6Route *route)
+{
+    RouteExpiryMap::iterator it = routeExpiries.find(route);
+    if (it != routeExpiries.end())
+    {
+        expiryQueue.erase(it->second);
+        routeExpiries.erase(it);
+    }
+}
+
+RoutingTable6::ExpiryQueue::iterator RoutingTable6::addExpiry(simtime_t expiryTime, IPv6Route *route, const IPv6Address& dest)
+{
+    ExpiringEntry entry;
+    entry.route = route;
+    entry.dest = dest;
+    ExpiryQueue::iterator it = expiryQueue.insert(std::make_pair(expiryTime, entry));
+
+    // removing entries only makes the timer fire early, but a new first entry needs rescheduling
+    // (before initialize() there is no timer yet; it is scheduled there)
+    if (expiryTimer && it == expiryQueue.begin() && (!expiryTimer->isScheduled() || expiryTime < expiryTimer->getArrivalTime()))
+        rescheduleExpiryTimer();
+    return it;
+}
+
+void RoutingTable6::eraseDestCacheEntry(DestCache::iterator it)
+{
+    if (it->second.expiryTime > 0)
+        expiryQueue.erase(it->second.expiryIt);
+    destCache.erase(it);
+}
+
+void RoutingTable6::rescheduleExpiryTimer()
+{
+    Enter_Method_Silent();  // may be called from other modules via addRoute() etc.
+    cancelEvent(expiryTimer);
+    if (!expiryQueue.empty())
+    {
+        // entries are still valid at their expiry time, so fire at the next representable time
+        simtime_t firstExpired = expiryQueue.begin()->first;
+        firstExpired.setRaw(firstExpired.raw() + 1);
+        scheduleAt(std::max(firstExpired, simTime()), expiryTimer);
+    }
+}
+
+void RoutingTable6::purgeExpiredEntries()
+{
+    simtime_t now = simTime();
+    while (!expiryQueue.empty() && expiryQueue.begin()->first < now)
+    {
+        // removing the entry also removes it from the expiry queue
+        ExpiringEntry entry = expiryQueue.begin()->second;
+        if (entry.route)
+        {
+            EV << "Expired prefix detected, removing route " << entry.route->info() << endl;
+            removeRoute(entry.route);
+        }
+        else
+        {
+            DestCache::iterator it = destCache.find(entry.dest);
+            ASSERT(it != destCache.end());
+            eraseDestCacheEntry(it);
+        }
+    }
+
+    // notification listeners of removeRoute() may have added entries meanwhile
+    rescheduleExpiryTimer();
+    updateDisplayString();
+}
+
 #ifdef WITH_xMIPv6
 //#####Added by Zarrar Yousaf##################################################################
 
@@ -879,7 +964,10 @@ void RoutingTable6::removeDefaultRoutes(int interfaceID)
     {
         // default routes have prefix length 0
         if ( (((*it)->getInterfaceId()) == interfaceID) && ((*it)->getPrefixLength() == 0)  )
+        {
+            unindexRoute(*it);
             it = routeList.erase(it);
+        }
         else
             ++it;
     }
@@ -893,7 +981,10 @@ void RoutingTable6::removeAllRoutes()
     EV << "/// Removing all routes from rt6 " << endl;
 
     for (unsigned int i=0; i<routeList.size(); i++)
+    {
+        unindexRoute(routeList[i]);
         delete routeList[i];
+    }
 
     routeList.clear();
 
@@ -907,7 +998,10 @@ void RoutingTable6::removePrefixes(int interfaceID)
     {
         // "real" prefixes have a length of larger then 0
         if ( (((*it)->getInterfaceId()) == interfaceID) && ((*it)->getPrefixLength() > 0)  )
+        {
+            unindexRoute(*it);
             it = routeList.erase(it);
+        }
         else
             ++it;
     }
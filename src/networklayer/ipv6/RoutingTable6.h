@@ -18,11 +18,13 @@
 #ifndef __INET_ROUTINGTABLE6_H
 #define __INET_ROUTINGTABLE6_H
 
+#include <map>
 #include <vector>
 
 #include "INETDefs.h"
 
 #include "IPv6Address.h"
+#include "IPv6RouteTrie.h"
 #include "NotificationBoard.h"
 #include "ILifecycle.h"
 
@@ -136,7 +138,7 @@ class INET_API IPv6Route : public cObject
  * See the NED documentation for general overview.
  *
  * This is a simple module without gates, it requires function calls to it
- * (message handling does nothing). Methods are provided for reading and
+ * (message handling is limited to its expiry timer). Methods are provided for reading and
  * updating the interface table and the route table, as well as for unicast
  * and multicast routing.
  *
@@ -159,6 +161,22 @@ class INET_API RoutingTable6 : public cSimpleModule, protected INotifiable, publ
     bool mipv6Support; // 4.9.07 - CB
 #endif /* WITH_xMIPv6 */
 
+    // Expiry queue: on-link prefixes (FROM_RA routes) and Destination Cache
+    // entries with finite lifetime, ordered by expiry time. A single timer is
+    // scheduled for the earliest one, so expired entries are removed without
+    // the lookups having to check for them. Entries are still valid at their
+    // expiry time.
+    struct ExpiringEntry
+    {
+        IPv6Route *route;  // NULL for Destination Cache entries
+        IPv6Address dest;  // Destination Cache key
+    };
+    typedef std::multimap<simtime_t, ExpiringEntry> ExpiryQueue;
+    ExpiryQueue expiryQueue;
+    typedef std::map<IPv6Route *, ExpiryQueue::iterator> RouteExpiryMap;
+    RouteExpiryMap routeExpiries;  // the expiry queue entries of the routes
+    cMessage *expiryTimer;
+
     // Destination Cache maps dest address to next hop and interfaceId.
     // NOTE: nextHop might be a link-local address from which interfaceId cannot be deduced
     struct DestCacheEntry
@@ -166,6 +184,7 @@ class INET_API RoutingTable6 : public cSimpleModule, protected INotifiable, publ
         int interfaceId;
         IPv6Address nextHopAddr;
         simtime_t expiryTime;
+        ExpiryQueue::iterator expiryIt;  // valid if expiryTime > 0
         // more destination specific data may be added here, e.g. path MTU
     };
     friend std::ostream& operator<<(std::ostream& os, const DestCacheEntry& e);
@@ -177,6 +196,9 @@ class INET_API RoutingTable6 : public cSimpleModule, protected INotifiable, publ
     typedef std::vector<IPv6Route*> RouteList;
     RouteList routeList;
 
+    // index of routeList for longest prefix matching
+    IPv6RouteTrie routeTrie;
+
   protected:
     // creates a new empty route, factory method overriden in subclasses that use custom routes
     virtual IPv6Route *createNewRoute(IPv6Address destPrefix, int prefixLength, IPv6Route::RouteSrc src);
@@ -185,6 +207,17 @@ class INET_API RoutingTable6 : public cSimpleModule, protected INotifiable, publ
     virtual void addRoute(IPv6Route *route);
     // helper for addRoute()
     static bool routeLessThan(const IPv6Route *a, const IPv6Route *b);
+    // internal: to be called when a route is inserted into / erased from routeList
+    virtual void indexRoute(IPv6Route *route);
+    virtual void unindexRoute(IPv6Route *route);
+    // internal: expiry queue maintenance
+    virtual void updateRouteExpiry(IPv6Route *route);
+    virtual void cancelRouteExpiry(IPv6Route *route);
+    virtual ExpiryQueue::iterator addExpiry(simtime_t expiryTime, IPv6Route *route, const IPv6Address& dest);
+    virtual void eraseDestCacheEntry(DestCache::iterator it);
+    virtual void rescheduleExpiryTimer();
+    // removes the expired on-link prefixes and Destination Cache entries
+    virtual void purgeExpiredEntries();
     // internal
     virtual void configureInterfaceForIPv6(InterfaceEntry *ie);
     /**
@@ -213,7 +246,7 @@ class INET_API RoutingTable6 : public cSimpleModule, protected INotifiable, publ
     virtual void parseXMLConfigFile();
 
     /**
-     * Raises an error.
+     * Processes the expiry timer; raises an error for other messages.
      */
     virtual void handleMessage(cMessage *);
 
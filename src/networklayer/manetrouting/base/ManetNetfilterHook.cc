@@ -48,6 +48,12 @@ void ManetNetfilterHook::finishHook()
     ipLayer->unregisterHook(0, this);
 }
 
+bool ManetNetfilterHook::isHookTypeUsed(Type type) const
+{
+    // the forward and postrouting hooks just accept, and all of them do so for proactive routing
+    return isReactive && (type == PREROUTING || type == LOCALIN || type == LOCALOUT);
+}
+
 INetfilter::IHook::Result ManetNetfilterHook::datagramPreRoutingHook(IPv4Datagram* datagram, const InterfaceEntry* inIE, const InterfaceEntry*& outIE, IPv4Address& nextHopAddr)
 {
     if (isReactive)
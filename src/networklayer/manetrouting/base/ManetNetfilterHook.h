@@ -76,6 +76,7 @@ class INET_API ManetNetfilterHook : public INetfilter::IHook
     virtual bool checkPacketUnroutable(IPv4Datagram* datagram, const InterfaceEntry* outIE);
 
   public:
+    virtual bool isHookTypeUsed(Type type) const;
     virtual IHook::Result datagramPreRoutingHook(IPv4Datagram* datagram, const InterfaceEntry* inIE, const InterfaceEntry*& outIE, IPv4Address& nextHopAddr);
     virtual IHook::Result datagramForwardHook(IPv4Datagram* datagram, const InterfaceEntry* inIE, const InterfaceEntry*& outIE, IPv4Address& nextHopAddr);
     virtual IHook::Result datagramPostRoutingHook(IPv4Datagram* datagram, const InterfaceEntry* inIE, const InterfaceEntry*& outIE, IPv4Address& nextHopAddr);
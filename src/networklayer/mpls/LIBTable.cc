@@ -17,10 +17,18 @@
 #include "LIBTable.h"
 #include "XMLUtils.h"
 #include "RoutingTableAccess.h"
+#include "InterfaceTableAccess.h"
 
 Define_Module(LIBTable);
 
 
+LIBTable::LIBTable()
+{
+    ift = NULL;
+    maxLabel = 0;
+    seqCounter = 0;
+}
+
 void LIBTable::initialize(int stage)
 {
     cSimpleModule::initialize(stage);
@@ -28,7 +36,8 @@ void LIBTable::initialize(int stage)
     if (stage == 0)
     {
         maxLabel = 0;
-        WATCH_VECTOR(lib);
+        ift = InterfaceTableAccess().get();
+        WATCH_MAP(lib);
     }
     else if (stage == 4)
     {
@@ -46,26 +55,78 @@ void LIBTable::handleMessage(cMessage *)
     ASSERT(false);
 }
 
-bool LIBTable::resolveLabel(std::string inInterface, int inLabel,
-        LabelOpVector& outLabel, std::string& outInterface, int& color)
+int LIBTable::resolveInterfaceName(const std::string& name)
 {
-    bool any = (inInterface.length() == 0);
+    if (name.empty())
+        return -1;
+    InterfaceEntry *ie = ift->getInterfaceByName(name.c_str());
+    return ie ? ie->getInterfaceId() : -1;
+}
 
-    for (unsigned int i = 0; i < lib.size(); i++)
-    {
-        if (!any && lib[i].inInterface != inInterface)
-            continue;
+void LIBTable::addToIndexes(LIBEntry *entry)
+{
+    if (entry->inInterfaceId != -1)
+        ilm.insert(IlmKey(entry->inInterfaceId, entry->inLabel), entry, entry->seq);
+    labelIndex.insert(entry->inLabel, entry, entry->seq);
+}
 
-        if (lib[i].inLabel != inLabel)
-            continue;
+void LIBTable::removeFromIndexes(LIBEntry *entry)
+{
+    if (entry->inInterfaceId != -1)
+        ilm.remove(IlmKey(entry->inInterfaceId, entry->inLabel), entry);
+    labelIndex.remove(entry->inLabel, entry);
+}
+
+LIBTable::LIBEntry *LIBTable::addLibEntry(const LIBEntry& entry)
+{
+    long seq = seqCounter++;
+    LIBEntry *newEntry = &(lib[seq] = entry);
+    newEntry->inInterfaceId = resolveInterfaceName(newEntry->inInterface);
+    newEntry->outInterfaceId = resolveInterfaceName(newEntry->outInterface);
+    newEntry->seq = seq;
+    addToIndexes(newEntry);
+    return newEntry;
+}
 
-        outLabel = lib[i].outLabel;
-        outInterface = lib[i].outInterface;
-        color = lib[i].color;
+LIBTable::LIBEntry *LIBTable::findByLabel(int inLabel) const
+{
+    return labelIndex.find(inLabel);
+}
 
-        return true;
+const LIBTable::LIBEntry *LIBTable::findLibEntry(int inInterfaceId, int inLabel) const
+{
+    if (inInterfaceId == -1)
+        return findByLabel(inLabel);
+    return ilm.find(IlmKey(inInterfaceId, inLabel));
+}
+
+bool LIBTable::resolveLabel(std::string inInterface, int inLabel,
+        LabelOpVector& outLabel, std::string& outInterface, int& color)
+{
+    const LIBEntry *entry = NULL;
+    if (inInterface.length() == 0)
+        entry = findByLabel(inLabel);
+    else
+    {
+        int inInterfaceId = resolveInterfaceName(inInterface);
+        if (inInterfaceId != -1)
+            entry = findLibEntry(inInterfaceId, inLabel);
+        else
+        {
+            // not an interface of this node, so it is not in the ILM
+            for (std::map<long, LIBEntry>::iterator it = lib.begin(); it != lib.end() && !entry; ++it)
+                if (it->second.inLabel == inLabel && it->second.inInterface == inInterface)
+                    entry = &it->second;
+        }
     }
-    return false;
+
+    if (!entry)
+        return false;
+
+    outLabel = entry->outLabel;
+    outInterface = entry->outInterface;
+    color = entry->color;
+    return true;
 }
 
 int LIBTable::installLibEntry(int inLabel, std::string inInterface, const LabelOpVector& outLabel,
@@ -79,38 +140,35 @@ int LIBTable::installLibEntry(int inLabel, std::string inInterface, const LabelO
         newItem.outLabel = outLabel;
         newItem.outInterface = outInterface;
         newItem.color = color;
-        lib.push_back(newItem);
-        return newItem.inLabel;
+        return addLibEntry(newItem)->inLabel;
     }
     else
     {
-        for (unsigned int i = 0; i < lib.size(); i++)
+        LIBEntry *entry = findByLabel(inLabel);
+        ASSERT(entry);
+
+        if (entry->inInterface != inInterface)
         {
-            if (lib[i].inLabel != inLabel)
-                continue;
-
-            lib[i].inInterface = inInterface;
-            lib[i].outLabel = outLabel;
-            lib[i].outInterface = outInterface;
-            lib[i].color = color;
-            return inLabel;
+            removeFromIndexes(entry);
+            entry->inInterface = inInterface;
+            entry->inInterfaceId = resolveInterfaceName(inInterface);
+            addToIndexes(entry);
         }
-        ASSERT(false);
-        return 0; // prevent warning
+        entry->outLabel = outLabel;
+        entry->outInterface = outInterface;
+        entry->outInterfaceId = resolveInterfaceName(outInterface);
+        entry->color = color;
+        return inLabel;
     }
 }
 
 void LIBTable::removeLibEntry(int inLabel)
 {
-    for (unsigned int i = 0; i < lib.size(); i++)
-    {
-        if (lib[i].inLabel != inLabel)
-            continue;
+    LIBEntry *entry = findByLabel(inLabel);
+    ASSERT(entry);
 
-        lib.erase(lib.begin() + i);
-        return;
-    }
-    ASSERT(false);
+    removeFromIndexes(entry);
+    lib.erase(entry->seq);
 }
 
 void LIBTable::readTableFromXML(const cXMLElement* libtable)
@@ -165,7 +223,7 @@ void LIBTable::readTableFromXML(const cXMLElement* libtable)
             newItem.outLabel.push_back(l);
         }
 
-        lib.push_back(newItem);
+        addLibEntry(newItem);
 
         ASSERT(newItem.inLabel > 0);
 
@@ -16,15 +16,19 @@
 #ifndef __INET_LIBTABLE_H
 #define __INET_LIBTABLE_H
 
+#include <map>
 #include <vector>
 #include <string>
 
 #include "INETDefs.h"
 
 #include "ConstType.h"
+#include "HashIndex.h"
 #include "IPv4Address.h"
 #include "IPv4Datagram.h"
 
+class IInterfaceTable;
+
 // label operations
 #define PUSH_OPER              0
 #define SWAP_OPER              1
@@ -42,7 +46,15 @@ struct LabelOp
 typedef std::vector<LabelOp> LabelOpVector;
 
 /**
- * TODO documentation
+ * The Label Information Base of an LSR.
+ *
+ * Incoming labels are resolved through a hashed ILM (incoming label map)
+ * keyed by incoming interface id and label, and through a second hash index
+ * keyed by the label only, used for lookups on any interface and by
+ * installLibEntry() / removeLibEntry(); both are maintained incrementally.
+ * Interface names are resolved to ids when an entry is installed, so the
+ * per-packet lookup (findLibEntry()) compares integers only. If several
+ * entries match, the one installed first is returned.
  */
 class INET_API LIBTable: public cSimpleModule
 {
@@ -57,12 +69,30 @@ class INET_API LIBTable: public cSimpleModule
 
             // FIXME colors in nam, temporary solution
             int color;
+
+            // interface ids of inInterface/outInterface, -1 if empty or unknown
+            int inInterfaceId;
+            int outInterfaceId;
+
+            long seq;  // installation order
         };
 
     protected:
+        typedef std::pair<int, int> IlmKey;  // inInterfaceId, inLabel
+        struct IlmKeyHash
+        {
+            uint32 operator()(const IlmKey& key) const {return IntHash()(key.second * 31 + key.first);}
+        };
+
+        IInterfaceTable *ift;
         IPv4Address routerId;
         int maxLabel;
-        std::vector<LIBEntry> lib;
+        std::map<long, LIBEntry> lib;  // by LIBEntry::seq
+
+        // hash indexes over lib, ranked by LIBEntry::seq
+        HashIndex<IlmKey, LIBEntry, IlmKeyHash> ilm;  // entries with known inInterface only
+        HashIndex<int, LIBEntry, IntHash> labelIndex;  // by inLabel
+        long seqCounter;
 
     protected:
         virtual void initialize(int stage);
@@ -72,8 +102,25 @@ class INET_API LIBTable: public cSimpleModule
         // static configuration
         virtual void readTableFromXML(const cXMLElement* libtable);
 
+        // hash indexes
+        virtual int resolveInterfaceName(const std::string& name);
+        virtual LIBEntry *addLibEntry(const LIBEntry& entry);
+        virtual LIBEntry *findByLabel(int inLabel) const;
+        virtual void addToIndexes(LIBEntry *entry);
+        virtual void removeFromIndexes(LIBEntry *entry);
+
     public:
+        LIBTable();
+
         // label management
+
+        /**
+         * Returns the entry for the given incoming label received on the given
+         * interface (or on any interface if inInterfaceId is -1), or NULL.
+         * This is the per-packet lookup used by MPLS.
+         */
+        virtual const LIBEntry *findLibEntry(int inInterfaceId, int inLabel) const;
+
         virtual bool resolveLabel(std::string inInterface, int inLabel,
                           LabelOpVector& outLabel, std::string& outInterface, int& color);
 
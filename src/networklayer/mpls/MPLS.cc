@@ -214,11 +214,10 @@ void MPLS::processMPLSPacketFromL2(MPLSPacket *mplsPacket)
 {
     int gateIndex = mplsPacket->getArrivalGate()->getIndex();
     InterfaceEntry *ie = ift->getInterfaceByNetworkLayerGateIndex(gateIndex);
-    std::string senderInterface = ie->getName();
     ASSERT(mplsPacket->hasLabel());
     int oldLabel = mplsPacket->getTopLabel();
 
-    EV << "Received " << mplsPacket << " from L2, label=" << oldLabel << " inInterface=" << senderInterface << endl;
+    EV << "Received " << mplsPacket << " from L2, label=" << oldLabel << " inInterface=" << ie->getName() << endl;
 
     if (oldLabel==-1)
     {
@@ -232,12 +231,8 @@ void MPLS::processMPLSPacketFromL2(MPLSPacket *mplsPacket)
         return;
     }
 
-    LabelOpVector outLabel;
-    std::string outInterface;
-    int color;
-
-    bool found = lt->resolveLabel(senderInterface, oldLabel, outLabel, outInterface, color);
-    if (!found)
+    const LIBTable::LIBEntry *libEntry = lt->findLibEntry(ie->getInterfaceId(), oldLabel);
+    if (!libEntry)
     {
         EV << "discarding packet, incoming label not resolved" << endl;
 
@@ -245,9 +240,12 @@ void MPLS::processMPLSPacketFromL2(MPLSPacket *mplsPacket)
         return;
     }
 
-    int outgoingPort = ift->getInterfaceByName(outInterface.c_str())->getNetworkLayerGateIndex();
+    const std::string& outInterface = libEntry->outInterface;
+    int color = libEntry->color;
+    InterfaceEntry *outIe = libEntry->outInterfaceId != -1 ? ift->getInterfaceById(libEntry->outInterfaceId) : ift->getInterfaceByName(outInterface.c_str());
+    int outgoingPort = outIe->getNetworkLayerGateIndex();
 
-    doStackOps(mplsPacket, outLabel);
+    doStackOps(mplsPacket, libEntry->outLabel);
 
     if (mplsPacket->hasLabel())
     {
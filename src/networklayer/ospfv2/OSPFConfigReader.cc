@@ -150,6 +150,14 @@ int OSPFConfigReader::getIntAttrOrPar(const cXMLElement& ifConfig, const char *n
     return par(name).longValue();
 }
 
+double OSPFConfigReader::getDoubleAttrOrPar(const cXMLElement& ifConfig, const char *name) const
+{
+    const char* attrStr = ifConfig.getAttribute(name);
+    if (attrStr && *attrStr)
+        return atof(attrStr);
+    return par(name).doubleValue();
+}
+
 bool OSPFConfigReader::getBoolAttrOrPar(const cXMLElement& ifConfig, const char *name) const
 {
     const char* attrStr = ifConfig.getAttribute(name);
@@ -245,6 +253,13 @@ void OSPFConfigReader::loadInterfaceParameters(const cXMLElement& ifConfig)
 
     intf->setTransmissionDelay(getIntAttrOrPar(ifConfig, "interfaceTransmissionDelay"));
 
+    intf->setUpdatePackingDelay(getDoubleAttrOrPar(ifConfig, "updatePackingDelay"));
+    if (intf->getUpdatePackingDelay() >= intf->getRetransmissionInterval()) {
+        // the retransmission timer starts when the LSA is queued, so it must not expire before the update is sent
+        throw cRuntimeError("updatePackingDelay must be smaller than retransmissionInterval for interface %s (ifIndex=%d) at %s",
+                ie->getName(), ifIndex, ifConfig.getSourceLocation());
+    }
+
     if (interfaceType == "BroadcastInterface" || interfaceType == "NBMAInterface")
         intf->setRouterPriority(getIntAttrOrPar(ifConfig, "routerPriority"));
 
@@ -395,6 +410,13 @@ void OSPFConfigReader::loadVirtualLink(const cXMLElement& virtualLinkConfig)
 
     intf->setTransmissionDelay(getIntAttrOrPar(virtualLinkConfig, "interfaceTransmissionDelay"));
 
+    intf->setUpdatePackingDelay(getDoubleAttrOrPar(virtualLinkConfig, "updatePackingDelay"));
+    if (intf->getUpdatePackingDelay() >= intf->getRetransmissionInterval()) {
+        // the retransmission timer starts when the LSA is queued, so it must not expire before the update is sent
+        throw cRuntimeError("updatePackingDelay must be smaller than retransmissionInterval for VirtualLink to %s at %s",
+                endPoint.c_str(), virtualLinkConfig.getSourceLocation());
+    }
+
     intf->setHelloInterval(getIntAttrOrPar(virtualLinkConfig, "helloInterval"));
 
     intf->setRouterDeadInterval(getIntAttrOrPar(virtualLinkConfig, "routerDeadInterval"));
@@ -446,6 +468,10 @@ bool OSPFConfigReader::loadConfigFromXML(cXMLElement *asConfig, OSPF::Router *os
 
     bool rfc1583Compatible = getBoolAttrOrPar(*routerNode, "RFC1583Compatible");
     ospfRouter->setRFC1583Compatibility(rfc1583Compatible);
+    ospfRouter->setIncrementalSPF(getBoolAttrOrPar(*routerNode, "incrementalSPF"));
+    ospfRouter->setSPFThrottling(getDoubleAttrOrPar(*routerNode, "spfInitialDelay"),
+                                 getDoubleAttrOrPar(*routerNode, "spfHoldTime"),
+                                 getDoubleAttrOrPar(*routerNode, "spfMaxHoldTime"));
 
     std::set<OSPF::AreaID> areaList;
     getAreaListFromXML(*routerNode, areaList);
@@ -41,6 +41,7 @@ class INET_API OSPFConfigReader
 
     cPar& par(const char *name) const  {return ospfModule->par(name);}
     int getIntAttrOrPar(const cXMLElement& ifConfig, const char *name) const;
+    double getDoubleAttrOrPar(const cXMLElement& ifConfig, const char *name) const;
     bool getBoolAttrOrPar(const cXMLElement& ifConfig, const char *name) const;
     const char *getStrAttrOrPar(const cXMLElement& ifConfig, const char *name) const;
 
@@ -46,6 +46,7 @@ OSPF::Interface::Interface(OSPF::Interface::OSPFInterfaceType ifType) :
     interfaceOutputCost(1),
     retransmissionInterval(5),
     acknowledgementDelay(1),
+    updatePackingDelay(0),
     authenticationType(OSPF::NULL_TYPE),
     parentArea(NULL)
 {
@@ -63,6 +64,10 @@ OSPF::Interface::Interface(OSPF::Interface::OSPFInterfaceType ifType) :
     acknowledgementTimer->setKind(INTERFACE_ACKNOWLEDGEMENT_TIMER);
     acknowledgementTimer->setContextPointer(this);
     acknowledgementTimer->setName("OSPF::Interface::InterfaceAcknowledgementTimer");
+    updateTimer = new cMessage();
+    updateTimer->setKind(INTERFACE_UPDATE_TIMER);
+    updateTimer->setContextPointer(this);
+    updateTimer->setName("OSPF::Interface::InterfaceUpdateTimer");
     memset(authenticationKey.bytes, 0, 8 * sizeof(char));
 }
 
@@ -75,6 +80,9 @@ OSPF::Interface::~Interface()
     delete waitTimer;
     messageHandler->clearTimer(acknowledgementTimer);
     delete acknowledgementTimer;
+    messageHandler->clearTimer(updateTimer);
+    delete updateTimer;
+    clearDelayedUpdates();
     if (previousState != NULL) {
         delete previousState;
     }
@@ -116,6 +124,8 @@ void OSPF::Interface::reset()
     messageHandler->clearTimer(helloTimer);
     messageHandler->clearTimer(waitTimer);
     messageHandler->clearTimer(acknowledgementTimer);
+    messageHandler->clearTimer(updateTimer);
+    clearDelayedUpdates();
     designatedRouter = NULL_DESIGNATEDROUTERID;
     backupDesignatedRouter = NULL_DESIGNATEDROUTERID;
     long neighborCount = neighboringRouters.size();
@@ -340,66 +350,59 @@ bool OSPF::Interface::floodLSA(OSPFLSA* lsa, OSPF::Interface* intf, OSPF::Neighb
                  (neighbor->getNeighborID() != backupDesignatedRouter.routerID)))  // (3)
             {
                 if ((intf != this) || (getState() != OSPF::Interface::BACKUP_STATE)) {  // (4)
-                    OSPFLinkStateUpdatePacket* updatePacket = createUpdatePacket(lsa);    // (5)
-
-                    if (updatePacket != NULL) {
-                        int ttl = (interfaceType == OSPF::Interface::VIRTUAL) ? VIRTUAL_LINK_TTL : 1;
-                        OSPF::MessageHandler* messageHandler = parentArea->getRouter()->getMessageHandler();
-
-                        if (interfaceType == OSPF::Interface::BROADCAST) {
-                            if ((getState() == OSPF::Interface::DESIGNATED_ROUTER_STATE) ||
-                                (getState() == OSPF::Interface::BACKUP_STATE) ||
-                                (designatedRouter == OSPF::NULL_DESIGNATEDROUTERID))
-                            {
-                                messageHandler->sendPacket(updatePacket, IPv4Address::ALL_OSPF_ROUTERS_MCAST, ifIndex, ttl);
-                                for (long k = 0; k < neighborCount; k++) {
-                                    neighboringRouters[k]->addToTransmittedLSAList(lsaKey);
-                                    if (!neighboringRouters[k]->isUpdateRetransmissionTimerActive()) {
-                                        neighboringRouters[k]->startUpdateRetransmissionTimer();
-                                    }
+                    if (interfaceType == OSPF::Interface::BROADCAST) {
+                        if ((getState() == OSPF::Interface::DESIGNATED_ROUTER_STATE) ||
+                            (getState() == OSPF::Interface::BACKUP_STATE) ||
+                            (designatedRouter == OSPF::NULL_DESIGNATEDROUTERID))
+                        {
+                            sendUpdatePacket(lsa, IPv4Address::ALL_OSPF_ROUTERS_MCAST);    // (5)
+                            for (long k = 0; k < neighborCount; k++) {
+                                neighboringRouters[k]->addToTransmittedLSAList(lsaKey);
+                                if (!neighboringRouters[k]->isUpdateRetransmissionTimerActive()) {
+                                    neighboringRouters[k]->startUpdateRetransmissionTimer();
                                 }
-                            } else {
-                                messageHandler->sendPacket(updatePacket, IPv4Address::ALL_OSPF_DESIGNATED_ROUTERS_MCAST, ifIndex, ttl);
-                                OSPF::Neighbor* dRouter = getNeighborByID(designatedRouter.routerID);
-                                OSPF::Neighbor* backupDRouter = getNeighborByID(backupDesignatedRouter.routerID);
-                                if (dRouter != NULL) {
-                                    dRouter->addToTransmittedLSAList(lsaKey);
-                                    if (!dRouter->isUpdateRetransmissionTimerActive()) {
-                                        dRouter->startUpdateRetransmissionTimer();
-                                    }
+                            }
+                        } else {
+                            sendUpdatePacket(lsa, IPv4Address::ALL_OSPF_DESIGNATED_ROUTERS_MCAST);    // (5)
+                            OSPF::Neighbor* dRouter = getNeighborByID(designatedRouter.routerID);
+                            OSPF::Neighbor* backupDRouter = getNeighborByID(backupDesignatedRouter.routerID);
+                            if (dRouter != NULL) {
+                                dRouter->addToTransmittedLSAList(lsaKey);
+                                if (!dRouter->isUpdateRetransmissionTimerActive()) {
+                                    dRouter->startUpdateRetransmissionTimer();
                                 }
-                                if (backupDRouter != NULL) {
-                                    backupDRouter->addToTransmittedLSAList(lsaKey);
-                                    if (!backupDRouter->isUpdateRetransmissionTimerActive()) {
-                                        backupDRouter->startUpdateRetransmissionTimer();
-                                    }
+                            }
+                            if (backupDRouter != NULL) {
+                                backupDRouter->addToTransmittedLSAList(lsaKey);
+                                if (!backupDRouter->isUpdateRetransmissionTimerActive()) {
+                                    backupDRouter->startUpdateRetransmissionTimer();
                                 }
                             }
-                        } else {
-                            if (interfaceType == OSPF::Interface::POINTTOPOINT) {
-                                messageHandler->sendPacket(updatePacket, IPv4Address::ALL_OSPF_ROUTERS_MCAST, ifIndex, ttl);
-                                if (neighborCount > 0) {
-                                    neighboringRouters[0]->addToTransmittedLSAList(lsaKey);
-                                    if (!neighboringRouters[0]->isUpdateRetransmissionTimerActive()) {
-                                        neighboringRouters[0]->startUpdateRetransmissionTimer();
-                                    }
+                        }
+                    } else {
+                        if (interfaceType == OSPF::Interface::POINTTOPOINT) {
+                            sendUpdatePacket(lsa, IPv4Address::ALL_OSPF_ROUTERS_MCAST);    // (5)
+                            if (neighborCount > 0) {
+                                neighboringRouters[0]->addToTransmittedLSAList(lsaKey);
+                                if (!neighboringRouters[0]->isUpdateRetransmissionTimerActive()) {
+                                    neighboringRouters[0]->startUpdateRetransmissionTimer();
                                 }
-                            } else {
-                                for (long m = 0; m < neighborCount; m++) {
-                                    if (neighboringRouters[m]->getState() >= OSPF::Neighbor::EXCHANGE_STATE) {
-                                        messageHandler->sendPacket(updatePacket, neighboringRouters[m]->getAddress(), ifIndex, ttl);
-                                        neighboringRouters[m]->addToTransmittedLSAList(lsaKey);
-                                        if (!neighboringRouters[m]->isUpdateRetransmissionTimerActive()) {
-                                            neighboringRouters[m]->startUpdateRetransmissionTimer();
-                                        }
+                            }
+                        } else {
+                            for (long m = 0; m < neighborCount; m++) {
+                                if (neighboringRouters[m]->getState() >= OSPF::Neighbor::EXCHANGE_STATE) {
+                                    sendUpdatePacket(lsa, neighboringRouters[m]->getAddress());    // (5)
+                                    neighboringRouters[m]->addToTransmittedLSAList(lsaKey);
+                                    if (!neighboringRouters[m]->isUpdateRetransmissionTimerActive()) {
+                                        neighboringRouters[m]->startUpdateRetransmissionTimer();
                                     }
                                 }
                             }
                         }
+                    }
 
-                        if (intf == this) {
-                            floodedBackOut = true;
-                        }
+                    if (intf == this) {
+                        floodedBackOut = true;
                     }
                 }
             }
@@ -409,6 +412,97 @@ bool OSPF::Interface::floodLSA(OSPFLSA* lsa, OSPF::Interface* intf, OSPF::Neighb
     return floodedBackOut;
 }
 
+void OSPF::Interface::sendUpdatePacket(OSPFLSA* lsa, IPv4Address destination)
+{
+    if (updatePackingDelay == 0) {
+        OSPFLinkStateUpdatePacket* updatePacket = createUpdatePacket(lsa);
+        if (updatePacket != NULL) {
+            int ttl = (interfaceType == OSPF::Interface::VIRTUAL) ? VIRTUAL_LINK_TTL : 1;
+            parentArea->getRouter()->getMessageHandler()->sendPacket(updatePacket, destination, ifIndex, ttl);
+        }
+        return;
+    }
+
+    // the LSAs flooded to the same destination within updatePackingDelay are sent in as few
+    // Link State Update packets as possible; a newer instance replaces the one still waiting
+    std::list<DelayedUpdate>& updates = delayedUpdates[destination];
+    DelayedUpdate update;
+    update.lsa = lsa->dup();
+    update.enqueueTime = simTime();
+    const OSPFLSAHeader& lsaHeader = lsa->getHeader();
+
+    for (std::list<DelayedUpdate>::iterator updateIt = updates.begin(); updateIt != updates.end(); updateIt++) {
+        const OSPFLSAHeader& delayedHeader = updateIt->lsa->getHeader();
+        if ((delayedHeader.getLsType() == lsaHeader.getLsType()) &&
+            (delayedHeader.getLinkStateID() == lsaHeader.getLinkStateID()) &&
+            (delayedHeader.getAdvertisingRouter() == lsaHeader.getAdvertisingRouter()))
+        {
+            delete updateIt->lsa;
+            *updateIt = update;
+            return;
+        }
+    }
+    updates.push_back(update);
+    if (!updateTimer->isScheduled()) {
+        parentArea->getRouter()->getMessageHandler()->startTimer(updateTimer, updatePackingDelay);
+    }
+}
+
+void OSPF::Interface::sendDelayedUpdates()
+{
+    OSPF::MessageHandler* messageHandler = parentArea->getRouter()->getMessageHandler();
+    long maxPacketSize = ((IP_MAX_HEADER_BYTES + OSPF_HEADER_LENGTH + OSPF_LSA_HEADER_LENGTH) > mtu) ? IPV4_DATAGRAM_LENGTH : mtu;
+    int ttl = (interfaceType == OSPF::Interface::VIRTUAL) ? VIRTUAL_LINK_TTL : 1;
+
+    for (std::map<IPv4Address, std::list<DelayedUpdate> >::iterator delayIt = delayedUpdates.begin();
+         delayIt != delayedUpdates.end();
+         delayIt++)
+    {
+        std::list<DelayedUpdate>& updates = delayIt->second;
+        for (std::list<DelayedUpdate>::iterator updateIt = updates.begin(); updateIt != updates.end(); updateIt++) {
+            // the copy was taken when the LSA was flooded; add the whole seconds it has been waiting since
+            OSPFLSAHeader& lsaHeader = updateIt->lsa->getHeader();
+            double queueingTime = floor(SIMTIME_DBL(simTime() - updateIt->enqueueTime));
+            if (lsaHeader.getLsAge() + queueingTime < MAX_AGE) {
+                lsaHeader.setLsAge(lsaHeader.getLsAge() + (unsigned short)queueingTime);
+            } else {
+                lsaHeader.setLsAge(MAX_AGE);
+            }
+        }
+        while (!updates.empty()) {
+            // the first LSA goes into the packet even if it does not fit into the MTU
+            OSPFLinkStateUpdatePacket* updatePacket = createUpdatePacket(updates.front().lsa);
+            delete updates.front().lsa;
+            updates.pop_front();
+            if (updatePacket == NULL) {
+                continue;
+            }
+            while ((!updates.empty()) &&
+                   (IP_MAX_HEADER_BYTES + updatePacket->getByteLength() + calculateLSASize(updates.front().lsa) <= maxPacketSize))
+            {
+                addToUpdatePacket(updatePacket, updates.front().lsa);
+                delete updates.front().lsa;
+                updates.pop_front();
+            }
+            messageHandler->sendPacket(updatePacket, delayIt->first, ifIndex, ttl);
+        }
+    }
+    delayedUpdates.clear();
+}
+
+void OSPF::Interface::clearDelayedUpdates()
+{
+    for (std::map<IPv4Address, std::list<DelayedUpdate> >::iterator delayIt = delayedUpdates.begin();
+         delayIt != delayedUpdates.end();
+         delayIt++)
+    {
+        for (std::list<DelayedUpdate>::iterator updateIt = delayIt->second.begin(); updateIt != delayIt->second.end(); updateIt++) {
+            delete updateIt->lsa;
+        }
+    }
+    delayedUpdates.clear();
+}
+
 OSPFLinkStateUpdatePacket* OSPF::Interface::createUpdatePacket(OSPFLSA* lsa)
 {
     LSAType lsaType = static_cast<LSAType> (lsa->getHeader().getLsType());
@@ -424,7 +518,6 @@ OSPFLinkStateUpdatePacket* OSPF::Interface::createUpdatePacket(OSPFLSA* lsa)
         ((lsaType == AS_EXTERNAL_LSA_TYPE) && (asExternalLSA != NULL)))
     {
         OSPFLinkStateUpdatePacket* updatePacket = new OSPFLinkStateUpdatePacket();
-        long packetLength = OSPF_HEADER_LENGTH + sizeof(uint32_t);  // OSPF header + place for number of advertisements
 
         updatePacket->setType(LINKSTATE_UPDATE_PACKET);
         updatePacket->setRouterID(IPv4Address(parentArea->getRouter()->getRouterID()));
@@ -434,70 +527,92 @@ OSPFLinkStateUpdatePacket* OSPF::Interface::createUpdatePacket(OSPFLSA* lsa)
             updatePacket->setAuthentication(j, authenticationKey.bytes[j]);
         }
 
-        updatePacket->setNumberOfLSAs(1);
+        updatePacket->setNumberOfLSAs(0);
+        updatePacket->setByteLength(OSPF_HEADER_LENGTH + sizeof(uint32_t));  // OSPF header + place for number of advertisements
 
-        switch (lsaType) {
-            case ROUTERLSA_TYPE:
-                {
-                    updatePacket->setRouterLSAsArraySize(1);
-                    updatePacket->setRouterLSAs(0, *routerLSA);
-                    unsigned short lsAge = updatePacket->getRouterLSAs(0).getHeader().getLsAge();
-                    if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
-                        updatePacket->getRouterLSAs(0).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
-                    } else {
-                        updatePacket->getRouterLSAs(0).getHeader().setLsAge(MAX_AGE);
-                    }
-                    packetLength += calculateLSASize(routerLSA);
+        addToUpdatePacket(updatePacket, lsa);
+
+        return updatePacket;
+    }
+    return NULL;
+}
+
+void OSPF::Interface::addToUpdatePacket(OSPFLinkStateUpdatePacket* updatePacket, OSPFLSA* lsa)
+{
+    LSAType lsaType = static_cast<LSAType> (lsa->getHeader().getLsType());
+    long packetLength = updatePacket->getByteLength();
+
+    switch (lsaType) {
+        case ROUTERLSA_TYPE:
+            {
+                OSPFRouterLSA* routerLSA = check_and_cast<OSPFRouterLSA*> (lsa);
+                unsigned int routerLSACount = updatePacket->getRouterLSAsArraySize();
+
+                updatePacket->setRouterLSAsArraySize(routerLSACount + 1);
+                updatePacket->setRouterLSAs(routerLSACount, *routerLSA);
+                unsigned short lsAge = updatePacket->getRouterLSAs(routerLSACount).getHeader().getLsAge();
+                if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
+                    updatePacket->getRouterLSAs(routerLSACount).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
+                } else {
+                    updatePacket->getRouterLSAs(routerLSACount).getHeader().setLsAge(MAX_AGE);
                 }
-                break;
-            case NETWORKLSA_TYPE:
-                {
-                    updatePacket->setNetworkLSAsArraySize(1);
-                    updatePacket->setNetworkLSAs(0, *networkLSA);
-                    unsigned short lsAge = updatePacket->getNetworkLSAs(0).getHeader().getLsAge();
-                    if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
-                        updatePacket->getNetworkLSAs(0).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
-                    } else {
-                        updatePacket->getNetworkLSAs(0).getHeader().setLsAge(MAX_AGE);
-                    }
-                    packetLength += calculateLSASize(networkLSA);
+                packetLength += calculateLSASize(routerLSA);
+            }
+            break;
+        case NETWORKLSA_TYPE:
+            {
+                OSPFNetworkLSA* networkLSA = check_and_cast<OSPFNetworkLSA*> (lsa);
+                unsigned int networkLSACount = updatePacket->getNetworkLSAsArraySize();
+
+                updatePacket->setNetworkLSAsArraySize(networkLSACount + 1);
+                updatePacket->setNetworkLSAs(networkLSACount, *networkLSA);
+                unsigned short lsAge = updatePacket->getNetworkLSAs(networkLSACount).getHeader().getLsAge();
+                if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
+                    updatePacket->getNetworkLSAs(networkLSACount).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
+                } else {
+                    updatePacket->getNetworkLSAs(networkLSACount).getHeader().setLsAge(MAX_AGE);
                 }
-                break;
-            case SUMMARYLSA_NETWORKS_TYPE:
-            case SUMMARYLSA_ASBOUNDARYROUTERS_TYPE:
-                {
-                    updatePacket->setSummaryLSAsArraySize(1);
-                    updatePacket->setSummaryLSAs(0, *summaryLSA);
-                    unsigned short lsAge = updatePacket->getSummaryLSAs(0).getHeader().getLsAge();
-                    if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
-                        updatePacket->getSummaryLSAs(0).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
-                    } else {
-                        updatePacket->getSummaryLSAs(0).getHeader().setLsAge(MAX_AGE);
-                    }
-                    packetLength += calculateLSASize(summaryLSA);
+                packetLength += calculateLSASize(networkLSA);
+            }
+            break;
+        case SUMMARYLSA_NETWORKS_TYPE:
+        case SUMMARYLSA_ASBOUNDARYROUTERS_TYPE:
+            {
+                OSPFSummaryLSA* summaryLSA = check_and_cast<OSPFSummaryLSA*> (lsa);
+                unsigned int summaryLSACount = updatePacket->getSummaryLSAsArraySize();
+
+                updatePacket->setSummaryLSAsArraySize(summaryLSACount + 1);
+                updatePacket->setSummaryLSAs(summaryLSACount, *summaryLSA);
+                unsigned short lsAge = updatePacket->getSummaryLSAs(summaryLSACount).getHeader().getLsAge();
+                if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
+                    updatePacket->getSummaryLSAs(summaryLSACount).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
+                } else {
+                    updatePacket->getSummaryLSAs(summaryLSACount).getHeader().setLsAge(MAX_AGE);
                 }
-                break;
-            case AS_EXTERNAL_LSA_TYPE:
-                {
-                    updatePacket->setAsExternalLSAsArraySize(1);
-                    updatePacket->setAsExternalLSAs(0, *asExternalLSA);
-                    unsigned short lsAge = updatePacket->getAsExternalLSAs(0).getHeader().getLsAge();
-                    if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
-                        updatePacket->getAsExternalLSAs(0).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
-                    } else {
-                        updatePacket->getAsExternalLSAs(0).getHeader().setLsAge(MAX_AGE);
-                    }
-                    packetLength += calculateLSASize(asExternalLSA);
+                packetLength += calculateLSASize(summaryLSA);
+            }
+            break;
+        case AS_EXTERNAL_LSA_TYPE:
+            {
+                OSPFASExternalLSA* asExternalLSA = check_and_cast<OSPFASExternalLSA*> (lsa);
+                unsigned int asExternalLSACount = updatePacket->getAsExternalLSAsArraySize();
+
+                updatePacket->setAsExternalLSAsArraySize(asExternalLSACount + 1);
+                updatePacket->setAsExternalLSAs(asExternalLSACount, *asExternalLSA);
+                unsigned short lsAge = updatePacket->getAsExternalLSAs(asExternalLSACount).getHeader().getLsAge();
+                if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
+                    updatePacket->getAsExternalLSAs(asExternalLSACount).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
+                } else {
+                    updatePacket->getAsExternalLSAs(asExternalLSACount).getHeader().setLsAge(MAX_AGE);
                 }
-                break;
-            default: throw cRuntimeError("Invalid LSA type: %d", lsaType);
-        }
-
-        updatePacket->setByteLength(packetLength);
-
-        return updatePacket;
+                packetLength += calculateLSASize(asExternalLSA);
+            }
+            break;
+        default: throw cRuntimeError("Invalid LSA type: %d", lsaType);
     }
-    return NULL;
+
+    updatePacket->setNumberOfLSAs(updatePacket->getNumberOfLSAs() + 1);
+    updatePacket->setByteLength(packetLength);
 }
 
 void OSPF::Interface::addDelayedAcknowledgement(OSPFLSAHeader& lsaHeader)
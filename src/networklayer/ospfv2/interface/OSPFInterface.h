@@ -67,6 +67,11 @@ public:
     };
 
 private:
+    struct DelayedUpdate {
+        OSPFLSA*    lsa;
+        simtime_t   enqueueTime;    // the LSA is aged by the time it spends in the queue
+    };
+
     OSPFInterfaceType                                                   interfaceType;
     InterfaceState*                                                     state;
     InterfaceState*                                                     previousState;
@@ -83,15 +88,18 @@ private:
     cMessage*                                                           helloTimer;
     cMessage*                                                           waitTimer;
     cMessage*                                                           acknowledgementTimer;
+    cMessage*                                                           updateTimer;
     std::map<RouterID, Neighbor*>                                       neighboringRoutersByID;
     std::map<IPv4Address, Neighbor*>                                    neighboringRoutersByAddress;
     std::vector<Neighbor*>                                              neighboringRouters;
     std::map<IPv4Address, std::list<OSPFLSAHeader> >                    delayedAcknowledgements;
+    std::map<IPv4Address, std::list<DelayedUpdate> >                   delayedUpdates;
     DesignatedRouterID                                                  designatedRouter;
     DesignatedRouterID                                                  backupDesignatedRouter;
     Metric                                                              interfaceOutputCost;
     short                                                               retransmissionInterval;
     short                                                               acknowledgementDelay;
+    simtime_t                                                           updatePackingDelay;
     AuthenticationType                                                  authenticationType;
     AuthenticationKeyType                                               authenticationKey;
 
@@ -99,6 +107,8 @@ private:
 private:
     friend class InterfaceState;
     void changeState(InterfaceState* newState, InterfaceState* currentState);
+    void sendUpdatePacket(OSPFLSA* lsa, IPv4Address destination);
+    void clearDelayedUpdates();
 
 public:
     Interface(OSPFInterfaceType ifType = UNKNOWN_TYPE);
@@ -119,9 +129,11 @@ public:
     bool                floodLSA(OSPFLSA* lsa, Interface* intf = NULL, Neighbor* neighbor = NULL);
     void                addDelayedAcknowledgement(OSPFLSAHeader& lsaHeader);
     void                sendDelayedAcknowledgements();
+    void                sendDelayedUpdates();
     void                ageTransmittedLSALists();
 
     OSPFLinkStateUpdatePacket* createUpdatePacket(OSPFLSA* lsa);
+    void                addToUpdatePacket(OSPFLinkStateUpdatePacket* updatePacket, OSPFLSA* lsa);
 
     void                    setType(OSPFInterfaceType ifType)  { interfaceType = ifType; }
     OSPFInterfaceType       getType() const  { return interfaceType; }
@@ -141,6 +153,8 @@ public:
     short                   getTransmissionDelay() const  { return interfaceTransmissionDelay; }
     void                    setAcknowledgementDelay(short delay)  { acknowledgementDelay = delay; }
     short                   getAcknowledgementDelay() const  { return acknowledgementDelay; }
+    void                    setUpdatePackingDelay(simtime_t delay)  { updatePackingDelay = delay; }
+    simtime_t               getUpdatePackingDelay() const  { return updatePackingDelay; }
     void                    setRouterPriority(unsigned char priority)  { routerPriority = priority; }
     unsigned char           getRouterPriority() const  { return routerPriority; }
     void                    setHelloInterval(short interval)  { helloInterval = interval; }
@@ -159,6 +173,7 @@ public:
     cMessage*               getHelloTimer()  { return helloTimer; }
     cMessage*               getWaitTimer()  { return waitTimer; }
     cMessage*               getAcknowledgementTimer()  { return acknowledgementTimer; }
+    cMessage*               getUpdateTimer()  { return updateTimer; }
     DesignatedRouterID      getDesignatedRouter() const  { return designatedRouter; }
     DesignatedRouterID      getBackupDesignatedRouter() const  { return backupDesignatedRouter; }
     unsigned long           getNeighborCount() const  { return neighboringRouters.size(); }
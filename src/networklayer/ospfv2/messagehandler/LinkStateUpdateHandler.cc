@@ -268,7 +268,7 @@ void OSPF::LinkStateUpdateHandler::processPacket(OSPFPacket* packet, OSPF::Inter
     }
 
     if (shouldRebuildRoutingTable) {
-        router->rebuildRoutingTable();
+        router->scheduleRoutingTableRebuild();
     }
 }
 
@@ -165,6 +165,25 @@ void OSPF::MessageHandler::handleTimer(cMessage* timer)
                 router->ageDatabase();
             }
             break;
+        case INTERFACE_UPDATE_TIMER:
+            {
+                OSPF::Interface* intf;
+                if (! (intf = reinterpret_cast <OSPF::Interface*> (timer->getContextPointer()))) {
+                    // should not reach this point
+                    EV << "Discarding invalid InterfaceUpdateTimer.\n";
+                    delete timer;
+                } else {
+                    printEvent("Update Timer expired", intf);
+                    intf->sendDelayedUpdates();
+                }
+            }
+            break;
+        case ROUTER_SPF_TIMER:
+            {
+                printEvent("SPF Timer expired");
+                router->rebuildRoutingTable();
+            }
+            break;
         default: break;
     }
 }
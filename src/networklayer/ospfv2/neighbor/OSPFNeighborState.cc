@@ -81,6 +81,6 @@ void OSPF::NeighborState::changeState(OSPF::Neighbor* neighbor, OSPF::NeighborSt
     }
 
     if (shouldRebuildRoutingTable) {
-        neighbor->getInterface()->getArea()->getRouter()->rebuildRoutingTable();
+        neighbor->getInterface()->getArea()->getRouter()->scheduleRoutingTableRebuild();
     }
 }
@@ -103,6 +103,22 @@ unsigned int calculateLSASize(const OSPFASExternalLSA* asExternalLSA)
             (asExternalLSA->getContents().getExternalTOSInfoArraySize() * OSPF_ASEXTERNALLSA_TOS_INFO_LENGTH));
 }
 
+unsigned int calculateLSASize(const OSPFLSA* lsa)
+{
+    switch (lsa->getHeader().getLsType()) {
+        case ROUTERLSA_TYPE:
+            return calculateLSASize(check_and_cast<const OSPFRouterLSA*> (lsa));
+        case NETWORKLSA_TYPE:
+            return calculateLSASize(check_and_cast<const OSPFNetworkLSA*> (lsa));
+        case SUMMARYLSA_NETWORKS_TYPE:
+        case SUMMARYLSA_ASBOUNDARYROUTERS_TYPE:
+            return calculateLSASize(check_and_cast<const OSPFSummaryLSA*> (lsa));
+        case AS_EXTERNAL_LSA_TYPE:
+            return calculateLSASize(check_and_cast<const OSPFASExternalLSA*> (lsa));
+        default: throw cRuntimeError("Invalid LSA type: %d", lsa->getHeader().getLsType());
+    }
+}
+
 void printLSAHeader(const OSPFLSAHeader& lsaHeader, std::ostream& output) {
     output << "LSAHeader: age=" << lsaHeader.getLsAge()
            << ", type=";
@@ -188,6 +188,7 @@ unsigned int calculateLSASize(const OSPFRouterLSA* routerLSA);
 unsigned int calculateLSASize(const OSPFNetworkLSA* networkLSA);
 unsigned int calculateLSASize(const OSPFSummaryLSA* summaryLSA);
 unsigned int calculateLSASize(const OSPFASExternalLSA* asExternalLSA);
+unsigned int calculateLSASize(const OSPFLSA* lsa);
 void printLSAHeader(const OSPFLSAHeader& lsaHeader, std::ostream& output);
 
 inline std::ostream& operator<<(std::ostream& ostr, const OSPFLSA& lsa)
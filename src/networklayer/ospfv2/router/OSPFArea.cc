@@ -18,6 +18,12 @@
 #include "OSPFArea.h"
 #include "OSPFRouter.h"
 #include <memory.h>
+#include <algorithm>
+#include <climits>
+#include <set>
+
+
+static const unsigned long SPF_UNREACHABLE = ULONG_MAX;
 
 OSPF::Area::Area(OSPF::AreaID id) :
     areaID(id),
@@ -659,7 +665,7 @@ void OSPF::Area::ageDatabase()
     }
 
     if (shouldRebuildRoutingTable) {
-        parentRouter->rebuildRoutingTable();
+        parentRouter->scheduleRoutingTableRebuild();
     }
 }
 
@@ -1346,15 +1352,30 @@ OSPF::SummaryLSA* OSPF::Area::originateSummaryLSA(const OSPF::SummaryLSA* summar
     return NULL;
 }
 
+/**
+ * Calculates the shortest path tree of the area (RFC 2328 16.1) and adds the intra-area
+ * routes to newRoutingTable.
+ *
+ * The router and network LSAs are turned into a graph of their usable (two-way, not MaxAge)
+ * links first. The distances are calculated with a binary heap; the vertices join the tree
+ * in the order of distance, then networks before routers (16.1 (3)), then link state ID.
+ * The parent of a vertex is the first vertex on the tree having a link to it, and its next
+ * hops are collected from all parents on a shortest path in that order, as in 16.1 (2) (d).
+ *
+ * With incremental SPF, the graph of the previous calculation is kept: only the vertices
+ * whose shortest path used a removed or more expensive link are taken off the tree and
+ * re-added, and cheaper or new links are propagated from their endpoints; next hops are only
+ * recalculated where the distance, the links or the next hops of a parent have changed.
+ * The routing table entries are rebuilt from the whole tree in both cases.
+ */
 void OSPF::Area::calculateShortestPathTree(std::vector<OSPF::RoutingTableEntry*>& newRoutingTable)
 {
     OSPF::RouterID routerID = parentRouter->getRouterID();
-    bool finished = false;
     std::vector<OSPFLSA*> treeVertices;
     OSPFLSA* justAddedVertex;
-    std::vector<OSPFLSA*> candidateVertices;
+    std::vector<SPFVertex> vertices;
+    std::map<uint64, int> vertexIndex;
     unsigned long            i, j, k;
-    unsigned long lsaCount;
 
     if (spfTreeRoot == NULL) {
         OSPF::RouterLSA* newLSA = originateRouterLSA();
@@ -1371,278 +1392,145 @@ void OSPF::Area::calculateShortestPathTree(std::vector<OSPF::RoutingTableEntry*>
         return;
     }
 
-    lsaCount = routerLSAs.size();
-    for (i = 0; i < lsaCount; i++) {
-        routerLSAs[i]->clearNextHops();
-    }
-    lsaCount = networkLSAs.size();
-    for (i = 0; i < lsaCount; i++) {
-        networkLSAs[i]->clearNextHops();
-    }
-    spfTreeRoot->setDistance(0);
-    treeVertices.push_back(spfTreeRoot);
-    justAddedVertex = spfTreeRoot;          // (1)
+    buildSPFGraph(vertices, vertexIndex);
+    int root = vertexIndex[getSPFVertexKey(ROUTERLSA_TYPE, spfTreeRoot->getHeader().getLinkStateID())];
+    std::vector<bool> dirty(vertices.size(), true);
 
-    do {
-        LSAType vertexType = static_cast<LSAType> (justAddedVertex->getHeader().getLsType());
+    bool incremental = parentRouter->getIncrementalSPF() && !spfVertices.empty();
+    if (incremental) {
+        updateSPFDistances(vertices, vertexIndex, root, dirty);
+    } else {
+        calculateSPFDistances(vertices, root);
+    }
 
-        if ((vertexType == ROUTERLSA_TYPE)) {
-            OSPF::RouterLSA* routerVertex = check_and_cast<OSPF::RouterLSA*> (justAddedVertex);
-            if (routerVertex->getV_VirtualLinkEndpoint()) {    // (2)
-                transitCapability = true;
+    // (1) .. (3): next hops, in tree order
+    std::set<std::pair<std::pair<unsigned long, uint64>, int> > nextHopQueue;
+    for (i = 0; i < vertices.size(); i++) {
+        SPFVertex& vertex = vertices[i];
+        OSPF::RoutingInfo* routingInfo = check_and_cast<OSPF::RoutingInfo*> (vertex.lsa);
+        routingInfo->clearNextHops();
+        if ((vertex.distance == SPF_UNREACHABLE) || ((int)i == root)) {
+            vertex.nextHops.clear();
+            continue;
+        }
+        if (dirty[i]) {
+            nextHopQueue.insert(std::make_pair(std::make_pair(vertex.distance, vertex.key), (int)i));
+        } else {
+            // unchanged since the last calculation, but the LSA object may be a new one
+            routingInfo->setDistance(vertex.distance);
+            routingInfo->setParent(vertices[vertex.parent].lsa);
+            for (j = 0; j < vertex.nextHops.size(); j++) {
+                routingInfo->addNextHop(vertex.nextHops[j]);
             }
-
-            unsigned int linkCount = routerVertex->getLinksArraySize();
-            for (i = 0; i < linkCount; i++) {
-                Link& link = routerVertex->getLinks(i);
-                LinkType linkType = static_cast<LinkType> (link.getType());
-                OSPFLSA* joiningVertex;
-                LSAType joiningVertexType;
-
-                if (linkType == STUB_LINK) {     // (2) (a)
-                    continue;
-                }
-
-                if (linkType == TRANSIT_LINK) {
-                    joiningVertex = findNetworkLSA(link.getLinkID());
-                    joiningVertexType = NETWORKLSA_TYPE;
-                } else {
-                    joiningVertex = findRouterLSA(link.getLinkID());
-                    joiningVertexType = ROUTERLSA_TYPE;
-                }
-
-                if ((joiningVertex == NULL) ||
-                    (joiningVertex->getHeader().getLsAge() == MAX_AGE) ||
-                    (!hasLink(joiningVertex, justAddedVertex)))  // (from, to)     (2) (b)
-                {
-                    continue;
-                }
-
-                unsigned int treeSize = treeVertices.size();
-                bool alreadyOnTree = false;
-
-                for (j = 0; j < treeSize; j++) {
-                    if (treeVertices[j] == joiningVertex) {
-                        alreadyOnTree = true;
-                        break;
-                    }
-                }
-                if (alreadyOnTree) {    // (2) (c)
-                    continue;
-                }
-
-                unsigned long linkStateCost = routerVertex->getDistance() + link.getLinkCost();
-                unsigned int candidateCount = candidateVertices.size();
-                OSPFLSA* candidate = NULL;
-
-                for (j = 0; j < candidateCount; j++) {
-                    if (candidateVertices[j] == joiningVertex) {
-                        candidate = candidateVertices[j];
-                    }
-                }
-                if (candidate != NULL) {    // (2) (d)
-                    OSPF::RoutingInfo* routingInfo = check_and_cast<OSPF::RoutingInfo*> (candidate);
-                    unsigned long candidateDistance = routingInfo->getDistance();
-
-                    if (linkStateCost > candidateDistance) {
-                        continue;
-                    }
-                    if (linkStateCost < candidateDistance) {
-                        routingInfo->setDistance(linkStateCost);
-                        routingInfo->clearNextHops();
-                    }
-                    std::vector<OSPF::NextHop>* newNextHops = calculateNextHops(joiningVertex, justAddedVertex); // (destination, parent)
-                    unsigned int nextHopCount = newNextHops->size();
-                    for (k = 0; k < nextHopCount; k++) {
-                        routingInfo->addNextHop((*newNextHops)[k]);
-                    }
-                    delete newNextHops;
-                } else {
-                    if (joiningVertexType == ROUTERLSA_TYPE) {
-                        OSPF::RouterLSA* joiningRouterVertex = check_and_cast<OSPF::RouterLSA*> (joiningVertex);
-                        joiningRouterVertex->setDistance(linkStateCost);
-                        std::vector<OSPF::NextHop>* newNextHops = calculateNextHops(joiningVertex, justAddedVertex); // (destination, parent)
-                        unsigned int nextHopCount = newNextHops->size();
-                        for (k = 0; k < nextHopCount; k++) {
-                            joiningRouterVertex->addNextHop((*newNextHops)[k]);
-                        }
-                        delete newNextHops;
-                        OSPF::RoutingInfo* vertexRoutingInfo = check_and_cast<OSPF::RoutingInfo*> (joiningRouterVertex);
-                        vertexRoutingInfo->setParent(justAddedVertex);
-
-                        candidateVertices.push_back(joiningRouterVertex);
-                    } else {
-                        OSPF::NetworkLSA* joiningNetworkVertex = check_and_cast<OSPF::NetworkLSA*> (joiningVertex);
-                        joiningNetworkVertex->setDistance(linkStateCost);
-                        std::vector<OSPF::NextHop>* newNextHops = calculateNextHops(joiningVertex, justAddedVertex); // (destination, parent)
-                        unsigned int nextHopCount = newNextHops->size();
-                        for (k = 0; k < nextHopCount; k++) {
-                            joiningNetworkVertex->addNextHop((*newNextHops)[k]);
-                        }
-                        delete newNextHops;
-                        OSPF::RoutingInfo* vertexRoutingInfo = check_and_cast<OSPF::RoutingInfo*> (joiningNetworkVertex);
-                        vertexRoutingInfo->setParent(justAddedVertex);
-
-                        candidateVertices.push_back(joiningNetworkVertex);
-                    }
+        }
+    }
+    spfTreeRoot->setDistance(0);
+    while (!nextHopQueue.empty()) {
+        std::pair<unsigned long, uint64> order = nextHopQueue.begin()->first;
+        int v = nextHopQueue.begin()->second;
+        nextHopQueue.erase(nextHopQueue.begin());
+        if (calculateSPFNextHops(vertices, v) && incremental) {
+            // the children calculate their next hops from ours
+            for (j = 0; j < vertices[v].edges.size(); j++) {
+                const SPFVertex& child = vertices[vertices[v].edges[j].vertex];
+                if ((child.distance != SPF_UNREACHABLE) && (std::make_pair(child.distance, child.key) > order)) {
+                    nextHopQueue.insert(std::make_pair(std::make_pair(child.distance, child.key), vertices[v].edges[j].vertex));
                 }
             }
         }
+    }
 
-        if ((vertexType == NETWORKLSA_TYPE)) {
-            OSPF::NetworkLSA* networkVertex = check_and_cast<OSPF::NetworkLSA*> (justAddedVertex);
-            unsigned int routerCount = networkVertex->getAttachedRoutersArraySize();
-
-            for (i = 0; i < routerCount; i++) {     // (2)
-                OSPF::RouterLSA* joiningVertex = findRouterLSA(networkVertex->getAttachedRouters(i));
-                if ((joiningVertex == NULL) ||
-                    (joiningVertex->getHeader().getLsAge() == MAX_AGE) ||
-                    (!hasLink(joiningVertex, justAddedVertex)))  // (from, to)     (2) (b)
-                {
-                    continue;
-                }
+    std::vector<std::pair<std::pair<unsigned long, uint64>, int> > treeOrder;
+    for (i = 0; i < vertices.size(); i++) {
+        if ((vertices[i].distance != SPF_UNREACHABLE) && ((int)i != root)) {
+            treeOrder.push_back(std::make_pair(std::make_pair(vertices[i].distance, vertices[i].key), (int)i));
+        }
+    }
+    std::sort(treeOrder.begin(), treeOrder.end());
+    treeVertices.push_back(spfTreeRoot);
+    for (i = 0; i < treeOrder.size(); i++) {
+        treeVertices.push_back(vertices[treeOrder[i].second].lsa);
+    }
 
-                unsigned int treeSize = treeVertices.size();
-                bool alreadyOnTree = false;
+    unsigned int treeSize = treeVertices.size();
+    for (i = 0; i < treeSize; i++) {
+        OSPF::RouterLSA* routerVertex = dynamic_cast<OSPF::RouterLSA*> (treeVertices[i]);
+        if ((routerVertex != NULL) && routerVertex->getV_VirtualLinkEndpoint()) {    // (2)
+            transitCapability = true;
+        }
+    }
 
-                for (j = 0; j < treeSize; j++) {
-                    if (treeVertices[j] == joiningVertex) {
-                        alreadyOnTree = true;
-                        break;
-                    }
-                }
-                if (alreadyOnTree) {    // (2) (c)
-                    continue;
-                }
+    justAddedVertex = spfTreeRoot;
+    for (unsigned long n = 1; n < treeSize; n++) {
+        OSPFLSA* closestVertex = treeVertices[n];
 
-                unsigned long linkStateCost = networkVertex->getDistance();   // link cost from network to router is always 0
-                unsigned int candidateCount = candidateVertices.size();
-                OSPFLSA* candidate = NULL;
+        if (closestVertex->getHeader().getLsType() == ROUTERLSA_TYPE) {
+            OSPF::RouterLSA* routerLSA = check_and_cast<OSPF::RouterLSA*> (closestVertex);
+            if (routerLSA->getB_AreaBorderRouter() || routerLSA->getE_ASBoundaryRouter()) {
+                OSPF::RoutingTableEntry* entry = new OSPF::RoutingTableEntry;
+                OSPF::RouterID destinationID = routerLSA->getHeader().getLinkStateID();
+                unsigned int nextHopCount = routerLSA->getNextHopCount();
+                OSPF::RoutingTableEntry::RoutingDestinationType destinationType = OSPF::RoutingTableEntry::NETWORK_DESTINATION;
 
-                for (j = 0; j < candidateCount; j++) {
-                    if (candidateVertices[j] == joiningVertex) {
-                        candidate = candidateVertices[j];
-                    }
+                entry->setDestination(destinationID);
+                entry->setLinkStateOrigin(routerLSA);
+                entry->setArea(areaID);
+                entry->setPathType(OSPF::RoutingTableEntry::INTRAAREA);
+                entry->setCost(routerLSA->getDistance());
+                if (routerLSA->getB_AreaBorderRouter()) {
+                    destinationType |= OSPF::RoutingTableEntry::AREA_BORDER_ROUTER_DESTINATION;
                 }
-                if (candidate != NULL) {    // (2) (d)
-                    OSPF::RoutingInfo* routingInfo = check_and_cast<OSPF::RoutingInfo*> (candidate);
-                    unsigned long candidateDistance = routingInfo->getDistance();
-
-                    if (linkStateCost > candidateDistance) {
-                        continue;
-                    }
-                    if (linkStateCost < candidateDistance) {
-                        routingInfo->setDistance(linkStateCost);
-                        routingInfo->clearNextHops();
-                    }
-                    std::vector<OSPF::NextHop>* newNextHops = calculateNextHops(joiningVertex, justAddedVertex); // (destination, parent)
-                    unsigned int nextHopCount = newNextHops->size();
-                    for (k = 0; k < nextHopCount; k++) {
-                        routingInfo->addNextHop((*newNextHops)[k]);
-                    }
-                    delete newNextHops;
-                } else {
-                    joiningVertex->setDistance(linkStateCost);
-                    std::vector<OSPF::NextHop>* newNextHops = calculateNextHops(joiningVertex, justAddedVertex); // (destination, parent)
-                    unsigned int nextHopCount = newNextHops->size();
-                    for (k = 0; k < nextHopCount; k++) {
-                        joiningVertex->addNextHop((*newNextHops)[k]);
-                    }
-                    delete newNextHops;
-                    OSPF::RoutingInfo* vertexRoutingInfo = check_and_cast<OSPF::RoutingInfo*> (joiningVertex);
-                    vertexRoutingInfo->setParent(justAddedVertex);
-
-                    candidateVertices.push_back(joiningVertex);
+                if (routerLSA->getE_ASBoundaryRouter()) {
+                    destinationType |= OSPF::RoutingTableEntry::AS_BOUNDARY_ROUTER_DESTINATION;
                 }
-            }
-        }
-
-        if (candidateVertices.empty()) {  // (3)
-            finished = true;
-        } else {
-            unsigned int candidateCount = candidateVertices.size();
-            unsigned long minDistance = LS_INFINITY;
-            OSPFLSA* closestVertex = candidateVertices[0];
-
-            for (i = 0; i < candidateCount; i++) {
-                OSPF::RoutingInfo* routingInfo = check_and_cast<OSPF::RoutingInfo*> (candidateVertices[i]);
-                unsigned long currentDistance = routingInfo->getDistance();
-
-                if (currentDistance < minDistance) {
-                    closestVertex = candidateVertices[i];
-                    minDistance = currentDistance;
-                } else {
-                    if (currentDistance == minDistance) {
-                        if ((closestVertex->getHeader().getLsType() == ROUTERLSA_TYPE) &&
-                            (candidateVertices[i]->getHeader().getLsType() == NETWORKLSA_TYPE))
-                        {
-                            closestVertex = candidateVertices[i];
-                        }
-                    }
+                entry->setDestinationType(destinationType);
+                entry->setOptionalCapabilities(routerLSA->getHeader().getLsOptions());
+                for (i = 0; i < nextHopCount; i++) {
+                    entry->addNextHop(routerLSA->getNextHop(i));
                 }
-            }
 
-            treeVertices.push_back(closestVertex);
+                newRoutingTable.push_back(entry);
 
-            for (std::vector<OSPFLSA*>::iterator it = candidateVertices.begin(); it != candidateVertices.end(); it++) {
-                if ((*it) == closestVertex) {
-                    candidateVertices.erase(it);
-                    break;
+                OSPF::Area* backbone;
+                if (areaID != OSPF::BACKBONE_AREAID) {
+                    backbone = parentRouter->getAreaByID(OSPF::BACKBONE_AREAID);
+                } else {
+                    backbone = this;
                 }
-            }
-
-            if (closestVertex->getHeader().getLsType() == ROUTERLSA_TYPE) {
-                OSPF::RouterLSA* routerLSA = check_and_cast<OSPF::RouterLSA*> (closestVertex);
-                if (routerLSA->getB_AreaBorderRouter() || routerLSA->getE_ASBoundaryRouter()) {
-                    OSPF::RoutingTableEntry* entry = new OSPF::RoutingTableEntry;
-                    OSPF::RouterID destinationID = routerLSA->getHeader().getLinkStateID();
-                    unsigned int nextHopCount = routerLSA->getNextHopCount();
-                    OSPF::RoutingTableEntry::RoutingDestinationType destinationType = OSPF::RoutingTableEntry::NETWORK_DESTINATION;
-
-                    entry->setDestination(destinationID);
-                    entry->setLinkStateOrigin(routerLSA);
-                    entry->setArea(areaID);
-                    entry->setPathType(OSPF::RoutingTableEntry::INTRAAREA);
-                    entry->setCost(routerLSA->getDistance());
-                    if (routerLSA->getB_AreaBorderRouter()) {
-                        destinationType |= OSPF::RoutingTableEntry::AREA_BORDER_ROUTER_DESTINATION;
-                    }
-                    if (routerLSA->getE_ASBoundaryRouter()) {
-                        destinationType |= OSPF::RoutingTableEntry::AS_BOUNDARY_ROUTER_DESTINATION;
-                    }
-                    entry->setDestinationType(destinationType);
-                    entry->setOptionalCapabilities(routerLSA->getHeader().getLsOptions());
-                    for (i = 0; i < nextHopCount; i++) {
-                        entry->addNextHop(routerLSA->getNextHop(i));
-                    }
-
-                    newRoutingTable.push_back(entry);
-
-                    OSPF::Area* backbone;
-                    if (areaID != OSPF::BACKBONE_AREAID) {
-                        backbone = parentRouter->getAreaByID(OSPF::BACKBONE_AREAID);
-                    } else {
-                        backbone = this;
-                    }
-                    if (backbone != NULL) {
-                        OSPF::Interface* virtualIntf = backbone->findVirtualLink(destinationID);
-                        if ((virtualIntf != NULL) && (virtualIntf->getTransitAreaID() == areaID)) {
-                            OSPF::IPv4AddressRange range;
-                            range.address = getInterface(routerLSA->getNextHop(0).ifIndex)->getAddressRange().address;
-                            range.mask = IPv4Address::ALLONES_ADDRESS;
-                            virtualIntf->setAddressRange(range);
-                            virtualIntf->setIfIndex(routerLSA->getNextHop(0).ifIndex);
-                            virtualIntf->setOutputCost(routerLSA->getDistance());
-                            OSPF::Neighbor* virtualNeighbor = virtualIntf->getNeighbor(0);
-                            if (virtualNeighbor != NULL) {
-                                unsigned int linkCount = routerLSA->getLinksArraySize();
-                                OSPF::RouterLSA* toRouterLSA = dynamic_cast<OSPF::RouterLSA*> (justAddedVertex);
-                                if (toRouterLSA != NULL) {
+                if (backbone != NULL) {
+                    OSPF::Interface* virtualIntf = backbone->findVirtualLink(destinationID);
+                    if ((virtualIntf != NULL) && (virtualIntf->getTransitAreaID() == areaID)) {
+                        OSPF::IPv4AddressRange range;
+                        range.address = getInterface(routerLSA->getNextHop(0).ifIndex)->getAddressRange().address;
+                        range.mask = IPv4Address::ALLONES_ADDRESS;
+                        virtualIntf->setAddressRange(range);
+                        virtualIntf->setIfIndex(routerLSA->getNextHop(0).ifIndex);
+                        virtualIntf->setOutputCost(routerLSA->getDistance());
+                        OSPF::Neighbor* virtualNeighbor = virtualIntf->getNeighbor(0);
+                        if (virtualNeighbor != NULL) {
+                            unsigned int linkCount = routerLSA->getLinksArraySize();
+                            OSPF::RouterLSA* toRouterLSA = dynamic_cast<OSPF::RouterLSA*> (justAddedVertex);
+                            if (toRouterLSA != NULL) {
+                                for (i = 0; i < linkCount; i++) {
+                                    Link& link = routerLSA->getLinks(i);
+
+                                    if ((link.getType() == POINTTOPOINT_LINK) &&
+                                        (link.getLinkID() == toRouterLSA->getHeader().getLinkStateID()) &&
+                                        (virtualIntf->getState() < OSPF::Interface::WAITING_STATE))
+                                    {
+                                        virtualNeighbor->setAddress(IPv4Address(link.getLinkData()));
+                                        virtualIntf->processEvent(OSPF::Interface::INTERFACE_UP);
+                                        break;
+                                    }
+                                }
+                            } else {
+                                OSPF::NetworkLSA* toNetworkLSA = dynamic_cast<OSPF::NetworkLSA*> (justAddedVertex);
+                                if (toNetworkLSA != NULL) {
                                     for (i = 0; i < linkCount; i++) {
                                         Link& link = routerLSA->getLinks(i);
 
-                                        if ((link.getType() == POINTTOPOINT_LINK) &&
-                                            (link.getLinkID() == toRouterLSA->getHeader().getLinkStateID()) &&
+                                        if ((link.getType() == TRANSIT_LINK) &&
+                                            (link.getLinkID() == toNetworkLSA->getHeader().getLinkStateID()) &&
                                             (virtualIntf->getState() < OSPF::Interface::WAITING_STATE))
                                         {
                                             virtualNeighbor->setAddress(IPv4Address(link.getLinkData()));
@@ -1650,89 +1538,72 @@ void OSPF::Area::calculateShortestPathTree(std::vector<OSPF::RoutingTableEntry*>
                                             break;
                                         }
                                     }
-                                } else {
-                                    OSPF::NetworkLSA* toNetworkLSA = dynamic_cast<OSPF::NetworkLSA*> (justAddedVertex);
-                                    if (toNetworkLSA != NULL) {
-                                        for (i = 0; i < linkCount; i++) {
-                                            Link& link = routerLSA->getLinks(i);
-
-                                            if ((link.getType() == TRANSIT_LINK) &&
-                                                (link.getLinkID() == toNetworkLSA->getHeader().getLinkStateID()) &&
-                                                (virtualIntf->getState() < OSPF::Interface::WAITING_STATE))
-                                            {
-                                                virtualNeighbor->setAddress(IPv4Address(link.getLinkData()));
-                                                virtualIntf->processEvent(OSPF::Interface::INTERFACE_UP);
-                                                break;
-                                            }
-                                        }
-                                    }
                                 }
                             }
                         }
                     }
                 }
             }
+        }
 
-            if (closestVertex->getHeader().getLsType() == NETWORKLSA_TYPE) {
-                OSPF::NetworkLSA* networkLSA = check_and_cast<OSPF::NetworkLSA*> (closestVertex);
-                IPv4Address destinationID = (networkLSA->getHeader().getLinkStateID() & networkLSA->getNetworkMask());
-                unsigned int nextHopCount = networkLSA->getNextHopCount();
-                bool overWrite = false;
-                OSPF::RoutingTableEntry* entry = NULL;
-                unsigned long routeCount = newRoutingTable.size();
-                IPv4Address longestMatch(0u);
-
-                for (i = 0; i < routeCount; i++) {
-                    if (newRoutingTable[i]->getDestinationType() == OSPF::RoutingTableEntry::NETWORK_DESTINATION) {
-                        OSPF::RoutingTableEntry* routingEntry = newRoutingTable[i];
-                        IPv4Address entryAddress = routingEntry->getDestination();
-                        IPv4Address entryMask = routingEntry->getNetmask();
-
-                        if ((entryAddress & entryMask) == (destinationID & entryMask)) {
-                            if ((destinationID & entryMask) > longestMatch) {
-                                longestMatch = (destinationID & entryMask);
-                                entry = routingEntry;
-                            }
+        if (closestVertex->getHeader().getLsType() == NETWORKLSA_TYPE) {
+            OSPF::NetworkLSA* networkLSA = check_and_cast<OSPF::NetworkLSA*> (closestVertex);
+            IPv4Address destinationID = (networkLSA->getHeader().getLinkStateID() & networkLSA->getNetworkMask());
+            unsigned int nextHopCount = networkLSA->getNextHopCount();
+            bool overWrite = false;
+            OSPF::RoutingTableEntry* entry = NULL;
+            unsigned long routeCount = newRoutingTable.size();
+            IPv4Address longestMatch(0u);
+
+            for (i = 0; i < routeCount; i++) {
+                if (newRoutingTable[i]->getDestinationType() == OSPF::RoutingTableEntry::NETWORK_DESTINATION) {
+                    OSPF::RoutingTableEntry* routingEntry = newRoutingTable[i];
+                    IPv4Address entryAddress = routingEntry->getDestination();
+                    IPv4Address entryMask = routingEntry->getNetmask();
+
+                    if ((entryAddress & entryMask) == (destinationID & entryMask)) {
+                        if ((destinationID & entryMask) > longestMatch) {
+                            longestMatch = (destinationID & entryMask);
+                            entry = routingEntry;
                         }
                     }
                 }
-                if (entry != NULL) {
-                    const OSPFLSA* entryOrigin = entry->getLinkStateOrigin();
-                    if ((entry->getCost() != networkLSA->getDistance()) ||
-                        (entryOrigin->getHeader().getLinkStateID() >= networkLSA->getHeader().getLinkStateID()))
-                    {
-                        overWrite = true;
-                    }
+            }
+            if (entry != NULL) {
+                const OSPFLSA* entryOrigin = entry->getLinkStateOrigin();
+                if ((entry->getCost() != networkLSA->getDistance()) ||
+                    (entryOrigin->getHeader().getLinkStateID() >= networkLSA->getHeader().getLinkStateID()))
+                {
+                    overWrite = true;
                 }
+            }
 
-                if ((entry == NULL) || (overWrite)) {
-                    if (entry == NULL) {
-                        entry = new OSPF::RoutingTableEntry;
-                    }
+            if ((entry == NULL) || (overWrite)) {
+                if (entry == NULL) {
+                    entry = new OSPF::RoutingTableEntry;
+                }
 
-                    entry->setDestination(IPv4Address(destinationID));
-                    entry->setNetmask(networkLSA->getNetworkMask());
-                    entry->setLinkStateOrigin(networkLSA);
-                    entry->setArea(areaID);
-                    entry->setPathType(OSPF::RoutingTableEntry::INTRAAREA);
-                    entry->setCost(networkLSA->getDistance());
-                    entry->setDestinationType(OSPF::RoutingTableEntry::NETWORK_DESTINATION);
-                    entry->setOptionalCapabilities(networkLSA->getHeader().getLsOptions());
-                    for (i = 0; i < nextHopCount; i++) {
-                        entry->addNextHop(networkLSA->getNextHop(i));
-                    }
+                entry->setDestination(IPv4Address(destinationID));
+                entry->setNetmask(networkLSA->getNetworkMask());
+                entry->setLinkStateOrigin(networkLSA);
+                entry->setArea(areaID);
+                entry->setPathType(OSPF::RoutingTableEntry::INTRAAREA);
+                entry->setCost(networkLSA->getDistance());
+                entry->setDestinationType(OSPF::RoutingTableEntry::NETWORK_DESTINATION);
+                entry->setOptionalCapabilities(networkLSA->getHeader().getLsOptions());
+                for (i = 0; i < nextHopCount; i++) {
+                    entry->addNextHop(networkLSA->getNextHop(i));
+                }
 
-                    if (!overWrite) {
-                        newRoutingTable.push_back(entry);
-                    }
+                if (!overWrite) {
+                    newRoutingTable.push_back(entry);
                 }
             }
-
-            justAddedVertex = closestVertex;
         }
-    } while (!finished);
 
-    unsigned int treeSize = treeVertices.size();
+        justAddedVertex = closestVertex;
+    }
+
     for (i = 0; i < treeSize; i++) {
         OSPF::RouterLSA* routerVertex = dynamic_cast<OSPF::RouterLSA*> (treeVertices[i]);
         if (routerVertex == NULL) {
@@ -1825,6 +1696,352 @@ void OSPF::Area::calculateShortestPathTree(std::vector<OSPF::RoutingTableEntry*>
             }
         }
     }
+
+    if (parentRouter->getIncrementalSPF()) {
+        spfVertices.swap(vertices);
+        spfVertexIndex.swap(vertexIndex);
+    }
+}
+
+// networks come before routers at the same distance
+uint64 OSPF::Area::getSPFVertexKey(LSAType type, LinkStateID linkStateID)
+{
+    return ((uint64)(type == NETWORKLSA_TYPE ? 0 : 1) << 32) | linkStateID.getInt();
+}
+
+void OSPF::Area::buildSPFGraph(std::vector<SPFVertex>& vertices, std::map<uint64, int>& vertexIndex)
+{
+    unsigned long i, j;
+
+    vertices.reserve(routerLSAs.size() + networkLSAs.size());
+    for (i = 0; i < routerLSAs.size() + networkLSAs.size(); i++) {
+        SPFVertex vertex;
+        if (i < routerLSAs.size()) {
+            vertex.lsa = routerLSAs[i];
+            vertex.key = getSPFVertexKey(ROUTERLSA_TYPE, routerLSAs[i]->getHeader().getLinkStateID());
+        } else {
+            vertex.lsa = networkLSAs[i - routerLSAs.size()];
+            vertex.key = getSPFVertexKey(NETWORKLSA_TYPE, vertex.lsa->getHeader().getLinkStateID());
+        }
+        vertex.distance = SPF_UNREACHABLE;
+        vertex.parent = -1;
+        vertexIndex[vertex.key] = vertices.size();
+        vertices.push_back(vertex);
+    }
+
+    for (i = 0; i < vertices.size(); i++) {
+        OSPFLSA* fromVertex = vertices[i].lsa;
+        std::vector<std::pair<uint64, unsigned long> > links;   // (joining vertex, cost)
+
+        OSPF::RouterLSA* routerVertex = dynamic_cast<OSPF::RouterLSA*> (fromVertex);
+        if (routerVertex != NULL) {
+            unsigned int linkCount = routerVertex->getLinksArraySize();
+            for (j = 0; j < linkCount; j++) {
+                Link& link = routerVertex->getLinks(j);
+                LinkType linkType = static_cast<LinkType> (link.getType());
+                if (linkType == STUB_LINK) {     // (2) (a)
+                    continue;
+                }
+                LSAType joiningVertexType = (linkType == TRANSIT_LINK) ? NETWORKLSA_TYPE : ROUTERLSA_TYPE;
+                links.push_back(std::make_pair(getSPFVertexKey(joiningVertexType, link.getLinkID()), link.getLinkCost()));
+            }
+        } else {
+            OSPF::NetworkLSA* networkVertex = check_and_cast<OSPF::NetworkLSA*> (fromVertex);
+            unsigned int routerCount = networkVertex->getAttachedRoutersArraySize();
+            for (j = 0; j < routerCount; j++) {
+                // link cost from network to router is always 0
+                links.push_back(std::make_pair(getSPFVertexKey(ROUTERLSA_TYPE, networkVertex->getAttachedRouters(j)), 0UL));
+            }
+        }
+
+        for (j = 0; j < links.size(); j++) {
+            std::map<uint64, int>::const_iterator it = vertexIndex.find(links[j].first);
+            if (it == vertexIndex.end()) {
+                continue;
+            }
+            OSPFLSA* joiningVertex = vertices[it->second].lsa;
+            if ((joiningVertex->getHeader().getLsAge() == MAX_AGE) ||
+                (!hasLink(joiningVertex, fromVertex)))  // (from, to)     (2) (b)
+            {
+                continue;
+            }
+            SPFEdge edge;
+            edge.vertex = it->second;
+            edge.cost = links[j].second;
+            vertices[i].edges.push_back(edge);
+            edge.vertex = i;
+            vertices[it->second].inEdges.push_back(edge);
+        }
+    }
+}
+
+void OSPF::Area::calculateSPFDistances(std::vector<SPFVertex>& vertices, int root) const
+{
+    SPFHeap heap;
+
+    vertices[root].distance = 0;
+    heap.push(std::make_pair(0UL, std::make_pair(vertices[root].key, root)));
+    relaxSPFEdges(vertices, heap);
+}
+
+/**
+ * Updates the distances of the previous calculation (spfVertices) to the new graph.
+ * Sets dirty for the vertices whose next hops or parent may have changed.
+ */
+void OSPF::Area::updateSPFDistances(std::vector<SPFVertex>& vertices, const std::map<uint64, int>& vertexIndex,
+                                    int root, std::vector<bool>& dirty) const
+{
+    const std::vector<SPFVertex>& oldVertices = spfVertices;
+    std::vector<int> newIndex(oldVertices.size(), -1);
+    std::vector<int> oldIndex(vertices.size(), -1);
+    std::vector<int> resetSeeds;            // old indices
+    std::vector<std::pair<int, SPFEdge> > cheaperEdges;  // (from, edge), new indices
+    SPFHeap heap;
+    unsigned long i, j;
+
+    for (i = 0; i < oldVertices.size(); i++) {
+        std::map<uint64, int>::const_iterator it = vertexIndex.find(oldVertices[i].key);
+        if (it != vertexIndex.end()) {
+            newIndex[i] = it->second;
+            oldIndex[it->second] = i;
+        }
+    }
+    std::fill(dirty.begin(), dirty.end(), false);
+    for (i = 0; i < vertices.size(); i++) {
+        SPFVertex& vertex = vertices[i];
+        int old = oldIndex[i];
+        if (old == -1) {
+            dirty[i] = true;
+            continue;
+        }
+        vertex.distance = oldVertices[old].distance;
+        vertex.nextHops = oldVertices[old].nextHops;
+        int oldParent = oldVertices[old].parent;
+        vertex.parent = (oldParent == -1) ? -1 : newIndex[oldParent];
+        if ((vertex.parent == -1) && ((int)i != root)) {
+            dirty[i] = true;
+        }
+    }
+    vertices[root].distance = 0;
+
+    // compare the links of the changed, new and deleted vertices, keeping the cheapest one to each neighbor
+    std::vector<std::pair<int, int> > changedVertices;  // (old, new) indices, -1 if missing
+    for (i = 0; i < vertices.size(); i++) {
+        int old = oldIndex[i];
+        if (old != -1) {
+            const std::vector<SPFEdge>& oldEdges = oldVertices[old].edges;
+            const std::vector<SPFEdge>& newEdges = vertices[i].edges;
+            bool same = (oldEdges.size() == newEdges.size());
+            for (j = 0; same && j < oldEdges.size(); j++) {
+                same = (oldVertices[oldEdges[j].vertex].key == vertices[newEdges[j].vertex].key) && (oldEdges[j].cost == newEdges[j].cost);
+            }
+            if (same) {
+                continue;
+            }
+        }
+        changedVertices.push_back(std::make_pair(old, (int)i));
+    }
+    for (i = 0; i < oldVertices.size(); i++) {
+        if (newIndex[i] == -1) {
+            changedVertices.push_back(std::make_pair((int)i, -1));
+        }
+    }
+    for (i = 0; i < changedVertices.size(); i++) {
+        int old = changedVertices[i].first;
+        int current = changedVertices[i].second;
+        std::map<uint64, unsigned long> oldCosts;
+        std::map<uint64, unsigned long> newCosts;
+        if (old != -1) {
+            for (j = 0; j < oldVertices[old].edges.size(); j++) {
+                const SPFEdge& edge = oldVertices[old].edges[j];
+                uint64 key = oldVertices[edge.vertex].key;
+                if ((oldCosts.find(key) == oldCosts.end()) || (edge.cost < oldCosts[key])) {
+                    oldCosts[key] = edge.cost;
+                }
+                if (newIndex[edge.vertex] != -1) {
+                    dirty[newIndex[edge.vertex]] = true;
+                }
+            }
+        }
+        if (current != -1) {
+            for (j = 0; j < vertices[current].edges.size(); j++) {
+                const SPFEdge& edge = vertices[current].edges[j];
+                uint64 key = vertices[edge.vertex].key;
+                if ((newCosts.find(key) == newCosts.end()) || (edge.cost < newCosts[key])) {
+                    newCosts[key] = edge.cost;
+                }
+                dirty[edge.vertex] = true;
+            }
+        }
+        for (std::map<uint64, unsigned long>::iterator it = oldCosts.begin(); it != oldCosts.end(); it++) {
+            std::map<uint64, unsigned long>::iterator newIt = newCosts.find(it->first);
+            if ((newIt == newCosts.end()) || (newIt->second > it->second)) {
+                // removed or more expensive: the vertex may have lost its shortest path
+                int to = spfVertexIndex.find(it->first)->second;
+                unsigned long fromDistance = oldVertices[old].distance;
+                if ((fromDistance != SPF_UNREACHABLE) && (fromDistance + it->second == oldVertices[to].distance)) {
+                    resetSeeds.push_back(to);
+                }
+            }
+        }
+        for (std::map<uint64, unsigned long>::iterator it = newCosts.begin(); it != newCosts.end(); it++) {
+            std::map<uint64, unsigned long>::iterator oldIt = oldCosts.find(it->first);
+            if ((oldIt == oldCosts.end()) || (it->second < oldIt->second)) {
+                SPFEdge edge;
+                edge.vertex = vertexIndex.find(it->first)->second;
+                edge.cost = it->second;
+                cheaperEdges.push_back(std::make_pair(current, edge));
+            }
+        }
+    }
+
+    // take the subtrees that may have lost their shortest paths off the tree
+    std::vector<bool> oldReset(oldVertices.size(), false);
+    std::vector<bool> reset(vertices.size(), false);
+    while (!resetSeeds.empty()) {
+        int old = resetSeeds.back();
+        resetSeeds.pop_back();
+        if (oldReset[old]) {
+            continue;
+        }
+        oldReset[old] = true;
+        for (j = 0; j < oldVertices[old].edges.size(); j++) {
+            const SPFEdge& edge = oldVertices[old].edges[j];
+            if (oldVertices[old].distance + edge.cost == oldVertices[edge.vertex].distance) {
+                resetSeeds.push_back(edge.vertex);
+            }
+        }
+        if ((newIndex[old] != -1) && (newIndex[old] != root)) {
+            reset[newIndex[old]] = true;
+            vertices[newIndex[old]].distance = SPF_UNREACHABLE;
+        }
+    }
+    for (i = 0; i < vertices.size(); i++) {
+        if (!reset[i]) {
+            continue;
+        }
+        for (j = 0; j < vertices[i].inEdges.size(); j++) {
+            const SPFVertex& from = vertices[vertices[i].inEdges[j].vertex];
+            if (!reset[vertices[i].inEdges[j].vertex] && (from.distance != SPF_UNREACHABLE) &&
+                (from.distance + vertices[i].inEdges[j].cost < vertices[i].distance))
+            {
+                vertices[i].distance = from.distance + vertices[i].inEdges[j].cost;
+            }
+        }
+        if (vertices[i].distance != SPF_UNREACHABLE) {
+            heap.push(std::make_pair(vertices[i].distance, std::make_pair(vertices[i].key, (int)i)));
+        }
+    }
+    for (i = 0; i < cheaperEdges.size(); i++) {
+        const SPFVertex& from = vertices[cheaperEdges[i].first];
+        SPFVertex& to = vertices[cheaperEdges[i].second.vertex];
+        if (!reset[cheaperEdges[i].first] && (from.distance != SPF_UNREACHABLE) &&
+            (from.distance + cheaperEdges[i].second.cost < to.distance))
+        {
+            to.distance = from.distance + cheaperEdges[i].second.cost;
+            heap.push(std::make_pair(to.distance, std::make_pair(to.key, cheaperEdges[i].second.vertex)));
+        }
+    }
+    relaxSPFEdges(vertices, heap);
+
+    for (i = 0; i < vertices.size(); i++) {
+        int old = oldIndex[i];
+        if ((old != -1) && (vertices[i].distance == oldVertices[old].distance)) {
+            continue;
+        }
+        // the vertex moved in the tree order, so it may have become or ceased to be the parent of its neighbors
+        dirty[i] = true;
+        for (j = 0; j < vertices[i].edges.size(); j++) {
+            dirty[vertices[i].edges[j].vertex] = true;
+        }
+    }
+
+    // next hops through directly connected neighbors depend on the interfaces, too
+    for (i = 0; i < vertices[root].edges.size(); i++) {
+        const SPFVertex& neighbor = vertices[vertices[root].edges[i].vertex];
+        dirty[vertices[root].edges[i].vertex] = true;
+        if (dynamic_cast<OSPF::NetworkLSA*> (neighbor.lsa) != NULL) {
+            for (j = 0; j < neighbor.edges.size(); j++) {
+                dirty[neighbor.edges[j].vertex] = true;
+            }
+        }
+    }
+}
+
+/**
+ * Dijkstra's algorithm from the vertices in the heap.
+ */
+void OSPF::Area::relaxSPFEdges(std::vector<SPFVertex>& vertices, SPFHeap& heap) const
+{
+    while (!heap.empty()) {
+        unsigned long distance = heap.top().first;
+        int v = heap.top().second.second;
+        heap.pop();
+        if (distance != vertices[v].distance) {
+            continue;   // stale entry
+        }
+        for (unsigned long i = 0; i < vertices[v].edges.size(); i++) {
+            const SPFEdge& edge = vertices[v].edges[i];
+            SPFVertex& joiningVertex = vertices[edge.vertex];
+            if (distance + edge.cost < joiningVertex.distance) {
+                joiningVertex.distance = distance + edge.cost;
+                heap.push(std::make_pair(joiningVertex.distance, std::make_pair(joiningVertex.key, edge.vertex)));
+            }
+        }
+    }
+}
+
+/**
+ * Sets the parent and next hops of the vertex from the vertices before it in the tree order,
+ * and copies them to the LSA. Returns true if they differ from the previous ones.
+ */
+bool OSPF::Area::calculateSPFNextHops(std::vector<SPFVertex>& vertices, int v) const
+{
+    SPFVertex& vertex = vertices[v];
+    std::pair<unsigned long, uint64> order = std::make_pair(vertex.distance, vertex.key);
+    std::vector<std::pair<std::pair<std::pair<unsigned long, uint64>, unsigned long>, int> > parents;  // ((order, edge index), vertex)
+    int parent = -1;
+    unsigned long i, j;
+
+    for (i = 0; i < vertex.inEdges.size(); i++) {
+        const SPFEdge& edge = vertex.inEdges[i];
+        const SPFVertex& from = vertices[edge.vertex];
+        if ((from.distance == SPF_UNREACHABLE) || !(std::make_pair(from.distance, from.key) < order)) {
+            continue;
+        }
+        if ((parent == -1) || (std::make_pair(from.distance, from.key) < std::make_pair(vertices[parent].distance, vertices[parent].key))) {
+            parent = edge.vertex;
+        }
+        if (from.distance + edge.cost == vertex.distance) {
+            parents.push_back(std::make_pair(std::make_pair(std::make_pair(from.distance, from.key), i), edge.vertex));
+        }
+    }
+    std::sort(parents.begin(), parents.end());
+
+    std::vector<OSPF::NextHop> nextHops;
+    for (i = 0; i < parents.size(); i++) {
+        std::vector<OSPF::NextHop>* newNextHops = calculateNextHops(vertex.lsa, vertices[parents[i].second].lsa); // (destination, parent)
+        for (j = 0; j < newNextHops->size(); j++) {
+            nextHops.push_back((*newNextHops)[j]);
+        }
+        delete newNextHops;
+    }
+
+    bool changed = (parent != vertex.parent) || (nextHops.size() != vertex.nextHops.size());
+    for (i = 0; !changed && i < nextHops.size(); i++) {
+        changed = (nextHops[i] != vertex.nextHops[i]);
+    }
+    vertex.parent = parent;
+    vertex.nextHops = nextHops;
+
+    OSPF::RoutingInfo* routingInfo = check_and_cast<OSPF::RoutingInfo*> (vertex.lsa);
+    routingInfo->setDistance(vertex.distance);
+    routingInfo->setParent(parent != -1 ? vertices[parent].lsa : NULL);
+    routingInfo->clearNextHops();
+    for (i = 0; i < nextHops.size(); i++) {
+        routingInfo->addNextHop(nextHops[i]);
+    }
+    return changed;
 }
 
 std::vector<OSPF::NextHop>* OSPF::Area::calculateNextHops(OSPFLSA* destination, OSPFLSA* parent) const
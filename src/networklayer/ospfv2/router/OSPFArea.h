@@ -20,6 +20,8 @@
 
 #include <vector>
 #include <map>
+#include <queue>
+#include <functional>
 
 #include "LSA.h"
 #include "OSPFcommon.h"
@@ -33,6 +35,32 @@ class Router;
 
 class Area : public cObject {
 private:
+    /**
+     * Directed edge of the shortest path tree calculation: a usable link
+     * of a router or network LSA (see calculateShortestPathTree()).
+     */
+    struct SPFEdge {
+        int                     vertex;     ///< Index of the target (out-edges) or source (in-edges) vertex.
+        unsigned long           cost;
+    };
+
+    /**
+     * A router or network LSA in the shortest path tree calculation.
+     */
+    struct SPFVertex {
+        uint64                  key;        ///< LSA type and link state ID, see getSPFVertexKey().
+        OSPFLSA*                lsa;        ///< Only valid during the calculation.
+        std::vector<SPFEdge>    edges;      ///< Usable links of the LSA, in link order.
+        std::vector<SPFEdge>    inEdges;
+        unsigned long           distance;   ///< SPF_UNREACHABLE if not on the tree.
+        int                     parent;     ///< -1 for the root.
+        std::vector<NextHop>    nextHops;
+    };
+
+    /// Min-heap of (distance, (vertex key, vertex index)) for Dijkstra's algorithm.
+    typedef std::pair<unsigned long, std::pair<uint64, int> > SPFHeapEntry;
+    typedef std::priority_queue<SPFHeapEntry, std::vector<SPFHeapEntry>, std::greater<SPFHeapEntry> > SPFHeap;
+
     AreaID                                                  areaID;
     std::map<IPv4AddressRange, bool>                        advertiseAddressRanges;
     std::vector<IPv4AddressRange>                           areaAddressRanges;
@@ -48,6 +76,8 @@ private:
     bool                                                    externalRoutingCapability;
     Metric                                                  stubDefaultCost;
     RouterLSA*                                              spfTreeRoot;
+    std::vector<SPFVertex>                                  spfVertices;        ///< Result of the last calculation, for incremental SPF.
+    std::map<uint64, int>                                   spfVertexIndex;
 
     Router*                                                 parentRouter;
 public:
@@ -126,6 +156,14 @@ private:
     std::vector<NextHop>* calculateNextHops(OSPFLSA* destination, OSPFLSA* parent) const;
     std::vector<NextHop>* calculateNextHops(Link& destination, OSPFLSA* parent) const;
 
+    static uint64         getSPFVertexKey(LSAType type, LinkStateID linkStateID);
+    void                  buildSPFGraph(std::vector<SPFVertex>& vertices, std::map<uint64, int>& vertexIndex);
+    void                  calculateSPFDistances(std::vector<SPFVertex>& vertices, int root) const;
+    void                  updateSPFDistances(std::vector<SPFVertex>& vertices, const std::map<uint64, int>& vertexIndex,
+                                             int root, std::vector<bool>& dirty) const;
+    void                  relaxSPFEdges(std::vector<SPFVertex>& vertices, SPFHeap& heap) const;
+    bool                  calculateSPFNextHops(std::vector<SPFVertex>& vertices, int vertex) const;
+
     LinkStateID           getUniqueLinkStateID(IPv4AddressRange destination,
                                                Metric destinationCost,
                                                SummaryLSA*& lsaToReoriginate) const;
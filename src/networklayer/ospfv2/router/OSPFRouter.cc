@@ -16,14 +16,28 @@
 //
 
 
+#include <ctime>
+
 #include "OSPFRouter.h"
 
 #include "RoutingTableAccess.h"
 
 
+simsignal_t OSPF::Router::spfRunSignal = cComponent::registerSignal("spfRun");
+simsignal_t OSPF::Router::spfDurationSignal = cComponent::registerSignal("spfDuration");
+
+
 OSPF::Router::Router(OSPF::RouterID id, cSimpleModule* containingModule) :
     routerID(id),
-    rfc1583Compatibility(false)
+    rfc1583Compatibility(false),
+    incrementalSPF(false),
+    spfInitialDelay(0),
+    spfHoldTime(0),
+    spfMaxHoldTime(0),
+    spfCurrentHoldTime(0),
+    lastSPFTime(-1),
+    spfRequestCount(0),
+    ospfModule(containingModule)
 {
     messageHandler = new OSPF::MessageHandler(this, containingModule);
     ageTimer = new cMessage();
@@ -31,6 +45,10 @@ OSPF::Router::Router(OSPF::RouterID id, cSimpleModule* containingModule) :
     ageTimer->setContextPointer(this);
     ageTimer->setName("OSPF::Router::DatabaseAgeTimer");
     messageHandler->startTimer(ageTimer, 1.0);
+    spfTimer = new cMessage();
+    spfTimer->setKind(ROUTER_SPF_TIMER);
+    spfTimer->setContextPointer(this);
+    spfTimer->setName("OSPF::Router::SPFTimer");
 }
 
 
@@ -50,10 +68,23 @@ OSPF::Router::~Router()
     }
     messageHandler->clearTimer(ageTimer);
     delete ageTimer;
+    messageHandler->clearTimer(spfTimer);
+    delete spfTimer;
     delete messageHandler;
 }
 
 
+void OSPF::Router::setSPFThrottling(simtime_t initialDelay, simtime_t holdTime, simtime_t maxHoldTime)
+{
+    if (initialDelay < 0 || holdTime < 0 || maxHoldTime < 0)
+        throw cRuntimeError("Negative SPF throttling timer");
+    spfInitialDelay = initialDelay;
+    spfHoldTime = holdTime;
+    spfMaxHoldTime = (maxHoldTime > holdTime) ? maxHoldTime : holdTime;
+    spfCurrentHoldTime = spfHoldTime;
+}
+
+
 void OSPF::Router::addWatches()
 {
     WATCH(routerID);
@@ -396,7 +427,7 @@ void OSPF::Router::ageDatabase()
     messageHandler->startTimer(ageTimer, 1.0);
 
     if (shouldRebuildRoutingTable) {
-        rebuildRoutingTable();
+        scheduleRoutingTableRebuild();
     }
 }
 
@@ -703,12 +734,48 @@ OSPF::RoutingTableEntry* OSPF::Router::lookup(IPv4Address destination, std::vect
 }
 
 
+void OSPF::Router::scheduleRoutingTableRebuild()
+{
+    if ((spfInitialDelay == 0) && (spfHoldTime == 0)) {
+        rebuildRoutingTable();
+        return;
+    }
+
+    spfRequestCount++;
+    if (spfTimer->isScheduled()) {
+        EV << "Routing table rebuild is already scheduled at " << spfTimer->getArrivalTime() << ".\n";
+        return;
+    }
+
+    simtime_t now = simTime();
+    simtime_t rebuildTime = now + spfInitialDelay;
+    if ((lastSPFTime >= 0) && (now < lastSPFTime + spfCurrentHoldTime)) {
+        // still in the hold-down period of the last rebuild: wait for its end, and back off further
+        if (rebuildTime < lastSPFTime + spfCurrentHoldTime) {
+            rebuildTime = lastSPFTime + spfCurrentHoldTime;
+        }
+        spfCurrentHoldTime = (spfCurrentHoldTime * 2 < spfMaxHoldTime) ? spfCurrentHoldTime * 2 : spfMaxHoldTime;
+    } else {
+        spfCurrentHoldTime = spfHoldTime;
+    }
+
+    EV << "Scheduling routing table rebuild at " << rebuildTime << ".\n";
+    messageHandler->startTimer(spfTimer, rebuildTime - now);
+}
+
+
 void OSPF::Router::rebuildRoutingTable()
 {
     unsigned long areaCount = areas.size();
     bool hasTransitAreas = false;
     std::vector<OSPF::RoutingTableEntry*> newTable;
     unsigned long i;
+    clock_t startTime = clock();  // CPU time of the process, for spfDuration
+    long requestCount = (spfRequestCount > 0) ? spfRequestCount : 1;
+
+    messageHandler->clearTimer(spfTimer);
+    spfRequestCount = 0;
+    lastSPFTime = simTime();
 
     EV << "Rebuilding routing table:\n";
 
@@ -778,6 +845,9 @@ void OSPF::Router::rebuildRoutingTable()
         delete (oldTable[i]);
     }
 
+    ospfModule->emit(spfRunSignal, requestCount);
+    ospfModule->emit(spfDurationSignal, (double)(clock() - startTime) / CLOCKS_PER_SEC);
+
     EV << "Routing table was rebuilt.\n"
        << "Results:\n";
 
@@ -1373,7 +1443,7 @@ void OSPF::Router::updateExternalRoute(IPv4Address networkAddress, const OSPFASE
     delete asExternalLSA;
 
     if (rebuild) {
-        rebuildRoutingTable();
+        scheduleRoutingTableRebuild();
     }
 }
 
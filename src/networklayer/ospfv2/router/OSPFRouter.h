@@ -47,9 +47,21 @@ private:
     std::vector<ASExternalLSA*>                                        asExternalLSAs;          ///< A list of the ASExternalLSAs advertised by this router.
     std::map<IPv4Address, OSPFASExternalLSAContents>                   externalRoutes;          ///< A map of the external route advertised by this router.
     cMessage*                                                          ageTimer;                ///< Database age timer - fires every second.
+    cMessage*                                                          spfTimer;                ///< Delays the routing table rebuilds requested by LSA changes.
     std::vector<RoutingTableEntry*>                                    routingTable;            ///< The OSPF routing table - contains more information than the one in the IP layer.
     MessageHandler*                                                    messageHandler;          ///< The message dispatcher class.
     bool                                                               rfc1583Compatibility;    ///< Decides whether to handle the preferred routing table entry to an AS boundary router as defined in RFC1583 or not.
+    bool                                                               incrementalSPF;          ///< Decides whether the areas only recompute the part of the shortest path tree affected by LSA changes.
+    simtime_t                                                          spfInitialDelay;         ///< Delay of the first routing table rebuild after a quiet period.
+    simtime_t                                                          spfHoldTime;             ///< Minimum time between two routing table rebuilds; doubled by every rebuild requested in the hold-down period.
+    simtime_t                                                          spfMaxHoldTime;          ///< Upper limit of the doubled hold time.
+    simtime_t                                                          spfCurrentHoldTime;      ///< The hold time after the last rebuild.
+    simtime_t                                                          lastSPFTime;             ///< Time of the last routing table rebuild, or -1 if there was none yet.
+    long                                                               spfRequestCount;         ///< Number of rebuild requests since the last rebuild.
+    cSimpleModule*                                                     ospfModule;              ///< The module which emits the signals of the router.
+
+    static simsignal_t spfRunSignal;
+    static simsignal_t spfDurationSignal;
 
 public:
     /**
@@ -68,6 +80,12 @@ public:
     RouterID                 getRouterID() const  { return routerID; }
     void                     setRFC1583Compatibility(bool compatibility)  { rfc1583Compatibility = compatibility; }
     bool                     getRFC1583Compatibility() const  { return rfc1583Compatibility; }
+    void                     setIncrementalSPF(bool incremental)  { incrementalSPF = incremental; }
+    bool                     getIncrementalSPF() const  { return incrementalSPF; }
+    void                     setSPFThrottling(simtime_t initialDelay, simtime_t holdTime, simtime_t maxHoldTime);
+    simtime_t                getSPFInitialDelay() const  { return spfInitialDelay; }
+    simtime_t                getSPFHoldTime() const  { return spfHoldTime; }
+    simtime_t                getSPFMaxHoldTime() const  { return spfMaxHoldTime; }
     unsigned long            getAreaCount() const  { return areas.size(); }
 
     MessageHandler*          getMessageHandler()  { return messageHandler; }
@@ -208,6 +226,17 @@ public:
      */
     void                 rebuildRoutingTable();
 
+    /**
+     * Requests a rebuild of the routing table after an LSA database change.
+     * If SPF throttling is disabled(both spfInitialDelay and spfHoldTime are zero)
+     * the routing table is rebuilt immediately. Otherwise the rebuild is delayed
+     * by spfInitialDelay, but at least until spfHoldTime has passed since the
+     * previous rebuild; every request arriving in this hold-down period doubles
+     * the hold time up to spfMaxHoldTime. All requests made until the ROUTER_SPF_TIMER
+     * fires are served by a single rebuild.
+     */
+    void                 scheduleRoutingTableRebuild();
+
     /**
      * Scans through the router's areas' preconfigured address ranges and returns
      * the one containing the input addressRange.
@@ -20,12 +20,26 @@
 #include <sstream>
 #include <map>
 #include <set>
+#include <algorithm>
 
 #include "world/obstacles/ObstacleControl.h"
 
 
 Define_Module(ObstacleControl);
 
+ObstacleControl::ObstacleControl() :
+    obstaclesXml(NULL),
+    annotations(NULL),
+    annotationGroup(NULL),
+    isBvhValid(false),
+    cachePositionPrecision(0),
+    maxCacheSize(0),
+    numCalls(0),
+    numCacheHits(0),
+    numNodeTests(0),
+    numObstacleTests(0) {
+}
+
 ObstacleControl::~ObstacleControl() {
 }
 
@@ -36,9 +50,23 @@ void ObstacleControl::initialize(int stage)
     if (stage == 0)
     {
         obstacles.clear();
-        cacheEntries.clear();
+        isBvhValid = false;
+        clearCache();
 
         obstaclesXml = par("obstacles");
+        cachePositionPrecision = par("cachePositionPrecision");
+        if (cachePositionPrecision < 0)
+            error("cachePositionPrecision must not be negative");
+        int cacheSize = par("cacheSize");
+        if (cacheSize < 0)
+            error("cacheSize must not be negative");
+        maxCacheSize = cacheSize;
+
+        numCalls = numCacheHits = numNodeTests = numObstacleTests = 0;
+        WATCH(numCalls);
+        WATCH(numCacheHits);
+        WATCH(numNodeTests);
+        WATCH(numObstacleTests);
     }
     else if (stage == 1)
     {
@@ -51,12 +79,13 @@ void ObstacleControl::initialize(int stage)
 }
 
 void ObstacleControl::finish() {
-    for (Obstacles::iterator i = obstacles.begin(); i != obstacles.end(); ++i) {
-        for (ObstacleGridRow::iterator j = i->begin(); j != i->end(); ++j) {
-            while (j->begin() != j->end()) erase(*j->begin());
-        }
-    }
-    obstacles.clear();
+    recordScalar("calls", numCalls);
+    recordScalar("cache hit ratio", numCalls == 0 ? 0.0 : (double)numCacheHits / numCalls);
+    long numMisses = numCalls - numCacheHits;
+    recordScalar("node tests per calculation", numMisses == 0 ? 0.0 : (double)numNodeTests / numMisses);
+    recordScalar("obstacle tests per calculation", numMisses == 0 ? 0.0 : (double)numObstacleTests / numMisses);
+
+    while (!obstacles.empty()) erase(obstacles.front());
 }
 
 void ObstacleControl::handleMessage(cMessage *msg) {
@@ -114,98 +143,199 @@ void ObstacleControl::addFromXml(cXMLElement* xml) {
 
 void ObstacleControl::add(Obstacle obstacle) {
     Obstacle* o = new Obstacle(obstacle);
-
-    size_t fromRow = std::max(0, int(o->getBboxP1().x / GRIDCELL_SIZE));
-    size_t toRow = std::max(0, int(o->getBboxP2().x / GRIDCELL_SIZE));
-    size_t fromCol = std::max(0, int(o->getBboxP1().y / GRIDCELL_SIZE));
-    size_t toCol = std::max(0, int(o->getBboxP2().y / GRIDCELL_SIZE));
-    for (size_t row = fromRow; row <= toRow; ++row) {
-        for (size_t col = fromCol; col <= toCol; ++col) {
-            if (obstacles.size() < col+1) obstacles.resize(col+1);
-            if (obstacles[col].size() < row+1) obstacles[col].resize(row+1);
-            (obstacles[col])[row].push_back(o);
-        }
-    }
+    obstacles.push_back(o);
+    isBvhValid = false;
 
     // visualize using AnnotationManager
     if (annotations) o->visualRepresentation = annotations->drawPolygon(o->getShape(), "red", annotationGroup);
 
-    cacheEntries.clear();
+    clearCache();
 }
 
 void ObstacleControl::erase(const Obstacle* obstacle) {
-    for (Obstacles::iterator i = obstacles.begin(); i != obstacles.end(); ++i) {
-        for (ObstacleGridRow::iterator j = i->begin(); j != i->end(); ++j) {
-            for (ObstacleGridCell::iterator k = j->begin(); k != j->end(); ) {
-                Obstacle* o = *k;
-                if (o == obstacle) {
-                    k = j->erase(k);
-                } else {
-                    ++k;
-                }
-            }
-        }
-    }
+    obstacles.remove(const_cast<Obstacle*>(obstacle));
+    isBvhValid = false;
 
     if (annotations && obstacle->visualRepresentation) annotations->erase(obstacle->visualRepresentation);
     delete obstacle;
 
-    cacheEntries.clear();
+    clearCache();
 }
 
-double ObstacleControl::calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const {
-    Enter_Method_Silent();
+void ObstacleControl::clearCache() {
+    cacheEntries.clear();
+    cacheEntryList.clear();
+}
 
-    // return cached result, if available
-    CacheKey cacheKey(pSend, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle);
-    CacheEntries::const_iterator cacheEntryIter = cacheEntries.find(cacheKey);
-    if (cacheEntryIter != cacheEntries.end()) return cacheEntryIter->second;
+int64 ObstacleControl::quantize(double coord) const {
+    if (cachePositionPrecision == 0) {
+        // exact key: use the bit pattern of the coordinate
+        union { double d; int64 i; } u;
+        u.d = coord == 0 ? 0.0 : coord;  // -0.0 == 0.0
+        return u.i;
+    }
+    return (int64)floor(coord / cachePositionPrecision + 0.5);
+}
 
-    // calculate bounding box of transmission
-    Coord bboxP1 = Coord(std::min(senderPos.x, receiverPos.x), std::min(senderPos.y, receiverPos.y));
-    Coord bboxP2 = Coord(std::max(senderPos.x, receiverPos.x), std::max(senderPos.y, receiverPos.y));
+ObstacleControl::CacheKey ObstacleControl::makeCacheKey(const Coord& senderPos, const Coord& receiverPos, bool& reversed) const {
+    CacheKey key;
+    key.x1 = quantize(senderPos.x);
+    key.y1 = quantize(senderPos.y);
+    key.x2 = quantize(receiverPos.x);
+    key.y2 = quantize(receiverPos.y);
+    reversed = key.x2 < key.x1 || (key.x2 == key.x1 && key.y2 < key.y1);
+    if (reversed) {
+        std::swap(key.x1, key.x2);
+        std::swap(key.y1, key.y2);
+    }
+    return key;
+}
 
-    size_t fromRow = std::max(0, int(bboxP1.x / GRIDCELL_SIZE));
-    size_t toRow = std::max(0, int(bboxP2.x / GRIDCELL_SIZE));
-    size_t fromCol = std::max(0, int(bboxP1.y / GRIDCELL_SIZE));
-    size_t toCol = std::max(0, int(bboxP2.y / GRIDCELL_SIZE));
+void ObstacleControl::buildBvh() const {
+    bvhNodes.clear();
+    bvhObstacles.assign(obstacles.begin(), obstacles.end());
+    if (!bvhObstacles.empty())
+        buildBvhNode(0, bvhObstacles.size());
+    isBvhValid = true;
+}
 
-    std::set<Obstacle*> processedObstacles;
-    for (size_t col = fromCol; col <= toCol; ++col) {
-        if (col >= obstacles.size()) break;
-        for (size_t row = fromRow; row <= toRow; ++row) {
-            if (row >= obstacles[col].size()) break;
-            const ObstacleGridCell& cell = (obstacles[col])[row];
-            for (ObstacleGridCell::const_iterator k = cell.begin(); k != cell.end(); ++k) {
+namespace {
+    struct CompareObstacleCenter {
+        bool alongX;
+        CompareObstacleCenter(bool alongX) : alongX(alongX) {}
+        bool operator()(const Obstacle* a, const Obstacle* b) const {
+            if (alongX)
+                return a->getBboxP1().x + a->getBboxP2().x < b->getBboxP1().x + b->getBboxP2().x;
+            else
+                return a->getBboxP1().y + a->getBboxP2().y < b->getBboxP1().y + b->getBboxP2().y;
+        }
+    };
+}
 
-                Obstacle* o = *k;
+int ObstacleControl::buildBvhNode(int first, int count) const {
+    BvhNode node;
+    node.bboxP1 = bvhObstacles[first]->getBboxP1();
+    node.bboxP2 = bvhObstacles[first]->getBboxP2();
+    for (int i = first + 1; i < first + count; ++i) {
+        const Obstacle* o = bvhObstacles[i];
+        node.bboxP1.x = std::min(node.bboxP1.x, o->getBboxP1().x);
+        node.bboxP1.y = std::min(node.bboxP1.y, o->getBboxP1().y);
+        node.bboxP2.x = std::max(node.bboxP2.x, o->getBboxP2().x);
+        node.bboxP2.y = std::max(node.bboxP2.y, o->getBboxP2().y);
+    }
+    node.left = node.right = -1;
+    node.first = first;
+    node.count = count;
+
+    int index = bvhNodes.size();
+    bvhNodes.push_back(node);
+    if (count > BVH_LEAF_SIZE) {
+        // split at the median of the obstacle centers along the longer side
+        bool alongX = node.bboxP2.x - node.bboxP1.x >= node.bboxP2.y - node.bboxP1.y;
+        int half = count / 2;
+        std::nth_element(bvhObstacles.begin() + first, bvhObstacles.begin() + first + half,
+                bvhObstacles.begin() + first + count, CompareObstacleCenter(alongX));
+        int left = buildBvhNode(first, half);
+        int right = buildBvhNode(first + half, count - half);
+        // bvhNodes may have been reallocated
+        bvhNodes[index].left = left;
+        bvhNodes[index].right = right;
+    }
+    return index;
+}
 
-                if (processedObstacles.find(o) != processedObstacles.end()) continue;
-                processedObstacles.insert(o);
+bool ObstacleControl::segmentIntersectsBox(const Coord& from, const Coord& to, const Coord& bboxP1, const Coord& bboxP2) {
+    // slab test on the segment parameterized over [0, 1]; the box is slightly
+    // enlarged so that touching segments are never culled due to rounding
+    const double margin = 1e-6;
+    double tMin = 0;
+    double tMax = 1;
+    double origin[2] = { from.x, from.y };
+    double direction[2] = { to.x - from.x, to.y - from.y };
+    double boxMin[2] = { bboxP1.x - margin, bboxP1.y - margin };
+    double boxMax[2] = { bboxP2.x + margin, bboxP2.y + margin };
+    for (int axis = 0; axis < 2; axis++) {
+        if (direction[axis] == 0) {
+            if (origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis]) return false;
+        }
+        else {
+            double t1 = (boxMin[axis] - origin[axis]) / direction[axis];
+            double t2 = (boxMax[axis] - origin[axis]) / direction[axis];
+            if (t1 > t2) std::swap(t1, t2);
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax) return false;
+        }
+    }
+    return true;
+}
 
-                // bail if bounding boxes cannot overlap
-                if (o->getBboxP2().x < bboxP1.x) continue;
-                if (o->getBboxP1().x > bboxP2.x) continue;
-                if (o->getBboxP2().y < bboxP1.y) continue;
-                if (o->getBboxP1().y > bboxP2.y) continue;
+double ObstacleControl::calculateAttenuation(const Coord& senderPos, const Coord& receiverPos) const {
+    if (!isBvhValid) buildBvh();
+
+    // the attenuation factor is independent of the transmit power, so it is computed for unit power
+    double factor = 1;
+    std::vector<int> stack;
+    if (!bvhNodes.empty()) stack.push_back(0);
+    while (!stack.empty()) {
+        const BvhNode& node = bvhNodes[stack.back()];
+        stack.pop_back();
+        numNodeTests++;
+        if (!segmentIntersectsBox(senderPos, receiverPos, node.bboxP1, node.bboxP2)) continue;
+        if (node.left != -1) {
+            stack.push_back(node.right);
+            stack.push_back(node.left);
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; ++i) {
+            Obstacle* o = bvhObstacles[i];
 
-                double pSendOld = pSend;
+            // bail if the line of sight misses the bounding box
+            if (node.count > 1 && !segmentIntersectsBox(senderPos, receiverPos, o->getBboxP1(), o->getBboxP2())) continue;
 
-                pSend = o->calculateReceivedPower(pSend, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle);
+            numObstacleTests++;
+            double factorOld = factor;
 
-                // draw a "hit!" bubble
-                if (annotations && (pSend < pSendOld)) annotations->drawBubble(o->getBboxP1(), "hit");
+            factor = o->calculateReceivedPower(factor, 0, senderPos, 0, receiverPos, 0);
 
-                // bail if attenuation is already extremely high
-                if (pSend < 1e-30) break;
+            // draw a "hit!" bubble
+            if (annotations && (factor < factorOld)) annotations->drawBubble(o->getBboxP1(), "hit");
 
-            }
+            // bail if attenuation is already extremely high (300 dB)
+            if (factor < 1e-30) return factor;
         }
     }
+    return factor;
+}
+
+double ObstacleControl::calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const {
+    Enter_Method_Silent();
+
+    numCalls++;
+    if (maxCacheSize == 0)
+        return pSend * calculateAttenuation(senderPos, receiverPos);
 
-    // cache result
-    if (cacheEntries.size() >= 1000) cacheEntries.clear();
-    cacheEntries[cacheKey] = pSend;
+    // return cached result, if available
+    bool reversed;
+    CacheKey cacheKey = makeCacheKey(senderPos, receiverPos, reversed);
+    CacheEntries::iterator cacheEntryIter = cacheEntries.find(cacheKey);
+    if (cacheEntryIter != cacheEntries.end()) {
+        numCacheHits++;
+        // move to the front of the LRU list
+        cacheEntryList.splice(cacheEntryList.begin(), cacheEntryList, cacheEntryIter->second);
+        return pSend * cacheEntryIter->second->second;
+    }
+
+    // calculate in canonical direction, so the cached value does not depend on which end asked first
+    double factor = reversed ? calculateAttenuation(receiverPos, senderPos) : calculateAttenuation(senderPos, receiverPos);
+
+    // cache result, evicting the least recently used one if full
+    if (cacheEntries.size() >= maxCacheSize) {
+        cacheEntries.erase(cacheEntryList.back().first);
+        cacheEntryList.pop_back();
+    }
+    cacheEntryList.push_front(CacheEntry(cacheKey, factor));
+    cacheEntries[cacheKey] = cacheEntryList.begin();
 
-    return pSend;
+    return pSend * factor;
 }
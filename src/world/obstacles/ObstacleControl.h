@@ -22,6 +22,8 @@
 #define WORLD_OBSTACLE_OBSTACLECONTROL_H
 
 #include <list>
+#include <map>
+#include <vector>
 
 #include "INETDefs.h"
 
@@ -36,10 +38,15 @@
  * Each Obstacle is a polygon.
  * Transmissions that cross one of the polygon's lines will have
  * their receive power set to zero.
+ *
+ * Obstacles are stored in a bounding volume hierarchy, so only obstacles
+ * whose bounding box is crossed by the line of sight are examined.
+ * Calculated attenuations are kept in a bounded LRU cache.
  */
 class INET_API ObstacleControl : public cSimpleModule
 {
     public:
+        ObstacleControl();
         virtual ~ObstacleControl();
         virtual void initialize(int stage);
         virtual int numInitStages() const { return 2; }
@@ -57,56 +64,78 @@ class INET_API ObstacleControl : public cSimpleModule
         double calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const;
 
     protected:
+        /**
+         * Attenuation does not depend on transmit power, frequency or antenna
+         * angles (see Obstacle::calculateReceivedPower()), so the cache is keyed
+         * by the end points only, quantized to cachePositionPrecision. Sender and
+         * receiver are stored in a canonical order, so the reverse direction hits too.
+         */
         struct CacheKey {
-            const double pSend;
-            const double carrierFrequency;
-            const Coord senderPos;
-            const double senderAngle;
-            const Coord receiverPos;
-            const double receiverAngle;
-
-            CacheKey(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) :
-                pSend(pSend),
-                carrierFrequency(carrierFrequency),
-                senderPos(senderPos),
-                senderAngle(senderAngle),
-                receiverPos(receiverPos),
-                receiverAngle(receiverAngle) {
-            }
+            int64 x1, y1, x2, y2;
+
             bool operator<(const CacheKey& o) const {
-                if (senderPos.x < o.senderPos.x) return true;
-                if (senderPos.x > o.senderPos.x) return false;
-                if (senderPos.y < o.senderPos.y) return true;
-                if (senderPos.y > o.senderPos.y) return false;
-                if (receiverPos.x < o.receiverPos.x) return true;
-                if (receiverPos.x > o.receiverPos.x) return false;
-                if (receiverPos.y < o.receiverPos.y) return true;
-                if (receiverPos.y > o.receiverPos.y) return false;
-                if (pSend < o.pSend) return true;
-                if (pSend > o.pSend) return false;
-                if (senderAngle < o.senderAngle) return true;
-                if (senderAngle > o.senderAngle) return false;
-                if (receiverAngle < o.receiverAngle) return true;
-                if (receiverAngle > o.receiverAngle) return false;
-                if (carrierFrequency < o.carrierFrequency) return true;
-                if (carrierFrequency > o.carrierFrequency) return false;
-                return false;
+                if (x1 != o.x1) return x1 < o.x1;
+                if (y1 != o.y1) return y1 < o.y1;
+                if (x2 != o.x2) return x2 < o.x2;
+                return y2 < o.y2;
             }
         };
 
-        enum { GRIDCELL_SIZE = 1024 };
+        /**
+         * Node of the bounding volume hierarchy over the obstacles. Inner nodes
+         * have two children, leaves refer to a range of bvhObstacles.
+         */
+        struct BvhNode {
+            Coord bboxP1;
+            Coord bboxP2;
+            int left, right;  // child node indices, -1 for leaves
+            int first, count;  // obstacle range of leaves
+        };
+
+        enum { BVH_LEAF_SIZE = 4 };
 
-        typedef std::list<Obstacle*> ObstacleGridCell;
-        typedef std::vector<ObstacleGridCell> ObstacleGridRow;
-        typedef std::vector<ObstacleGridRow> Obstacles;
-        typedef std::map<CacheKey, double> CacheEntries;
+        typedef std::list<Obstacle*> ObstacleList;
+        typedef std::pair<CacheKey, double> CacheEntry;
+        typedef std::list<CacheEntry> CacheEntryList;  // most recently used first
+        typedef std::map<CacheKey, CacheEntryList::iterator> CacheEntries;
 
         cXMLElement* obstaclesXml; /**< obstacles to add at startup */
 
-        Obstacles obstacles;
+        ObstacleList obstacles;
         AnnotationManager* annotations;
         AnnotationManager::Group* annotationGroup;
+
+        /** @name Bounding volume hierarchy, rebuilt lazily after obstacles are added or erased */
+        //@{
+        mutable std::vector<BvhNode> bvhNodes;
+        mutable std::vector<Obstacle*> bvhObstacles;
+        mutable bool isBvhValid;
+        //@}
+
+        /** @name LRU cache of attenuation factors */
+        //@{
+        double cachePositionPrecision;
+        unsigned int maxCacheSize;
+        mutable CacheEntryList cacheEntryList;
         mutable CacheEntries cacheEntries;
+        //@}
+
+        /** @name Statistics */
+        //@{
+        mutable long numCalls;
+        mutable long numCacheHits;
+        mutable long numNodeTests;
+        mutable long numObstacleTests;
+        //@}
+
+    protected:
+        CacheKey makeCacheKey(const Coord& senderPos, const Coord& receiverPos, bool& reversed) const;
+        int64 quantize(double coord) const;
+        void clearCache();
+        void buildBvh() const;
+        int buildBvhNode(int first, int count) const;
+        static bool segmentIntersectsBox(const Coord& from, const Coord& to, const Coord& bboxP1, const Coord& bboxP2);
+        double calculateAttenuation(const Coord& senderPos, const Coord& receiverPos) const;
 };
 
 class ObstacleControlAccess
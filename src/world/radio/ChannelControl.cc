@@ -42,6 +42,8 @@ std::ostream& operator<<(std::ostream& os, const ChannelControl::TransmissionLis
 
 ChannelControl::ChannelControl()
 {
+    useSpatialIndex = false;
+    cellSize = 0;
 }
 
 ChannelControl::~ChannelControl()
@@ -64,12 +66,25 @@ void ChannelControl::initialize()
 
     numChannels = par("numChannels");
     transmissions.resize(numChannels);
-
-    lastOngoingTransmissionsUpdate = 0;
+    transmissionExpiries.resize(numChannels);
 
     maxInterferenceDistance = calcInterfDist();
+    if (maxInterferenceDistance < HUGE_VAL)
+        maxPropagationDelay = maxInterferenceDistance / SPEED_OF_LIGHT;
+    else
+        maxPropagationDelay = TRANSMISSION_PURGE_INTERVAL;
+
+    // the grid is only usable with a finite, positive cell size
+    useSpatialIndex = hasPar("useSpatialIndex") ? par("useSpatialIndex").boolValue() : false;
+    cellSize = maxInterferenceDistance;
+    if (useSpatialIndex && !(cellSize > 0 && cellSize < HUGE_VAL))
+    {
+        coreEV << "spatial index disabled, max interference distance is not usable as grid cell size\n";
+        useSpatialIndex = false;
+    }
 
     WATCH(maxInterferenceDistance);
+    WATCH(useSpatialIndex);
     WATCH_LIST(radios);
     WATCH_VECTOR(transmissions);
 }
@@ -125,8 +140,12 @@ ChannelControl::RadioRef ChannelControl::registerRadio(cModule *radio, cGate *ra
     re.isNeighborListValid = false;
     re.channel = 0;  // for now
     re.isActive = true;
+    re.cellX = re.cellY = re.cellZ = 0;
     radios.push_back(re);
-    return &radios.back(); // last element
+    RadioRef newRadio = &radios.back(); // last element
+    if (useSpatialIndex)
+        addToGrid(newRadio);
+    return newRadio;
 }
 
 void ChannelControl::unregisterRadio(RadioRef r)
@@ -146,6 +165,9 @@ void ChannelControl::unregisterRadio(RadioRef r)
                 radioToRemove->isNeighborListValid = false;
             }
 
+            if (useSpatialIndex)
+                removeFromGrid(radioToRemove);
+
             // erase radio from registered radios
             radios.erase(it);
             return;
@@ -179,37 +201,101 @@ const ChannelControl::RadioRefVector& ChannelControl::getNeighbors(RadioRef h)
 
 void ChannelControl::updateConnections(RadioRef h)
 {
-    Coord& hpos = h->pos;
+    if (useSpatialIndex)
+    {
+        updateConnectionsInGrid(h);
+        return;
+    }
+
     double maxDistSquared = maxInterferenceDistance * maxInterferenceDistance;
     for (RadioList::iterator it = radios.begin(); it != radios.end(); ++it)
     {
         RadioEntry *hi = &(*it);
-        if (hi == h)
-            continue;
+        if (hi != h)
+            updateConnection(h, hi, maxDistSquared);
+    }
+}
+
+void ChannelControl::updateConnectionsInGrid(RadioRef h)
+{
+    double maxDistSquared = maxInterferenceDistance * maxInterferenceDistance;
 
-        // get the distance between the two radios.
-        // (omitting the square root (calling sqrdist() instead of distance()) saves about 5% CPU)
-        bool inRange = hpos.sqrdist(hi->pos) < maxDistSquared;
+    // radios that moved out of range may be anywhere, so check the current
+    // neighbors first (copied, because updateConnection() modifies the set)
+    RadioRefVector oldNeighbors(h->neighbors.begin(), h->neighbors.end());
+    for (RadioRefVector::iterator it = oldNeighbors.begin(); it != oldNeighbors.end(); ++it)
+        updateConnection(h, *it, maxDistSquared);
 
-        if (inRange)
+    // radios in range are always in one of the adjacent cells
+    for (int dx = -1; dx <= 1; dx++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
         {
-            // nodes within communication range: connect
-            if (h->neighbors.insert(hi).second == true)
+            for (int dz = -1; dz <= 1; dz++)
             {
-                hi->neighbors.insert(h);
-                h->isNeighborListValid = hi->isNeighborListValid = false;
+                RadioGrid::iterator cell = grid.find(GridCell(h->cellX + dx, h->cellY + dy, h->cellZ + dz));
+                if (cell == grid.end())
+                    continue;
+                RadioRefVector& cellRadios = cell->second;
+                for (RadioRefVector::iterator it = cellRadios.begin(); it != cellRadios.end(); ++it)
+                    if (*it != h)
+                        updateConnection(h, *it, maxDistSquared);
             }
         }
-        else
+    }
+}
+
+void ChannelControl::updateConnection(RadioRef h, RadioRef hi, double maxDistSquared)
+{
+    // get the distance between the two radios.
+    // (omitting the square root (calling sqrdist() instead of distance()) saves about 5% CPU)
+    bool inRange = h->pos.sqrdist(hi->pos) < maxDistSquared;
+
+    if (inRange)
+    {
+        // nodes within communication range: connect
+        if (h->neighbors.insert(hi).second == true)
         {
-            // out of range: disconnect
-            if (h->neighbors.erase(hi))
-            {
-                hi->neighbors.erase(h);
-                h->isNeighborListValid = hi->isNeighborListValid = false;
-            }
+            hi->neighbors.insert(h);
+            h->isNeighborListValid = hi->isNeighborListValid = false;
         }
     }
+    else
+    {
+        // out of range: disconnect
+        if (h->neighbors.erase(hi))
+        {
+            hi->neighbors.erase(h);
+            h->isNeighborListValid = hi->isNeighborListValid = false;
+        }
+    }
+}
+
+void ChannelControl::addToGrid(RadioRef h)
+{
+    h->cellX = getCellIndex(h->pos.x);
+    h->cellY = getCellIndex(h->pos.y);
+    h->cellZ = getCellIndex(h->pos.z);
+    grid[GridCell(h->cellX, h->cellY, h->cellZ)].push_back(h);
+}
+
+void ChannelControl::removeFromGrid(RadioRef h)
+{
+    RadioGrid::iterator cell = grid.find(GridCell(h->cellX, h->cellY, h->cellZ));
+    ASSERT(cell != grid.end());
+    RadioRefVector& cellRadios = cell->second;
+    for (RadioRefVector::iterator it = cellRadios.begin(); it != cellRadios.end(); ++it)
+    {
+        if (*it == h)
+        {
+            // order within a cell does not matter
+            *it = cellRadios.back();
+            cellRadios.pop_back();
+            break;
+        }
+    }
+    if (cellRadios.empty())
+        grid.erase(cell);
 }
 
 void ChannelControl::checkChannel(int channel)
@@ -221,7 +307,14 @@ void ChannelControl::checkChannel(int channel)
 void ChannelControl::setRadioPosition(RadioRef r, const Coord& pos)
 {
     Enter_Method_Silent();
-    r->pos = pos;
+    if (useSpatialIndex)
+    {
+        removeFromGrid(r);
+        r->pos = pos;
+        addToGrid(r);
+    }
+    else
+        r->pos = pos;
     updateConnections(r);
 }
 
@@ -242,6 +335,23 @@ const ChannelControl::TransmissionList& ChannelControl::getOngoingTransmissions(
     return transmissions[channel];
 }
 
+void ChannelControl::getOngoingTransmissions(int channel, const Coord& pos, double range, TransmissionList& result)
+{
+    Enter_Method_Silent();
+
+    checkChannel(channel);
+    purgeOngoingTransmissions();
+    simtime_t now = simTime();
+    const TransmissionList& tl = transmissions[channel];
+    for (TransmissionList::const_iterator it = tl.begin(); it != tl.end(); ++it)
+    {
+        AirFrame *frame = *it;
+        double distance = pos.distance(frame->getSenderPos());
+        if (distance <= range && frame->getTimestamp() + frame->getDuration() + distance / SPEED_OF_LIGHT > now)
+            result.push_back(frame);
+    }
+}
+
 void ChannelControl::addOngoingTransmission(RadioRef h, AirFrame *frame)
 {
     Enter_Method_Silent();
@@ -255,34 +365,29 @@ void ChannelControl::addOngoingTransmission(RadioRef h, AirFrame *frame)
         return;
     }
 
-    // purge old transmissions from time to time
-    if (simTime() - lastOngoingTransmissionsUpdate > TRANSMISSION_PURGE_INTERVAL)
-    {
-        purgeOngoingTransmissions();
-        lastOngoingTransmissionsUpdate = simTime();
-    }
+    purgeOngoingTransmissions();
 
     // register ongoing transmission
     take(frame);
     frame->setTimestamp(); // store time of transmission start
-    transmissions[frame->getChannelNumber()].push_back(frame);
+    int channel = frame->getChannelNumber();
+    TransmissionList::iterator it = transmissions[channel].insert(transmissions[channel].end(), frame);
+    transmissionExpiries[channel].insert(std::make_pair(frame->getTimestamp() + frame->getDuration() + maxPropagationDelay, it));
 }
 
 void ChannelControl::purgeOngoingTransmissions()
 {
+    // a transmission expires when its end has propagated to the edge of the interference range
+    simtime_t now = simTime();
     for (int i = 0; i < numChannels; i++)
     {
-        for (TransmissionList::iterator it = transmissions[i].begin(); it != transmissions[i].end();)
+        TransmissionExpiryQueue& expiries = transmissionExpiries[i];
+        while (!expiries.empty() && expiries.begin()->first <= now)
         {
-            TransmissionList::iterator curr = it;
-            AirFrame *frame = *it;
-            it++;
-
-            if (frame->getTimestamp() + frame->getDuration() + TRANSMISSION_PURGE_INTERVAL < simTime())
-            {
-                delete frame;
-                transmissions[i].erase(curr);
-            }
+            TransmissionList::iterator it = expiries.begin()->second;
+            delete *it;
+            transmissions[i].erase(it);
+            expiries.erase(expiries.begin());
         }
     }
 }
@@ -291,10 +396,18 @@ void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
 {
     // NOTE: no Enter_Method()! We pretend this method is part of ChannelAccess
 
+    // The copies sent to the receivers are cheap: cPacket shares the
+    // encapsulated packet among them (reference counting), and it only gets
+    // duplicated when a receiver actually modifies or decapsulates it. If the
+    // frame does not need to be kept as an ongoing transmission, the last
+    // receiver gets the original frame instead of a copy.
+    bool keepFrame = numChannels > 1;
+
     // loop through all radios in range
     const RadioRefVector& neighbors = getNeighbors(srcRadio);
     int n = neighbors.size();
     int channel = airFrame->getChannelNumber();
+    RadioRef lastReceiver = NULL;
     for (int i=0; i<n; i++)
     {
         RadioRef r = neighbors[i];
@@ -306,15 +419,33 @@ void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
         if (r->channel == channel)
         {
             coreEV << "sending message to radio listening on the same channel\n";
-            // account for propagation delay, based on distance in meters
-            // Over 300m, dt=1us=10 bit times @ 10Mbps
-            simtime_t delay = srcRadio->pos.distance(r->pos) / SPEED_OF_LIGHT;
-            check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), r->radioInGate);
+            if (lastReceiver)
+                sendToRadio(srcRadio, lastReceiver, airFrame->dup());
+            lastReceiver = r;
         }
         else
             coreEV << "skipping radio listening on a different channel\n";
     }
 
+    if (lastReceiver)
+    {
+        if (keepFrame)
+            sendToRadio(srcRadio, lastReceiver, airFrame->dup());
+        else
+        {
+            sendToRadio(srcRadio, lastReceiver, airFrame);
+            return;
+        }
+    }
+
     // register transmission
     addOngoingTransmission(srcRadio, airFrame);
 }
+
+void ChannelControl::sendToRadio(RadioRef srcRadio, RadioRef destRadio, AirFrame *airFrame)
+{
+    // account for propagation delay, based on distance in meters
+    // Over 300m, dt=1us=10 bit times @ 10Mbps
+    simtime_t delay = srcRadio->pos.distance(destRadio->pos) / SPEED_OF_LIGHT;
+    check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame, delay, airFrame->getDuration(), destRadio->radioInGate);
+}
@@ -20,6 +20,7 @@
 #include <vector>
 #include <list>
 #include <set>
+#include <map>
 
 #include "INETDefs.h"
 #include "Coord.h"
@@ -28,6 +29,7 @@
 // Forward declarations
 class AirFrame;
 
+// how long transmissions are kept after their end if the max interference distance is infinite
 #define TRANSMISSION_PURGE_INTERVAL 1.0
 
 /**
@@ -53,6 +55,9 @@ struct IChannelControl::RadioEntry {
     std::vector<RadioRef> neighborList;
     bool isNeighborListValid;
     bool isActive;
+
+    // grid cell the radio is currently stored in (used only if the spatial index is enabled)
+    int cellX, cellY, cellZ;
 };
 
 /**
@@ -69,6 +74,32 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
 
     RadioList radios;
 
+    /**
+     * Uniform grid over the playground with a cell size equal to
+     * maxInterferenceDistance. Radios that can be in range of each other
+     * are always in the same or in adjacent cells, so updateConnections()
+     * only needs to examine the 3x3x3 cells around the moving radio.
+     */
+    struct GridCell {
+        int x, y, z;
+        GridCell(int x, int y, int z) : x(x), y(y), z(z) {}
+        bool operator<(const GridCell& other) const {
+            if (x != other.x) return x < other.x;
+            if (y != other.y) return y < other.y;
+            return z < other.z;
+        }
+    };
+    typedef std::map<GridCell, RadioRefVector> RadioGrid;
+
+    /** whether the grid-based spatial index is used by updateConnections() */
+    bool useSpatialIndex;
+
+    /** the radios indexed by their grid cell; only maintained if useSpatialIndex is set */
+    RadioGrid grid;
+
+    /** size of a grid cell (equals to maxInterferenceDistance) */
+    double cellSize;
+
     /** keeps track of ongoing transmissions; this is needed when a radio
      * switches to another channel (then it needs to know whether the target channel
      * is empty or busy)
@@ -76,8 +107,14 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     typedef std::vector<TransmissionList> ChannelTransmissionLists;
     ChannelTransmissionLists transmissions; // indexed by channel number (size=numChannels)
 
-    /** used to clear the transmission list from time to time */
-    simtime_t lastOngoingTransmissionsUpdate;
+    /** the transmissions of each channel ordered by the time their signal leaves
+     * the interference range of the sender, i.e. when they can be thrown away
+     */
+    typedef std::multimap<simtime_t, TransmissionList::iterator> TransmissionExpiryQueue;
+    std::vector<TransmissionExpiryQueue> transmissionExpiries; // indexed by channel number (size=numChannels)
+
+    /** propagation delay to the edge of the interference range */
+    simtime_t maxPropagationDelay;
 
     friend std::ostream& operator<<(std::ostream&, const RadioEntry&);
     friend std::ostream& operator<<(std::ostream&, const TransmissionList&);
@@ -94,13 +131,28 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
   protected:
     virtual void updateConnections(RadioRef h);
 
+    /** Same as updateConnections(), but only examines radios in the adjacent grid cells */
+    virtual void updateConnectionsInGrid(RadioRef h);
+
+    /** Connects or disconnects the two radios, depending on their distance */
+    virtual void updateConnection(RadioRef h, RadioRef hi, double maxDistSquared);
+
+    /** Returns the grid cell coordinate that belongs to the given position coordinate */
+    int getCellIndex(double coord) const { return (int)floor(coord / cellSize); }
+
+    /** Puts the radio into the grid cell of its current position */
+    virtual void addToGrid(RadioRef h);
+
+    /** Removes the radio from its current grid cell */
+    virtual void removeFromGrid(RadioRef h);
+
     /** Calculate interference distance*/
     virtual double calcInterfDist();
 
     /** Reads init parameters and calculates a maximal interference distance*/
     virtual void initialize();
 
-    /** Throws away expired transmissions. */
+    /** Throws away transmissions that can no longer be heard anywhere. */
     virtual void purgeOngoingTransmissions();
 
     /** Validate the channel identifier */
@@ -112,6 +164,9 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     /** Notifies the channel control with an ongoing transmission */
     virtual void addOngoingTransmission(RadioRef h, AirFrame *frame);
 
+    /** Sends the frame to the given radio, with the propagation delay computed from their distance */
+    virtual void sendToRadio(RadioRef srcRadio, RadioRef destRadio, AirFrame *airFrame);
+
     /** Returns the "handle" of a previously registered radio. The pointer to the registering (radio) module must be provided */
     virtual RadioRef lookupRadio(cModule *radioModule);
 
@@ -146,6 +201,9 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     /** Provides a list of transmissions currently on the air */
     virtual const TransmissionList& getOngoingTransmissions(int channel);
 
+    /** Collects the transmissions on the channel that are still (or not yet) on the air at the given position, and whose sender is within range */
+    virtual void getOngoingTransmissions(int channel, const Coord& pos, double range, TransmissionList& result);
+
     /** Called from ChannelAccess, to transmit a frame to the radios in range, on the frame's channel */
     virtual void sendToChannel(RadioRef srcRadio, AirFrame *airFrame);
 
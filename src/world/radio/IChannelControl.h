@@ -68,6 +68,9 @@ class INET_API IChannelControl
     /** Provides a list of transmissions currently on the air */
     virtual const TransmissionList& getOngoingTransmissions(int channel) = 0;
 
+    /** Collects the transmissions on the channel that are still (or not yet) on the air at the given position, and whose sender is within range */
+    virtual void getOngoingTransmissions(int channel, const Coord& pos, double range, TransmissionList& result) = 0;
+
     /** Called from ChannelAccess, to transmit a frame to the radios in range, on the frame's channel */
     virtual void sendToChannel(RadioRef srcRadio, AirFrame *airFrame) = 0;
 
@@ -128,7 +128,10 @@ void IdealChannelModel::sendToChannel(RadioEntry *srcRadio, IdealAirFrame *airFr
 
     double sqrTransmissionRange = airFrame->getTransmissionRange()*airFrame->getTransmissionRange();
 
-    // loop through all radios
+    // loop through all radios; the last receiver gets the original frame
+    // instead of a copy (the copies share the encapsulated packet anyway)
+    RadioEntry *lastReceiver = NULL;
+    simtime_t lastDelay;
     for (RadioList::iterator it=radios.begin(); it !=radios.end(); ++it)
     {
         RadioEntry *r = &*it;
@@ -141,12 +144,18 @@ void IdealChannelModel::sendToChannel(RadioEntry *srcRadio, IdealAirFrame *airFr
         double sqrdist = srcRadio->pos.sqrdist(r->pos);
         if (sqrdist <= sqrTransmissionRange)
         {
+            if (lastReceiver)
+                check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame->dup(), lastDelay, airFrame->getDuration(), lastReceiver->radioInGate);
+
             // account for propagation delay, based on distance in meters
             // Over 300m, dt=1us=10 bit times @ 10Mbps
-            simtime_t delay = sqrt(sqrdist) / SPEED_OF_LIGHT;
-            check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), r->radioInGate);
+            lastDelay = sqrt(sqrdist) / SPEED_OF_LIGHT;
+            lastReceiver = r;
         }
     }
-    delete airFrame;
+    if (lastReceiver)
+        check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame, lastDelay, airFrame->getDuration(), lastReceiver->radioInGate);
+    else
+        delete airFrame;
 }
 
@@ -0,0 +1,48 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "TestDataGenerator.h"
+
+uint32 randomWord()
+{
+    return intrand(0x10000) << 16 | intrand(0x10000);
+}
+
+IPv4Address randomIPv4Address()
+{
+    return IPv4Address(randomWord() & 0x3fffffff);
+}
+
+int randomIPv4PrefixLength()
+{
+    int k = intrand(100);
+    return k < 55 ? 24 : k < 85 ? 16 + intrand(8) : k < 95 ? 25 + intrand(8) : intrand(16);
+}
+
+IPv4Address randomIPv4Prefix(int length)
+{
+    return randomIPv4Address().doAnd(IPv4Address::makeNetmask(length));
+}
+
+IPv6Address randomIPv6Address()
+{
+    return IPv6Address(0x20010db8 | intrand(4), randomWord() & 0xff0000ff, randomWord(), randomWord());
+}
+
+int randomIPv6PrefixLength()
+{
+    int k = intrand(100);
+    return k < 60 ? 64 : k < 80 ? 32 + intrand(33) : k < 95 ? 65 + intrand(63) : k < 99 ? intrand(32) : 128;
+}
@@ -0,0 +1,66 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __TEST__TESTDATAGENERATOR_H
+#define __TEST__TESTDATAGENERATOR_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "IPv4Address.h"
+#include "IPv6Address.h"
+
+// Random input for the tests that compare an indexed lookup structure
+// with the linear search it replaces. All values come from intrand(),
+// so the tests are reproducible.
+
+/////////////////////////////////////////////////////////////////////////
+
+// uniformly random 32 bits
+uint32 randomWord();
+
+// an address from 0.0.0.0/2, so that random destinations often match some prefix
+IPv4Address randomIPv4Address();
+
+// prefix lengths roughly as in BGP tables: mostly /24, then /16../23,
+// some longer ones and a few shorter than /16
+int randomIPv4PrefixLength();
+
+// randomIPv4Address() masked to the given length
+IPv4Address randomIPv4Prefix(int length);
+
+/////////////////////////////////////////////////////////////////////////
+
+// an address from 2001:db8::/30, with the interface ids of a few hosts
+IPv6Address randomIPv6Address();
+
+// mostly /64 on-link prefixes, then shorter aggregates, some longer ones and a few host routes
+int randomIPv6PrefixLength();
+
+/////////////////////////////////////////////////////////////////////////
+
+// Fisher-Yates shuffle
+template <class T>
+void shuffle(std::vector<T>& v)
+{
+    for (int i = (int)v.size() - 1; i > 0; i--)
+    {
+        int k = intrand(i + 1);
+        T t = v[i]; v[i] = v[k]; v[k] = t;
+    }
+}
+
+#endif // __TEST__TESTDATAGENERATOR_H